@@ -0,0 +1,708 @@
+// Google Benchmark suite for fsm dispatch latency, throughput and build cost.
+//
+// Every benchmark reports items (dispatches, transitions or edges) per
+// second and an `allocs/op` counter taken from the global operator new
+// below, so storage backends can be compared against the default
+// unordered_map-backed runtime.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <fsm/analysis.hpp>
+#include <fsm/async_runtime.hpp>
+#include <fsm/atomic_runtime.hpp>
+#include <fsm/dense_runtime.hpp>
+#include <fsm/runtime.hpp>
+#include <fsm/table_image.hpp>
+#include <fsm/timing_wheel.hpp>
+
+// -------------------------------------------------------------------
+// Allocation counting
+// -------------------------------------------------------------------
+namespace {
+std::atomic<std::size_t> g_allocs{0};
+
+// Every replacement below allocates and frees through these two.  They
+// stay out of line so GCC does not inline std::free into callers of the
+// replaced operator new and report -Wmismatched-new-delete.
+[[gnu::noinline]] void* counted_alloc(std::size_t n,
+                                      std::size_t align) noexcept
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    n = n == 0 ? 1 : n;
+    if (align <= alignof(std::max_align_t)) {
+        return std::malloc(n);
+    }
+    return std::aligned_alloc(align, (n + align - 1) / align * align);
+}
+
+[[gnu::noinline]] void counted_free(void* p) noexcept
+{
+    std::free(p);
+}
+
+void* counted_new(std::size_t n, std::size_t align)
+{
+    if (void* p = counted_alloc(n, align)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+} // namespace
+
+void* operator new(std::size_t n)
+{
+    return counted_new(n, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t n)
+{
+    return counted_new(n, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept
+{
+    return counted_alloc(n, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept
+{
+    return counted_alloc(n, alignof(std::max_align_t));
+}
+
+// std::pmr::new_delete_resource allocates through the aligned overloads.
+void* operator new(std::size_t n, std::align_val_t al)
+{
+    return counted_new(n, static_cast<std::size_t>(al));
+}
+
+void* operator new[](std::size_t n, std::align_val_t al)
+{
+    return counted_new(n, static_cast<std::size_t>(al));
+}
+
+void* operator new(std::size_t n, std::align_val_t al,
+                   const std::nothrow_t&) noexcept
+{
+    return counted_alloc(n, static_cast<std::size_t>(al));
+}
+
+void* operator new[](std::size_t n, std::align_val_t al,
+                     const std::nothrow_t&) noexcept
+{
+    return counted_alloc(n, static_cast<std::size_t>(al));
+}
+
+void operator delete(void* p) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete[](void* p, std::align_val_t,
+                       const std::nothrow_t&) noexcept
+{
+    counted_free(p);
+}
+
+namespace {
+
+/** Scope helper publishing allocations per iteration as a counter. */
+class alloc_counter {
+public:
+    explicit alloc_counter(benchmark::State& st)
+        : st_(st), start_(g_allocs.load(std::memory_order_relaxed)) {}
+    ~alloc_counter() {
+        const auto n = g_allocs.load(std::memory_order_relaxed) - start_;
+        st_.counters["allocs/op"] = benchmark::Counter(
+            static_cast<double>(n), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& st_;
+    std::size_t start_;
+};
+
+// -------------------------------------------------------------------
+// Machine generation
+// -------------------------------------------------------------------
+constexpr int events_per_state = 4;
+constexpr int miss_event = events_per_state; // never in the table
+
+struct Context {
+    std::uint64_t counter = 0;
+};
+
+/** Destination of the synthetic edge (s, e) in a machine of n states. */
+int next_state(int s, int e, int n)
+{
+    return static_cast<int>((static_cast<std::uint64_t>(s) * 2654435761u
+                             + static_cast<std::uint64_t>(e) + 1)
+                            % static_cast<std::uint64_t>(n));
+}
+
+/** Fill any machine with `transitions` edges, every state fully connected. */
+template <class Machine, class Guard, class Action>
+void populate(Machine& sm, int transitions, Guard guard, Action action)
+{
+    const int states = transitions / events_per_state;
+    for (int s = 0; s < states; ++s) {
+        for (int e = 0; e < events_per_state; ++e) {
+            sm.add_transition({ s, e, next_state(s, e, states), guard, action });
+        }
+    }
+}
+
+/** Pseudo-random event stream (all hits), power-of-two length. */
+std::vector<int> event_stream()
+{
+    std::vector<int> evs(1 << 12);
+    std::uint32_t x = 1;
+    for (auto& e : evs) {
+        x = x * 1103515245u + 12345u;
+        e = static_cast<int>((x >> 16) % events_per_state);
+    }
+    return evs;
+}
+
+// -------------------------------------------------------------------
+// runtime: hit / miss / guard rejected, void and non-void context
+// -------------------------------------------------------------------
+template <bool Frozen>
+void BM_dispatch_hit_void(benchmark::State& st)
+{
+    fsm::runtime<int, int> sm(0);
+    populate(sm, static_cast<int>(st.range(0)), nullptr, nullptr);
+    if constexpr (Frozen) {
+        sm.freeze();
+    }
+    const auto evs = event_stream();
+    std::size_t i = 0;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm.dispatch(evs[i++ & (evs.size() - 1)]));
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+template <bool Frozen>
+void BM_dispatch_hit_ctx(benchmark::State& st)
+{
+    fsm::runtime<int, int, Context> sm(0);
+    populate(sm, static_cast<int>(st.range(0)), nullptr,
+             [](Context& c) { ++c.counter; });
+    if constexpr (Frozen) {
+        sm.freeze();
+    }
+    const auto evs = event_stream();
+    Context ctx;
+    std::size_t i = 0;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm.dispatch(evs[i++ & (evs.size() - 1)], ctx));
+    }
+    benchmark::DoNotOptimize(ctx.counter);
+    st.SetItemsProcessed(st.iterations());
+}
+
+/** One 4096-edge machine driven by st.threads() callers at once. */
+void BM_atomic_dispatch(benchmark::State& st)
+{
+    static fsm::atomic_runtime<int, int> sm(0);
+    static const bool built = [] {
+        populate(sm, 4096, nullptr, nullptr);
+        sm.freeze();
+        return true;
+    }();
+    benchmark::DoNotOptimize(built);
+    const auto evs = event_stream();
+    std::size_t i = static_cast<std::size_t>(st.thread_index()) * 977;
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm.dispatch(evs[i++ & (evs.size() - 1)]));
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+/** Commit only: the action comes back as a ticket and is not run. */
+void BM_dispatch_deferred(benchmark::State& st)
+{
+    fsm::runtime<int, int, Context> sm(0);
+    populate(sm, static_cast<int>(st.range(0)), nullptr,
+             [](Context& c) { ++c.counter; });
+    sm.freeze();
+    const auto evs = event_stream();
+    Context ctx;
+    fsm::action_ticket t;
+    std::size_t i = 0;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm.dispatch_deferred(evs[i++ & (evs.size() - 1)], ctx, t));
+        benchmark::DoNotOptimize(t);
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+/** post() through async_runtime: sync actions, or a coroutine per event. */
+template <bool Coroutine>
+void BM_async_post(benchmark::State& st)
+{
+    Context ctx;
+    fsm::async_runtime<int, int, Context> sm(0, ctx);
+    const int n = static_cast<int>(st.range(0));
+    const int states = n / events_per_state;
+    for (int s = 0; s < states; ++s) {
+        for (int e = 0; e < events_per_state; ++e) {
+            if constexpr (Coroutine) {
+                sm.add_async_transition(s, e, next_state(s, e, states), nullptr,
+                                        [](Context& c) -> fsm::task {
+                                            ++c.counter;
+                                            co_return;
+                                        });
+            } else {
+                sm.add_transition({ s, e, next_state(s, e, states), nullptr,
+                                    [](Context& c) { ++c.counter; } });
+            }
+        }
+    }
+    sm.freeze();
+    const auto evs = event_stream();
+    std::size_t i = 0;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        sm.post(evs[i++ & (evs.size() - 1)]);
+    }
+    benchmark::DoNotOptimize(ctx.counter);
+    st.SetItemsProcessed(st.iterations());
+}
+
+/** Every state has a timeout, so each dispatch also re-arms the timer. */
+void BM_timed_dispatch(benchmark::State& st)
+{
+    fsm::runtime<int, int, void, fsm::no_instrumentation, fsm::wheel_timers> sm(0);
+    const int n = static_cast<int>(st.range(0));
+    populate(sm, n, nullptr, nullptr);
+    for (int s = 0; s < n / events_per_state; ++s) {
+        sm.add_timeout(s, 1000, 0);
+    }
+    sm.freeze();
+    fsm::timing_wheel wheel;
+    sm.attach_timers(wheel);
+    const auto evs = event_stream();
+    std::size_t i = 0;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm.dispatch(evs[i++ & (evs.size() - 1)]));
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+/** Re-arm one of st.range(0) pending timers and advance one tick. */
+void BM_wheel_arm_tick(benchmark::State& st)
+{
+    const auto n = static_cast<std::size_t>(st.range(0));
+    fsm::timing_wheel wheel;
+    std::vector<fsm::timer> timers(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        wheel.arm(timers[k], 1 + (k * 7919) % 100000);
+    }
+    std::size_t i = 0;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        const std::size_t k = i++ % n;
+        wheel.arm(timers[k], wheel.now() + 1 + (k * 7919) % 100000);
+        benchmark::DoNotOptimize(wheel.tick(wheel.now() + 1));
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+void BM_dispatch_many(benchmark::State& st)
+{
+    fsm::runtime<int, int> sm(0);
+    populate(sm, static_cast<int>(st.range(0)), nullptr, nullptr);
+    sm.freeze();
+    const auto evs = event_stream();
+    std::vector<fsm::result> out(evs.size());
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm.dispatch_many(evs, out));
+    }
+    st.SetItemsProcessed(st.iterations() * static_cast<std::int64_t>(evs.size()));
+}
+
+void BM_dispatch_miss(benchmark::State& st)
+{
+    fsm::runtime<int, int> sm(0);
+    populate(sm, static_cast<int>(st.range(0)), nullptr, nullptr);
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm.dispatch(miss_event));
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+void BM_dispatch_any_state(benchmark::State& st)
+{
+    fsm::runtime<int, int> sm(0);
+    populate(sm, static_cast<int>(st.range(0)), nullptr, nullptr);
+    sm.add_any_state(miss_event, 0);
+    sm.freeze();
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm.dispatch(miss_event));
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+/** Four guarded candidates per key; only the last one passes. */
+void BM_dispatch_candidates(benchmark::State& st)
+{
+    fsm::runtime<int, int, Context> sm(0);
+    const int states = static_cast<int>(st.range(0)) / events_per_state;
+    for (int s = 0; s < states; ++s) {
+        for (int e = 0; e < events_per_state; ++e) {
+            for (int c = 0; c < 4; ++c) {
+                sm.append_transition({ s, e, next_state(s, e + c, states),
+                    [c](const Context&) { return c == 3; }, nullptr });
+            }
+        }
+    }
+    sm.freeze();
+    const auto evs = event_stream();
+    Context ctx;
+    std::size_t i = 0;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm.dispatch(evs[i++ & (evs.size() - 1)], ctx));
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+void BM_dispatch_guard_rejected(benchmark::State& st)
+{
+    fsm::runtime<int, int, Context> sm(0);
+    populate(sm, static_cast<int>(st.range(0)),
+             [](const Context& c) { return c.counter == ~0ULL; }, nullptr);
+    Context ctx;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm.dispatch(0, ctx));
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+// -------------------------------------------------------------------
+// dense_runtime at compile-time sizes, for comparison with the map
+// -------------------------------------------------------------------
+template <std::size_t States>
+void BM_dense_dispatch_hit_void(benchmark::State& st)
+{
+    using Dense = fsm::dense_runtime<int, int, States, events_per_state + 1>;
+    auto sm = std::make_unique<Dense>(0);
+    populate(*sm, static_cast<int>(States * events_per_state), nullptr, nullptr);
+    const auto evs = event_stream();
+    std::size_t i = 0;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm->dispatch(evs[i++ & (evs.size() - 1)]));
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+template <std::size_t States>
+void BM_dense_run(benchmark::State& st)
+{
+    using Dense = fsm::dense_runtime<int, int, States, events_per_state + 1>;
+    auto sm = std::make_unique<Dense>(0);
+    populate(*sm, static_cast<int>(States * events_per_state), nullptr, nullptr);
+    const auto evs = event_stream();
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm->run(evs));
+    }
+    st.SetItemsProcessed(st.iterations() * static_cast<std::int64_t>(evs.size()));
+}
+
+// -------------------------------------------------------------------
+// Profile-guided layout: 5% of the edges take every lookup
+// -------------------------------------------------------------------
+template <bool Profiled>
+void BM_find_hot(benchmark::State& st)
+{
+    const int n = static_cast<int>(st.range(0));
+    fsm::runtime<int, int> sm(0);
+    populate(sm, n, nullptr, nullptr);
+
+    std::vector<std::pair<int, int>> hot;
+    std::vector<std::uint64_t> profile(sm.size(), 0);
+    const auto trs = sm.table().transitions();
+    for (std::size_t i = 0; i < trs.size(); i += 20) {
+        hot.emplace_back(trs[i].src, trs[i].ev);
+        profile[i] = 1;
+    }
+    if constexpr (Profiled) {
+        sm.freeze(profile);
+    } else {
+        sm.freeze();
+    }
+    std::size_t i = 0;
+    for (auto _ : st) {
+        const auto& [s, e] = hot[i++ % hot.size()];
+        benchmark::DoNotOptimize(sm.table().find(s, e)->dst);
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+// -------------------------------------------------------------------
+// Construction and DOT generation
+// -------------------------------------------------------------------
+void BM_add_transition(benchmark::State& st)
+{
+    const int n = static_cast<int>(st.range(0));
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        fsm::runtime<int, int> sm(0);
+        populate(sm, n, nullptr, nullptr);
+        benchmark::DoNotOptimize(sm.size());
+    }
+    st.SetItemsProcessed(st.iterations() * n);
+}
+
+/** Same table as BM_add_transition, built from a prepared edge list. */
+void BM_add_transitions(benchmark::State& st)
+{
+    const int n = static_cast<int>(st.range(0));
+    const int states = n / events_per_state;
+    std::vector<fsm::runtime<int, int>::Transition> edges;
+    edges.reserve(static_cast<std::size_t>(n));
+    for (int s = 0; s < states; ++s) {
+        for (int e = 0; e < events_per_state; ++e) {
+            edges.push_back({ s, e, next_state(s, e, states), nullptr, nullptr });
+        }
+    }
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        fsm::runtime<int, int> sm(0);
+        benchmark::DoNotOptimize(sm.add_transitions(edges).added);
+    }
+    st.SetItemsProcessed(st.iterations() * n);
+}
+
+void BM_add_transition_arena(benchmark::State& st)
+{
+    const int n = static_cast<int>(st.range(0));
+    std::pmr::monotonic_buffer_resource arena;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        {
+            fsm::runtime<int, int> sm(0, &arena);
+            populate(sm, n, nullptr, nullptr);
+            benchmark::DoNotOptimize(sm.size());
+        }
+        arena.release();
+    }
+    st.SetItemsProcessed(st.iterations() * n);
+}
+
+void BM_freeze(benchmark::State& st)
+{
+    const int n = static_cast<int>(st.range(0));
+    for (auto _ : st) {
+        st.PauseTiming();
+        fsm::runtime<int, int> sm(0);
+        populate(sm, n, nullptr, nullptr);
+        st.ResumeTiming();
+        sm.freeze();
+        benchmark::DoNotOptimize(sm.frozen());
+    }
+    st.SetItemsProcessed(st.iterations() * n);
+}
+
+/** Whole-table analysis pass (reachability, sinks, unhandled events). */
+void BM_analyze(benchmark::State& st)
+{
+    const int n = static_cast<int>(st.range(0));
+    fsm::runtime<int, int> sm(0);
+    populate(sm, n, nullptr, nullptr);
+    sm.freeze();
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(fsm::analyze(sm.table(), 0).reachable.size());
+    }
+    st.SetItemsProcessed(st.iterations() * n);
+}
+
+/** Cold start from a saved image: validation only, nothing is rebuilt. */
+void BM_image_open(benchmark::State& st)
+{
+    fsm::runtime<int, int> sm(0);
+    populate(sm, static_cast<int>(st.range(0)), nullptr, nullptr);
+    sm.freeze();
+    std::string blob;
+    fsm::save_image(sm.table(), blob);
+    std::vector<std::uint64_t> image((blob.size() + 7) / 8);
+    std::memcpy(image.data(), blob.data(), blob.size());
+    const std::span<const char> bytes(reinterpret_cast<const char*>(image.data()),
+                                      blob.size());
+    fsm::table_view<int, int> view;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(view.open(bytes));
+    }
+    st.SetItemsProcessed(st.iterations() * st.range(0));
+}
+
+void BM_image_dispatch(benchmark::State& st)
+{
+    fsm::runtime<int, int> sm(0);
+    populate(sm, static_cast<int>(st.range(0)), nullptr, nullptr);
+    sm.freeze();
+    std::string blob;
+    fsm::save_image(sm.table(), blob);
+    std::vector<std::uint64_t> image((blob.size() + 7) / 8);
+    std::memcpy(image.data(), blob.data(), blob.size());
+    fsm::table_view<int, int> view;
+    view.open({ reinterpret_cast<const char*>(image.data()), blob.size() });
+    const auto evs = event_stream();
+    int state = 0;
+    std::size_t i = 0;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(view.dispatch(state, evs[i++ & (evs.size() - 1)]));
+    }
+    st.SetItemsProcessed(st.iterations());
+}
+
+void BM_to_dot(benchmark::State& st)
+{
+    fsm::runtime<int, int> sm(0);
+    populate(sm, static_cast<int>(st.range(0)), nullptr, nullptr);
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(sm.to_dot());
+    }
+    st.SetItemsProcessed(st.iterations() * st.range(0));
+}
+
+/** Streaming writer into a discarding sink: formatting cost only. */
+void BM_write_dot(benchmark::State& st)
+{
+    struct null_sink {
+        using difference_type = std::ptrdiff_t;
+        std::size_t* n;
+        null_sink& operator*() { return *this; }
+        null_sink& operator++() { return *this; }
+        null_sink operator++(int) { return *this; }
+        null_sink& operator=(char) { ++*n; return *this; }
+    };
+    fsm::runtime<int, int> sm(0);
+    populate(sm, static_cast<int>(st.range(0)), nullptr, nullptr);
+    std::size_t bytes = 0;
+    alloc_counter allocs(st);
+    for (auto _ : st) {
+        sm.write_dot(null_sink{ &bytes });
+    }
+    benchmark::DoNotOptimize(bytes);
+    st.SetItemsProcessed(st.iterations() * st.range(0));
+}
+
+} // namespace
+
+// Table sizes from 4 to 100k transitions.
+#define FSM_TABLE_SIZES RangeMultiplier(8)->Range(4, 100000)
+
+BENCHMARK(BM_dispatch_hit_void<false>)->FSM_TABLE_SIZES;
+BENCHMARK(BM_dispatch_hit_void<true>)->FSM_TABLE_SIZES;
+BENCHMARK(BM_dispatch_hit_ctx<false>)->FSM_TABLE_SIZES;
+BENCHMARK(BM_dispatch_hit_ctx<true>)->FSM_TABLE_SIZES;
+BENCHMARK(BM_dispatch_deferred)->FSM_TABLE_SIZES;
+BENCHMARK(BM_dispatch_many)->FSM_TABLE_SIZES;
+BENCHMARK(BM_async_post<false>)->FSM_TABLE_SIZES;
+BENCHMARK(BM_async_post<true>)->FSM_TABLE_SIZES;
+BENCHMARK(BM_timed_dispatch)->FSM_TABLE_SIZES;
+BENCHMARK(BM_wheel_arm_tick)->Arg(64)->Arg(4096)->Arg(262144);
+BENCHMARK(BM_atomic_dispatch)->Threads(1)->Threads(2)->Threads(4)->UseRealTime();
+BENCHMARK(BM_dispatch_miss)->FSM_TABLE_SIZES;
+BENCHMARK(BM_dispatch_any_state)->FSM_TABLE_SIZES;
+BENCHMARK(BM_dispatch_guard_rejected)->FSM_TABLE_SIZES;
+BENCHMARK(BM_dispatch_candidates)->FSM_TABLE_SIZES;
+
+BENCHMARK(BM_find_hot<false>)->Arg(100000);
+BENCHMARK(BM_find_hot<true>)->Arg(100000);
+
+BENCHMARK(BM_dense_dispatch_hit_void<1>);
+BENCHMARK(BM_dense_dispatch_hit_void<16>);
+BENCHMARK(BM_dense_dispatch_hit_void<1024>);
+BENCHMARK(BM_dense_dispatch_hit_void<25000>);
+BENCHMARK(BM_dense_run<16>);
+BENCHMARK(BM_dense_run<1024>);
+
+BENCHMARK(BM_add_transition)->FSM_TABLE_SIZES;
+BENCHMARK(BM_add_transitions)->FSM_TABLE_SIZES;
+BENCHMARK(BM_add_transition_arena)->FSM_TABLE_SIZES;
+BENCHMARK(BM_freeze)->FSM_TABLE_SIZES;
+BENCHMARK(BM_analyze)->FSM_TABLE_SIZES;
+BENCHMARK(BM_image_open)->FSM_TABLE_SIZES;
+BENCHMARK(BM_image_dispatch)->FSM_TABLE_SIZES;
+BENCHMARK(BM_to_dot)->FSM_TABLE_SIZES;
+BENCHMARK(BM_write_dot)->FSM_TABLE_SIZES;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,265 @@
+/**
+ * @file analysis.hpp
+ * @brief Static analysis of a transition table: reachability, sinks,
+ *        unhandled events and overwritten transitions.
+ *
+ * `fsm::analyze(def, start)` walks a `definition` once, before or after
+ * `freeze()`, and reports what the table can actually do from `start`.
+ * Transitions are followed the way dispatch would take them: exact
+ * entries first, then entries inherited through `set_parent()` for
+ * events the state does not handle itself, then `add_any_state()`
+ * entries for events still unhandled, plus the state's `add_default()`
+ * entry and `add_timeout()`.  Guards are not evaluated; every guarded
+ * candidate counts as takeable.
+ *
+ * The pass is linear in the size of the table for flat machines: each
+ * state's own transitions are visited once.  Nested states also visit
+ * their ancestors' transitions, and every state checks each any-state
+ * entry, so those add `depth * edges` and `states * any_state` terms.
+ *
+ * The report's `state_bound` and `event_bound` give the smallest
+ * `StateCount`/`EventCount` a dense layout needs for what is reachable.
+ */
+
+#ifndef FSM_ANALYSIS_HPP
+#define FSM_ANALYSIS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fsm/definition.hpp>
+
+namespace fsm {
+
+/**
+ * @brief Result of `fsm::analyze()`.
+ *
+ * States are those named by a transition, a timeout, `start` or
+ * `set_parent()` as an ancestor of one of them, plus every value of the
+ * declared range when `State` is counted (see `fsm::enum_count`).
+ */
+template <class State, class Event>
+struct analysis_report {
+    std::vector<State> reachable;   /**< Reachable from start, breadth-first */
+    std::vector<State> unreachable; /**< All other states */
+    std::vector<State> sinks;       /**< States no transition leads out of */
+    std::vector<Event> unhandled;   /**< Events no transition is taken on */
+    std::vector<shadowed_transition<State, Event>> shadowed; /**< Overwrites */
+    std::size_t state_bound = 0;    /**< 1 + largest reachable state value */
+    std::size_t event_bound = 0;    /**< 1 + largest handled event value */
+
+    /** @brief No unreachable state, unhandled event or overwrite. */
+    inline bool clean() const noexcept {
+        return unreachable.empty() && unhandled.empty() && shadowed.empty();
+    }
+};
+
+/**
+ * @brief Analyse the table of `def` as seen from `start`.
+ *
+ * @param def    Table to analyse; built or frozen.
+ * @param start  Initial state reachability is computed from.
+ * @param events Every event the machine may receive, for `unhandled`.
+ *               When empty, the declared range of a counted `Event` is
+ *               used; for uncounted events `unhandled` is then empty.
+ *
+ * Self-transitions do not lead out of a state, so a state whose only
+ * transitions are self-loops is a sink.  Because guards are ignored, an
+ * `add_default()` entry is assumed to be taken by some event.
+ */
+template <class State, class Event, class Context>
+analysis_report<State, Event> analyze(const definition<State, Event, Context>& def,
+                                      State start,
+                                      std::type_identity_t<std::span<const Event>> events = {}) {
+    using Definition = definition<State, Event, Context>;
+    using Transition = typename Definition::Transition;
+    using state_key = decltype(detail::underlying(std::declval<State>()));
+    using event_key = decltype(detail::underlying(std::declval<Event>()));
+    constexpr uint32_t none = perfect_hash::npos;
+
+    analysis_report<State, Event> report;
+    const std::span<const Transition> trs = def.transitions();
+
+    /* Number every state: declared range, start, then first mention. */
+    std::vector<State> states;
+    std::unordered_map<state_key, uint32_t> ids;
+    auto id_of = [&](State s) {
+        const auto [it, inserted] = ids.try_emplace(
+            detail::underlying(s), static_cast<uint32_t>(states.size()));
+        if (inserted) {
+            states.push_back(s);
+        }
+        return it->second;
+    };
+    if constexpr (has_enum_count<State>) {
+        ids.reserve(enum_count<State>::value);
+        for (std::size_t v = 0; v < enum_count<State>::value; ++v) {
+            id_of(static_cast<State>(v));
+        }
+    } else {
+        ids.reserve(trs.size() + 1);
+    }
+    const uint32_t start_id = id_of(start);
+    for (uint32_t i = 0; i < trs.size(); ++i) {
+        if (def.kind(i) != transition_kind::AnyState) {
+            id_of(trs[i].src);
+        }
+        id_of(trs[i].dst);
+    }
+    for (const auto& to : def.timeouts()) {
+        id_of(to.src);
+        id_of(to.dst);
+    }
+    std::vector<uint32_t> parent;
+    for (uint32_t s = 0; s < states.size(); ++s) {
+        const State* p = def.parent(states[s]);
+        parent.push_back(p != nullptr ? id_of(*p) : none);
+    }
+    const auto n = static_cast<uint32_t>(states.size());
+
+    /* Own exact transitions per state (CSR), default and timeout targets,
+       and any-state entries. */
+    std::vector<uint32_t> first(n + 1, 0);
+    std::vector<uint32_t> fallback(n, none);
+    std::vector<uint32_t> timeout(n, none);
+    std::vector<std::pair<Event, uint32_t>> any;
+    std::unordered_map<event_key, uint32_t> seen;
+    bool has_default = false;
+    uint64_t event_top = 0;
+    auto handled = [&](Event e) {
+        seen.try_emplace(detail::underlying(e), none);
+        event_top = std::max(event_top,
+                             static_cast<uint64_t>(detail::underlying(e)) + 1);
+    };
+    for (uint32_t i = 0; i < trs.size(); ++i) {
+        switch (def.kind(i)) {
+        case transition_kind::Exact:
+            ++first[ids.find(detail::underlying(trs[i].src))->second + 1];
+            handled(trs[i].ev);
+            break;
+        case transition_kind::AnyState:
+            any.emplace_back(trs[i].ev, ids.find(detail::underlying(trs[i].dst))->second);
+            handled(trs[i].ev);
+            break;
+        case transition_kind::Default:
+            fallback[ids.find(detail::underlying(trs[i].src))->second] =
+                ids.find(detail::underlying(trs[i].dst))->second;
+            has_default = true;
+            break;
+        }
+    }
+    for (uint32_t s = 0; s < n; ++s) {
+        first[s + 1] += first[s];
+    }
+    std::vector<std::pair<Event, uint32_t>> own(first[n]);
+    {
+        std::vector<uint32_t> fill(first.begin(), first.end() - 1);
+        for (uint32_t i = 0; i < trs.size(); ++i) {
+            if (def.kind(i) == transition_kind::Exact) {
+                const uint32_t s = ids.find(detail::underlying(trs[i].src))->second;
+                own[fill[s]++] = { trs[i].ev, ids.find(detail::underlying(trs[i].dst))->second };
+            }
+        }
+    }
+    for (const auto& to : def.timeouts()) {
+        timeout[ids.find(detail::underlying(to.src))->second] =
+            ids.find(detail::underlying(to.dst))->second;
+    }
+
+    /* Successors per state (CSR); `seen` stamps the events a state or a
+       nearer ancestor handles, which hide inherited and any-state entries. */
+    std::vector<uint32_t> succ_first(n + 1, 0);
+    std::vector<uint32_t> succ;
+    succ.reserve(own.size() + n);
+    for (uint32_t s = 0; s < n; ++s) {
+        bool leaves = false;
+        auto add = [&](uint32_t d) {
+            succ.push_back(d);
+            leaves = leaves || d != s;
+        };
+        for (uint32_t a = s, depth = 0; a != none; a = parent[a], ++depth) {
+            for (uint32_t k = first[a]; k < first[a + 1]; ++k) {
+                if (depth == 0 || seen[detail::underlying(own[k].first)] != s) {
+                    add(own[k].second);
+                }
+            }
+            for (uint32_t k = first[a]; k < first[a + 1]; ++k) {
+                seen[detail::underlying(own[k].first)] = s;
+            }
+        }
+        for (const auto& [ev, d] : any) {
+            if (seen[detail::underlying(ev)] != s) {
+                add(d);
+            }
+        }
+        if (fallback[s] != none) {
+            add(fallback[s]);
+        }
+        if (timeout[s] != none) {
+            add(timeout[s]);
+        }
+        if (!leaves) {
+            report.sinks.push_back(states[s]);
+        }
+        succ_first[s + 1] = static_cast<uint32_t>(succ.size());
+    }
+
+    /* Breadth-first search from start. */
+    std::vector<uint8_t> visited(n, 0);
+    std::vector<uint32_t> queue;
+    queue.reserve(n);
+    queue.push_back(start_id);
+    visited[start_id] = 1;
+    uint64_t state_top = 0;
+    for (std::size_t q = 0; q < queue.size(); ++q) {
+        const uint32_t s = queue[q];
+        report.reachable.push_back(states[s]);
+        state_top = std::max(state_top,
+                             static_cast<uint64_t>(detail::underlying(states[s])) + 1);
+        for (uint32_t k = succ_first[s]; k < succ_first[s + 1]; ++k) {
+            if (!visited[succ[k]]) {
+                visited[succ[k]] = 1;
+                queue.push_back(succ[k]);
+            }
+        }
+    }
+    for (uint32_t s = 0; s < n; ++s) {
+        if (!visited[s]) {
+            report.unreachable.push_back(states[s]);
+        }
+    }
+
+    /* A default entry handles every event in its state. */
+    if (!has_default) {
+        auto check = [&](Event e) {
+            if (seen.find(detail::underlying(e)) == seen.end()) {
+                report.unhandled.push_back(e);
+            }
+        };
+        if (!events.empty()) {
+            for (const Event e : events) {
+                check(e);
+            }
+        } else if constexpr (has_enum_count<Event>) {
+            for (std::size_t v = 0; v < enum_count<Event>::value; ++v) {
+                check(static_cast<Event>(v));
+            }
+        }
+    }
+
+    const auto lost = def.shadowed();
+    report.shadowed.assign(lost.begin(), lost.end());
+    report.state_bound = static_cast<std::size_t>(state_top);
+    report.event_bound = static_cast<std::size_t>(event_top);
+    return report;
+}
+
+} /* namespace fsm */
+
+#endif /* FSM_ANALYSIS_HPP */
@@ -0,0 +1,531 @@
+/**
+ * @file async_runtime.hpp
+ * @brief Coroutine actions and awaitable dispatch on one thread.
+ *
+ * `fsm::async_runtime` lets a transition's action be a C++20 coroutine
+ * returning `fsm::task`.  While such an action is suspended (waiting for
+ * network I/O, a timer, ...) the machine is *busy*: events posted to it are
+ * queued in FIFO order and dispatched once the action has finished, so a
+ * thread never blocks on an action and can multiplex any number of
+ * machines.  Synchronous actions and guards work exactly as in
+ * `fsm::runtime`; a transition's state change is committed when its
+ * action (synchronous or not) completes.
+ *
+ * Coroutines can drive machines too: `co_await sm.dispatch(ev)` resumes
+ * with the result once `ev` has been fully processed, and
+ * `co_await sm.next_event()` resumes after the next event the machine
+ * processes, whoever posted it.
+ *
+ * A machine is single-threaded: posting, awaiting and resuming the I/O an
+ * action waits for must all happen on one thread (or be externally
+ * serialised), typically that of an event loop.  Awaiter state lives in
+ * the awaiting coroutine's frame, so dispatch never allocates; only the
+ * coroutine frames of async actions are allocated, by the compiler.
+ */
+
+#ifndef FSM_ASYNC_RUNTIME_HPP
+#define FSM_ASYNC_RUNTIME_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fsm/definition.hpp>
+
+namespace fsm {
+
+/**
+ * @brief Lazily started coroutine without a result.
+ *
+ * Returned by async actions.  A task does nothing until it is awaited by
+ * another coroutine or started with `start()`, and it owns its coroutine
+ * frame.  Exceptions are not propagated: one escaping the coroutine
+ * terminates the program, as for the rest of the library.
+ */
+class task {
+public:
+    struct promise_type;
+    using handle = std::coroutine_handle<promise_type>;
+
+    struct promise_type {
+        std::coroutine_handle<> continuation; /**< Awaiting coroutine */
+        void (*done)(void*) = nullptr;        /**< Completion callback */
+        void* arg = nullptr;                  /**< Completion argument */
+
+        struct final_awaiter {
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(handle h) noexcept {
+                promise_type& p = h.promise();
+                if (p.continuation) {
+                    return p.continuation;
+                }
+                if (p.done != nullptr) {
+                    /* May destroy the frame; nothing here touches it after. */
+                    p.done(p.arg);
+                }
+                return std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        task get_return_object() noexcept {
+            return task(handle::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        final_awaiter final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    task() noexcept = default;
+
+    task(task&& other) noexcept : h_(std::exchange(other.h_, {})) {}
+
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            h_ = std::exchange(other.h_, {});
+        }
+        return *this;
+    }
+
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+
+    ~task() { reset(); }
+
+    /** @brief Whether a coroutine is attached. */
+    explicit operator bool() const noexcept { return static_cast<bool>(h_); }
+
+    /** @brief Whether the coroutine has run to completion. */
+    inline bool done() const noexcept { return !h_ || h_.done(); }
+
+    /**
+     * @brief Run the task detached until its first suspension.
+     *
+     * @param on_done Called with `arg` once the coroutine has finished
+     *                (possibly before `start` returns); it may destroy
+     *                the task.
+     * @param arg     Argument passed to `on_done`.
+     */
+    inline void start(void (*on_done)(void*) = nullptr, void* arg = nullptr) {
+        h_.promise().done = on_done;
+        h_.promise().arg = arg;
+        h_.resume();
+    }
+
+    /** @brief Awaiting a task runs it and resumes when it has finished. */
+    auto operator co_await() const noexcept {
+        struct awaiter {
+            handle h;
+            bool await_ready() const noexcept { return !h || h.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) noexcept {
+                h.promise().continuation = c;
+                return h;
+            }
+            void await_resume() const noexcept {}
+        };
+        return awaiter{ h_ };
+    }
+
+private:
+    explicit task(handle h) noexcept : h_(h) {}
+
+    inline void reset() noexcept {
+        if (h_) {
+            h_.destroy();
+            h_ = {};
+        }
+    }
+
+    handle h_;
+};
+
+namespace detail {
+
+template <class Context>
+struct async_types {
+    using AsyncAction = inplace_function<task(Context&)>;
+    using context_ref = Context*;
+};
+
+template <>
+struct async_types<void> {
+    using AsyncAction = inplace_function<task()>;
+    using context_ref = std::nullptr_t;
+};
+
+} /* namespace detail */
+
+/**
+ * @brief Finite state machine whose actions may be coroutines.
+ *
+ * @tparam State   Enum class (or integral type) identifying states.
+ * @tparam Event   Enum class (or integral type) identifying events.
+ * @tparam Context User‑defined data passed to guards and actions; bound
+ *                 once at construction because actions outlive a call.
+ *
+ * The machine must not move while in use (awaiters and in-flight actions
+ * point at it); destroying it while busy destroys the in-flight action.
+ */
+template <class State, class Event, class Context = void>
+class async_runtime {
+public:
+    using Definition = definition<State, Event, Context>;
+    using Transition = typename Definition::Transition;
+    using Guard = typename Definition::Guard;
+    using Action = typename Definition::Action;
+    using AsyncAction = typename detail::async_types<Context>::AsyncAction;
+    using Result = result;
+
+    /**
+     * @brief One processed event, as reported by `next_event()`.
+     */
+    struct record {
+        State from;    /**< State the event was dispatched in */
+        Event ev;      /**< Dispatched event */
+        State to;      /**< State afterwards */
+        Result result; /**< Dispatch outcome */
+    };
+
+    /* ------------------------------------------------------------ */
+    /* Construction                                                 */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Construct the FSM with an initial state and its context.
+     * @param start Initial state of the machine.
+     * @param ctx   Context for every guard and action; must outlive the
+     *              runtime.
+     * @param mr    Resource the tables and event queue allocate from.
+     */
+    template <typename C = Context>
+        requires (!std::is_void_v<C>)
+    async_runtime(State start, C& ctx,
+                  std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : table_(mr), async_(mr), queue_(mr), ctx_(&ctx), current_(start) {}
+
+    template <typename C = Context>
+        requires (std::is_void_v<C>)
+    explicit async_runtime(State start,
+                           std::pmr::memory_resource* mr =
+                               std::pmr::get_default_resource())
+        : table_(mr), async_(mr), queue_(mr), ctx_(nullptr), current_(start) {}
+
+    async_runtime(const async_runtime&) = delete;
+    async_runtime& operator=(const async_runtime&) = delete;
+
+    /* ------------------------------------------------------------ */
+    /* Transition management                                        */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Add a transition with a synchronous action.
+     *
+     * Overwrites any entry (synchronous or asynchronous) for
+     * `(src, ev)`.
+     *
+     * @see definition::add_transition()
+     */
+    inline bool add_transition(const Transition& tr) {
+        return bind(tr, AsyncAction{});
+    }
+
+    /**
+     * @brief Add a transition whose action is a coroutine.
+     *
+     * When the transition is taken the machine calls `action`, runs the
+     * returned task and stays busy until it finishes; only then does it
+     * move to `dst` and process the next queued event.
+     *
+     * @param src    Source state.
+     * @param ev     Triggering event.
+     * @param dst    Destination state.
+     * @param guard  Optional guard, evaluated synchronously.
+     * @param action Coroutine action.
+     * @return `false` if the table is frozen or a value lies outside a
+     *         declared `fsm::enum_count`.
+     */
+    inline bool add_async_transition(State src, Event ev, State dst,
+                                     Guard guard, AsyncAction action) {
+        return bind(Transition{ src, ev, dst, std::move(guard), nullptr },
+                    std::move(action));
+    }
+
+    /** @see definition::add_any_state() */
+    inline bool add_any_state(Event ev, State dst, Guard guard = nullptr,
+                              Action action = nullptr) {
+        return table_.add_any_state(ev, dst, std::move(guard), std::move(action));
+    }
+
+    /** @see definition::add_default() */
+    inline bool add_default(State src, State dst, Guard guard = nullptr,
+                            Action action = nullptr) {
+        return table_.add_default(src, dst, std::move(guard), std::move(action));
+    }
+
+    /** @see definition::set_parent() */
+    inline bool set_parent(State child, State parent) {
+        return table_.set_parent(child, parent);
+    }
+
+    /** @see definition::freeze() */
+    inline void freeze() { table_.freeze(); }
+
+    /* ------------------------------------------------------------ */
+    /* Dispatch                                                     */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Queue an event without waiting for it.
+     *
+     * An idle machine dispatches it before returning; a busy one (or one
+     * posted to from inside an action) dispatches it after everything
+     * queued before it.
+     */
+    inline void post(Event ev) {
+        enqueue(ev, nullptr);
+    }
+
+    /**
+     * @brief Awaitable dispatch: `Result r = co_await sm.dispatch(ev);`
+     *
+     * Queues `ev` like `post()` and resumes the awaiting coroutine once it
+     * has been processed, including any asynchronous action.  Completes
+     * without suspending when that happens at once.
+     */
+    inline auto dispatch(Event ev) noexcept {
+        return dispatch_awaiter(*this, ev);
+    }
+
+    /**
+     * @brief Awaitable for the next processed event.
+     *
+     * `record r = co_await sm.next_event();` resumes after the next event
+     * this machine finishes processing, whoever posted it.
+     */
+    inline auto next_event() noexcept {
+        return event_awaiter(*this);
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Observers                                                    */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Last committed state (the source while an action runs).
+     */
+    inline State current() const noexcept { return current_; }
+
+    /**
+     * @brief Whether an asynchronous action is in flight.
+     */
+    inline bool busy() const noexcept { return in_flight_; }
+
+    /**
+     * @brief Number of events queued behind the one being processed.
+     */
+    inline std::size_t pending() const noexcept { return queue_.size() - head_; }
+
+    /**
+     * @brief Read-only access to the transition table.
+     */
+    inline const Definition& table() const noexcept { return table_; }
+
+    /**
+     * @brief Number of transitions in the table.
+     */
+    inline std::size_t size() const noexcept { return table_.size(); }
+
+private:
+    class dispatch_awaiter {
+    public:
+        dispatch_awaiter(async_runtime& sm, Event ev) noexcept : sm_(sm), ev_(ev) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            h_ = h;
+            sm_.enqueue(ev_, this);
+            suspended_ = !done_;
+            return suspended_;
+        }
+
+        Result await_resume() const noexcept { return result_; }
+
+    private:
+        friend class async_runtime;
+
+        inline void complete(Result r) {
+            result_ = r;
+            done_ = true;
+            if (suspended_) {
+                h_.resume();
+            }
+        }
+
+        async_runtime& sm_;
+        Event ev_;
+        Result result_ = Result::NoTransition;
+        std::coroutine_handle<> h_;
+        bool done_ = false;
+        bool suspended_ = false;
+    };
+
+    class event_awaiter {
+    public:
+        explicit event_awaiter(async_runtime& sm) noexcept : sm_(sm) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> h) noexcept {
+            h_ = h;
+            next_ = nullptr;
+            if (sm_.watch_tail_ != nullptr) {
+                sm_.watch_tail_->next_ = this;
+            } else {
+                sm_.watch_head_ = this;
+            }
+            sm_.watch_tail_ = this;
+        }
+
+        record await_resume() const noexcept { return rec_; }
+
+    private:
+        friend class async_runtime;
+
+        async_runtime& sm_;
+        std::coroutine_handle<> h_;
+        record rec_{};
+        event_awaiter* next_ = nullptr;
+    };
+
+    struct queued {
+        Event ev;
+        dispatch_awaiter* waiter;
+    };
+
+    /* Store `tr` and its (possibly empty) coroutine action by ordinal.
+       Without append_transition or reordering, ordinals never move. */
+    inline bool bind(const Transition& tr, AsyncAction action) {
+        if (!table_.add_transition(tr)) {
+            return false;
+        }
+        const uint32_t i = table_.ordinal(tr.src, tr.ev);
+        if (async_.size() < table_.size()) {
+            async_.resize(table_.size());
+        }
+        async_[i] = std::move(action);
+        return true;
+    }
+
+    inline void enqueue(Event ev, dispatch_awaiter* w) {
+        queue_.push_back({ ev, w });
+        pump();
+    }
+
+    /* Dispatch queued events until one suspends or none are left. */
+    inline void pump() {
+        if (pumping_) {
+            return;
+        }
+        pumping_ = true;
+        while (!in_flight_ && head_ < queue_.size()) {
+            const queued q = queue_[head_++];
+            if (head_ == queue_.size()) {
+                queue_.clear();
+                head_ = 0;
+            }
+            step(q);
+        }
+        pumping_ = false;
+    }
+
+    inline void step(const queued& q) {
+        const State from = current_;
+        Result r;
+        uint32_t i;
+        if constexpr (std::is_void_v<Context>) {
+            i = table_.resolve(from, q.ev, r);
+        } else {
+            i = table_.resolve(from, q.ev, r, *ctx_);
+        }
+        if (i == perfect_hash::npos) {
+            complete(q, from, r);
+            return;
+        }
+        if (i < async_.size() && async_[i]) {
+            if constexpr (std::is_void_v<Context>) {
+                active_ = async_[i]();
+            } else {
+                active_ = async_[i](*ctx_);
+            }
+            /* An action may return an empty task: nothing to wait for. */
+            if (active_) {
+                in_flight_ = true;
+                flight_ = { q, from, i };
+                active_.start(&action_done, this);
+                return;
+            }
+        } else if constexpr (std::is_void_v<Context>) {
+            table_.run_action(i);
+        } else {
+            table_.run_action(i, *ctx_);
+        }
+        current_ = table_.target(i);
+        complete(q, from, Result::Ok);
+    }
+
+    /* Called from the action's final suspension point. */
+    static void action_done(void* p) {
+        async_runtime& self = *static_cast<async_runtime*>(p);
+        self.active_ = task{};
+        self.in_flight_ = false;
+        self.current_ = self.table_.target(self.flight_.ordinal);
+        self.complete(self.flight_.q, self.flight_.from, Result::Ok);
+        self.pump();
+    }
+
+    /* Resume the event's own waiter, then every next_event() waiter;
+       a resumed coroutine may post more events meanwhile. */
+    inline void complete(const queued& q, State from, Result r) {
+        const record rec{ from, q.ev, current_, r };
+        event_awaiter* w = watch_head_;
+        watch_head_ = watch_tail_ = nullptr;
+        if (q.waiter != nullptr) {
+            q.waiter->complete(r);
+        }
+        while (w != nullptr) {
+            event_awaiter* next = w->next_;
+            w->rec_ = rec;
+            w->h_.resume();
+            w = next;
+        }
+    }
+
+    struct flight {
+        queued q;
+        State from;
+        uint32_t ordinal;
+    };
+
+    Definition table_;                          /**< Routing and sync actions */
+    std::pmr::vector<AsyncAction> async_;       /**< Coroutine action by ordinal */
+    std::pmr::vector<queued> queue_;            /**< Events not yet dispatched */
+    std::size_t head_ = 0;                      /**< First undispatched entry */
+    typename detail::async_types<Context>::context_ref ctx_; /**< Bound context */
+    State current_;                             /**< Last committed state */
+    task active_;                               /**< In-flight async action */
+    flight flight_{};                           /**< What `active_` belongs to */
+    event_awaiter* watch_head_ = nullptr;       /**< next_event() waiters */
+    event_awaiter* watch_tail_ = nullptr;
+    bool in_flight_ = false;                    /**< `active_` is running */
+    bool pumping_ = false;                      /**< Inside pump() */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_ASYNC_RUNTIME_HPP */
@@ -0,0 +1,323 @@
+/**
+ * @file atomic_runtime.hpp
+ * @brief Lock-free FSM whose current state many threads may drive at once.
+ *
+ * `fsm::atomic_runtime` keeps its current state in a `std::atomic` and
+ * commits every transition with a compare-and-swap, so `dispatch` may be
+ * called from any number of threads without an external mutex.  The
+ * transition table is built single-threaded and is only read afterwards.
+ *
+ * Dispatch contract, per call:
+ *
+ *  1. The current state `s` is loaded and the transition for `(s, ev)` is
+ *     chosen exactly as `fsm::runtime` would, guards included.
+ *  2. The destination is committed with one CAS from `s`.  If another
+ *     thread changed the state in between, the choice is discarded and
+ *     the call starts over from the new state.
+ *  3. After a successful CAS, and only then, the action runs, once, on
+ *     the calling thread.
+ *
+ * Guards may therefore be evaluated several times per call and must be
+ * free of side effects.  An action runs after its state change is already
+ * visible, so other threads may dispatch from the new state (and run
+ * their own actions) before it finishes; actions must be idempotent or
+ * just record work for later.  `NoTransition` and `GuardRejected` describe
+ * the state observed by the last attempt.
+ */
+
+#ifndef FSM_ATOMIC_RUNTIME_HPP
+#define FSM_ATOMIC_RUNTIME_HPP
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fsm/definition.hpp>
+
+namespace fsm {
+
+/**
+ * @brief Finite state machine with an atomic current state.
+ *
+ * @tparam State   Enum class (or integral type) identifying states; must
+ *                 be lock-free as a `std::atomic`.
+ * @tparam Event   Enum class (or integral type) identifying events.
+ * @tparam Context User‑defined data that is passed to guard/action callables.
+ */
+template <class State, class Event, class Context = void>
+class atomic_runtime {
+    static_assert(std::atomic<State>::is_always_lock_free,
+                  "atomic_runtime needs a State that is lock-free as std::atomic");
+
+public:
+    using Definition = definition<State, Event, Context>;
+    using Transition = typename Definition::Transition;
+    using Guard = typename Definition::Guard;
+    using Action = typename Definition::Action;
+    using Result = result;
+
+    /* ------------------------------------------------------------ */
+    /* Construction                                                 */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Construct the FSM with an initial state.
+     * @param start Initial state of the machine.
+     * @param mr    Resource the transition table allocates from; must
+     *              outlive the runtime.
+     */
+    explicit atomic_runtime(State start,
+                            std::pmr::memory_resource* mr =
+                                std::pmr::get_default_resource())
+        : table_(mr), current_(start) {}
+
+    atomic_runtime(const atomic_runtime&) = delete;
+    atomic_runtime& operator=(const atomic_runtime&) = delete;
+
+    /* ------------------------------------------------------------ */
+    /* Transition management (not thread-safe)                      */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Add a transition to the table.
+     *
+     * The table must be complete before the first concurrent `dispatch`;
+     * building it while another thread dispatches is a data race.
+     *
+     * @see definition::add_transition()
+     */
+    inline bool add_transition(const Transition& tr) {
+        return table_.add_transition(tr);
+    }
+
+    /**
+     * @brief Add every transition of `range` in one pass.
+     * @see definition::add_transitions()
+     */
+    template <std::ranges::input_range R>
+        requires std::convertible_to<std::ranges::range_reference_t<R>,
+                                     const Transition&>
+    inline bulk_report add_transitions(R&& range,
+                                       on_duplicate policy = on_duplicate::Overwrite,
+                                       std::vector<std::size_t>* duplicates = nullptr) {
+        return table_.add_transitions(std::forward<R>(range), policy, duplicates);
+    }
+
+    inline bulk_report add_transitions(std::initializer_list<Transition> list,
+                                       on_duplicate policy = on_duplicate::Overwrite,
+                                       std::vector<std::size_t>* duplicates = nullptr) {
+        return table_.add_transitions(list, policy, duplicates);
+    }
+
+    /** @see definition::append_transition() */
+    inline bool append_transition(const Transition& tr) {
+        return table_.append_transition(tr);
+    }
+
+    /** @see definition::add_any_state() */
+    inline bool add_any_state(Event ev, State dst, Guard guard = nullptr,
+                              Action action = nullptr) {
+        return table_.add_any_state(ev, dst, std::move(guard), std::move(action));
+    }
+
+    /** @see definition::add_default() */
+    inline bool add_default(State src, State dst, Guard guard = nullptr,
+                            Action action = nullptr) {
+        return table_.add_default(src, dst, std::move(guard), std::move(action));
+    }
+
+    /** @see definition::set_parent() */
+    inline bool set_parent(State child, State parent) {
+        return table_.set_parent(child, parent);
+    }
+
+    /**
+     * @brief Compile the table into its perfectly hashed form.
+     *
+     * Recommended before the machine is shared between threads.
+     * @see definition::freeze()
+     */
+    inline void freeze() { table_.freeze(); }
+
+    /* ------------------------------------------------------------ */
+    /* Dispatch (thread-safe)                                       */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Dispatch an event, retrying until the commit succeeds.
+     *
+     * @param ev  Event to dispatch.
+     * @param ctx Context passed to guard/action callables.
+     * @return `Ok` once a transition was committed and its action ran,
+     *         otherwise why the last observed state had none.
+     */
+    template <typename C = Context>
+    inline Result dispatch(Event ev, C& ctx) requires (!std::is_void_v<C>) {
+        return commit(ev, ctx);
+    }
+
+    inline Result dispatch(Event ev) requires (std::is_void_v<Context>) {
+        return commit(ev);
+    }
+
+    /**
+     * @brief Commit a transition but hand its action back as a ticket.
+     *
+     * Same retry loop as `dispatch()`; the action of the committed
+     * transition is returned in `t` for `table().run()` instead of being
+     * run here, so callers can queue actions for a single worker instead
+     * of running them on every dispatching thread.
+     */
+    template <typename C = Context>
+    inline Result dispatch_deferred(Event ev, const C& ctx, action_ticket& t)
+        requires (!std::is_void_v<C>) {
+        return commit_deferred(ev, t, ctx);
+    }
+
+    inline Result dispatch_deferred(Event ev, action_ticket& t)
+        requires (std::is_void_v<Context>) {
+        return commit_deferred(ev, t);
+    }
+
+    /**
+     * @brief Dispatch an event only if the machine is in `expected`.
+     *
+     * One attempt, no retry: when the state is not `expected` (or changes
+     * before the commit) nothing runs, `expected` is set to the state that
+     * was found and `false` is returned.  Otherwise `r` receives the
+     * outcome and `true` is returned.
+     */
+    template <typename C = Context>
+    inline bool dispatch_from(State& expected, Event ev, C& ctx, Result& r)
+        requires (!std::is_void_v<C>) {
+        return attempt(expected, ev, r, ctx);
+    }
+
+    inline bool dispatch_from(State& expected, Event ev, Result& r)
+        requires (std::is_void_v<Context>) {
+        return attempt(expected, ev, r);
+    }
+
+    /* ------------------------------------------------------------ */
+    /* State                                                        */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Most recently committed state.
+     */
+    inline State current() const noexcept {
+        return current_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Force the current state, bypassing the table.
+     */
+    inline void reset(State s) noexcept {
+        current_.store(s, std::memory_order_release);
+    }
+
+    /**
+     * @brief Capture the most recently committed state.
+     */
+    inline machine_snapshot<State> snapshot() const noexcept {
+        return { current() };
+    }
+
+    /**
+     * @brief Publish `s.state` as the current state, like `reset()`.
+     * @return `false` (and no change) if the state lies outside a declared
+     *         `fsm::enum_count`.
+     */
+    inline bool restore(const machine_snapshot<State>& s) noexcept {
+        if (!detail::in_declared_range(s.state)) {
+            return false;
+        }
+        reset(s.state);
+        return true;
+    }
+
+    /**
+     * @brief Read-only access to the transition table.
+     */
+    inline const Definition& table() const noexcept { return table_; }
+
+    /**
+     * @brief Number of transitions in the table.
+     */
+    inline std::size_t size() const noexcept { return table_.size(); }
+
+    /**
+     * @brief Approximate bytes used by the table and this machine.
+     */
+    inline memory_report memory_usage() const noexcept {
+        memory_report r = table_.memory_usage();
+        r.per_instance = sizeof(current_);
+        r.instances = sizeof(current_);
+        return r;
+    }
+
+private:
+    template <class... C>
+    inline Result commit(Event ev, C&... ctx) {
+        State s = current_.load(std::memory_order_acquire);
+        Result r;
+        while (!attempt(s, ev, r, ctx...)) {
+        }
+        return r;
+    }
+
+    template <class... C>
+    inline Result commit_deferred(Event ev, action_ticket& t, const C&... ctx) {
+        State s = current_.load(std::memory_order_acquire);
+        Result r;
+        uint32_t i;
+        while (!select(s, ev, r, i, ctx...)) {
+        }
+        t.ordinal = i != perfect_hash::npos
+                        && table_.transitions()[i].action ? i : perfect_hash::npos;
+        return r;
+    }
+
+    /* Choose from `s`, then publish with one CAS; the action runs only
+       once the CAS has succeeded. */
+    template <class... C>
+    inline bool attempt(State& s, Event ev, Result& r, C&... ctx) {
+        uint32_t i;
+        if (!select(s, ev, r, i, ctx...)) {
+            return false;
+        }
+        if (i != perfect_hash::npos) {
+            table_.run_action(i, ctx...);
+        }
+        return true;
+    }
+
+    /* One commit attempt from `s`: `false` if the state moved on (`s` is
+       then refreshed), otherwise `i` is the committed ordinal or npos. */
+    template <class... C>
+    inline bool select(State& s, Event ev, Result& r, uint32_t& i, C&... ctx) {
+        i = table_.resolve(s, ev, r, ctx...);
+        if (i == perfect_hash::npos) {
+            /* Report a miss only for a state that was still current. */
+            const State now = current_.load(std::memory_order_acquire);
+            if (now != s) {
+                s = now;
+                return false;
+            }
+            return true;
+        }
+        return current_.compare_exchange_strong(s, table_.target(i),
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire);
+    }
+
+    Definition table_;                           /**< Transition table */
+    alignas(64) std::atomic<State> current_;     /**< Kept off the table's line */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_ATOMIC_RUNTIME_HPP */
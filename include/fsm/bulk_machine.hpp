@@ -0,0 +1,468 @@
+/**
+ * @file bulk_machine.hpp
+ * @brief Struct-of-arrays engine driving many instances of one definition.
+ *
+ * `fsm::bulk_machine` keeps the current states of N machines that share a
+ * single `fsm::definition` in one contiguous array of the narrowest
+ * unsigned type able to index `StateCount` states (`uint8_t` for up to 256
+ * states).  The definition is compiled into an event-major dense
+ * next-state table, so broadcasting an event to every instance is one
+ * tight loop of table lookups over contiguous memory.
+ *
+ * Events whose transitions have neither guard nor action take a pure path
+ * (`states[i] = column[states[i]]`, missing transitions mapped to
+ * themselves) which the compiler can vectorise as a gather.  Columns that
+ * contain guarded or action-bearing transitions fall back to the full
+ * dispatch logic for those cells only.
+ *
+ * Like `fsm::instance`, the engine references the definition, which must
+ * outlive it and must not be modified afterwards.
+ *
+ * With the `fsm::wheel_timers` policy every instance gets a timer, allocated
+ * with the engine, for the definition's `add_timeout()` entries; see
+ * `attach_timers()`.
+ */
+
+#ifndef FSM_BULK_MACHINE_HPP
+#define FSM_BULK_MACHINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <fsm/definition.hpp>
+#include <fsm/timing_wheel.hpp>
+
+namespace fsm {
+
+/**
+ * @brief Bulk dispatch engine over a shared definition.
+ *
+ * @tparam State      Enum class (or integral type) identifying states.
+ * @tparam Event      Enum class (or integral type) identifying events.
+ * @tparam StateCount Number of states; values must lie in `[0, StateCount)`.
+ * @tparam EventCount Number of events; values must lie in `[0, EventCount)`.
+ * @tparam Context    User-defined data passed to guard/action callables.
+ * @tparam Timers     Timeout policy (see timing_wheel.hpp).
+ */
+template <class State, class Event, std::size_t StateCount,
+          std::size_t EventCount, class Context = void,
+          class Timers = no_timers>
+class bulk_machine {
+    static_assert(StateCount > 0 && EventCount > 0,
+                  "bulk_machine requires at least one state and one event");
+
+public:
+    using Definition = definition<State, Event, Context>;
+    using Transition = typename Definition::Transition;
+    using Timeout = typename Definition::Timeout;
+    using Result = result;
+
+    /** @brief Storage type of one instance's state. */
+    using index_type = detail::least_uint_t<StateCount>;
+
+    /**
+     * @brief Compile a definition and create `count` instances.
+     *
+     * Transitions whose source, event or destination lie outside the
+     * declared ranges are ignored.  Cells are resolved through
+     * `definition::find()`, so inherited and wildcard transitions apply.
+     *
+     * @param def   Shared transition table; must outlive the engine.
+     * @param count Number of instances.
+     * @param start Initial state of every instance; must be in range.
+     */
+    bulk_machine(const Definition& def, std::size_t count, State start)
+        : next_(StateCount * EventCount),
+          slow_(StateCount * EventCount),
+          pure_column_(EventCount, 1),
+          states_(count, to_index(start)) {
+        if constexpr (Timers::enabled) {
+            timeouts_.assign(StateCount, nullptr);
+            for (const Timeout& to : def.timeouts()) {
+                const auto src =
+                    static_cast<uint64_t>(detail::underlying(to.src));
+                const auto dst =
+                    static_cast<uint64_t>(detail::underlying(to.dst));
+                if (src < StateCount && dst < StateCount) {
+                    timeouts_[to_index(to.src)] = &to;
+                }
+            }
+            timers_.timers = std::make_unique<timer[]>(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                timers_.timers[i].bind(&expire, this);
+            }
+        }
+        for (std::size_t e = 0; e < EventCount; ++e) {
+            for (std::size_t s = 0; s < StateCount; ++s) {
+                next_[e * StateCount + s] = static_cast<index_type>(s);
+            }
+        }
+        /* find() applies nesting and wildcards, so every cell is resolved. */
+        for (std::size_t s = 0; s < StateCount; ++s) {
+            for (std::size_t e = 0; e < EventCount; ++e) {
+                const auto cands =
+                    def.candidates(static_cast<State>(s), static_cast<Event>(e));
+                if (cands.empty()) {
+                    continue;
+                }
+                bool in_range = true;
+                for (const Transition& tr : cands) {
+                    in_range = in_range && static_cast<uint64_t>(
+                        detail::underlying(tr.dst)) < StateCount;
+                }
+                if (!in_range) {
+                    continue;
+                }
+                const std::size_t cell = e * StateCount + s;
+                next_[cell] = to_index(cands.front().dst);
+                /* slow_ also tells dispatch_batch which cells exist at all. */
+                slow_[cell] = cands;
+                if (cands.size() > 1 || cands.front().guard || cands.front().action) {
+                    pure_column_[e] = 0;
+                }
+            }
+        }
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Broadcast dispatch                                           */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Dispatch one event to every instance.
+     * @param ev  Event to dispatch; out-of-range events are ignored.
+     * @param ctx Context passed to guard/action callables.
+     */
+    template <typename C = Context>
+    inline void dispatch_all(Event ev, C& ctx) requires (!std::is_void_v<C>) {
+        broadcast(ev, ctx);
+    }
+
+    inline void dispatch_all(Event ev) requires (std::is_void_v<Context>) {
+        broadcast(ev);
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Batched dispatch                                             */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Dispatch `evs[i]` to instance `ids[i]`, in order.
+     *
+     * Only the first `min(ids.size(), evs.size())` pairs are processed.
+     *
+     * @param ids Instance indices; must be `< size()`.
+     * @param evs Events, one per index.
+     * @param ctx Context passed to guard/action callables.
+     * @return Number of dispatches that returned `Result::Ok`.
+     */
+    template <typename C = Context>
+    inline std::size_t dispatch_batch(std::span<const std::size_t> ids,
+                                      std::span<const Event> evs, C& ctx)
+        requires (!std::is_void_v<C>) {
+        return batch(ids, evs, ctx);
+    }
+
+    inline std::size_t dispatch_batch(std::span<const std::size_t> ids,
+                                      std::span<const Event> evs)
+        requires (std::is_void_v<Context>) {
+        return batch(ids, evs);
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Timeouts                                                     */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Drive every instance's timeouts from `wheel`.
+     *
+     * Requires the `fsm::wheel_timers` policy.  Each instance's timeout is
+     * armed at once, relative to `wheel.now()`; afterwards every
+     * transition an instance takes re-arms or cancels its own timer, and
+     * `wheel.tick()` moves expired instances, running timeout actions with
+     * `ctx`.  The timers were allocated with the engine, so arming and
+     * cancelling never allocate.  While attached, broadcasts take the
+     * per-instance path instead of the pure gather.
+     *
+     * @param wheel Wheel to arm on; must outlive the attachment.
+     * @param ctx   Context for timeout actions; must outlive the attachment.
+     */
+    template <typename C = Context>
+    inline void attach_timers(timing_wheel& wheel, C& ctx)
+        requires (Timers::enabled && !std::is_void_v<C>) {
+        timers_.ctx = &ctx;
+        attach(wheel);
+    }
+
+    inline void attach_timers(timing_wheel& wheel)
+        requires (Timers::enabled && std::is_void_v<Context>) {
+        attach(wheel);
+    }
+
+    /**
+     * @brief Cancel all pending timeouts and stop arming new ones.
+     */
+    inline void detach_timers() noexcept requires (Timers::enabled) {
+        for (std::size_t i = 0; i < states_.size(); ++i) {
+            timers_.timers[i].cancel();
+        }
+        timers_.wheel = nullptr;
+    }
+
+    /**
+     * @brief Timer of instance `i` (armed while its timeout is pending).
+     */
+    inline const timer& timeout_timer(std::size_t i) const noexcept
+        requires (Timers::enabled) {
+        return timers_.timers[i];
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Observers                                                    */
+    /* ------------------------------------------------------------ */
+    /** @brief Number of instances. */
+    inline std::size_t size() const noexcept { return states_.size(); }
+
+    /** @brief Current state of instance `i`. */
+    inline State state(std::size_t i) const noexcept {
+        return static_cast<State>(states_[i]);
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Checkpointing                                                */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief All instance states, contiguous, one `index_type` each.
+     *
+     * A checkpoint of the whole engine is one copy of this span (e.g.
+     * `std::as_bytes(bulk.states())` written to a file).
+     */
+    inline std::span<const index_type> states() const noexcept {
+        return { states_.data(), states_.size() };
+    }
+
+    /**
+     * @brief Copy the states of the first `out.size()` instances to `out`.
+     * @return Number of states copied.
+     */
+    inline std::size_t export_states(std::span<index_type> out) const noexcept {
+        const std::size_t n = out.size() < states_.size() ? out.size() : states_.size();
+        if (n != 0) {
+            std::memcpy(out.data(), states_.data(), n * sizeof(index_type));
+        }
+        return n;
+    }
+
+    /**
+     * @brief Replace every instance state with those of a checkpoint.
+     *
+     * No action runs.  With attached timers every instance's timeout is
+     * restarted for its full duration.
+     *
+     * @param in One state per instance, as from `states()`.
+     * @return `false` (and no change) if `in.size() != size()` or a state
+     *         is not in `[0, StateCount)`.
+     */
+    inline bool import_states(std::span<const index_type> in) noexcept {
+        if (in.size() != states_.size()) {
+            return false;
+        }
+        if constexpr (StateCount <= std::numeric_limits<index_type>::max()) {
+            /* Branch-free maximum, so the check vectorises. */
+            index_type top = 0;
+            for (const index_type s : in) {
+                top = s > top ? s : top;
+            }
+            if (top >= StateCount) {
+                return false;
+            }
+        }
+        if (!in.empty()) {
+            std::memcpy(states_.data(), in.data(), in.size() * sizeof(index_type));
+        }
+        if constexpr (Timers::enabled) {
+            if (timers_.wheel != nullptr) {
+                for (std::size_t i = 0; i < states_.size(); ++i) {
+                    retime(i);
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Approximate bytes of the compiled tables and all states.
+     *
+     * The referenced definition is not included.
+     */
+    inline memory_report memory_usage() const noexcept {
+        memory_report r;
+        r.hot = next_.capacity() * sizeof(index_type)
+              + pure_column_.capacity() * sizeof(uint8_t);
+        r.cold = slow_.capacity() * sizeof(std::span<const Transition>);
+        r.per_instance = sizeof(index_type);
+        r.instances = states_.capacity() * sizeof(index_type);
+        if constexpr (Timers::enabled) {
+            r.cold += timeouts_.capacity() * sizeof(const Timeout*);
+            r.per_instance += sizeof(timer);
+            r.instances += states_.size() * sizeof(timer);
+        }
+        return r;
+    }
+
+private:
+    static constexpr index_type to_index(State s) noexcept {
+        return static_cast<index_type>(detail::underlying(s));
+    }
+
+    static constexpr bool event_in_range(Event ev) noexcept {
+        return static_cast<uint64_t>(detail::underlying(ev)) < EventCount;
+    }
+
+    static constexpr std::size_t column(Event ev) noexcept {
+        return static_cast<std::size_t>(detail::underlying(ev)) * StateCount;
+    }
+
+    /*
+     * Full dispatch logic for one cell; returns the Result and updates s.
+     */
+    template <class... C>
+    static inline Result step(std::span<const Transition> cands,
+                              index_type& s, C&... ctx) {
+        if (cands.empty()) {
+            return Result::NoTransition;
+        }
+        for (const Transition& tr : cands) {
+            if (tr.guard && !tr.guard(ctx...)) {
+                continue;
+            }
+            if (tr.action) {
+                tr.action(ctx...);
+            }
+            s = to_index(tr.dst);
+            return Result::Ok;
+        }
+        return Result::GuardRejected;
+    }
+
+    /*
+     * Guard/action free column: a pure gather.  The table and the states
+     * never overlap, which the restrict qualifiers tell the vectoriser.
+     */
+    static inline void gather(index_type* __restrict states,
+                              const index_type* __restrict next,
+                              std::size_t n) noexcept {
+        for (std::size_t i = 0; i < n; ++i) {
+            states[i] = next[states[i]];
+        }
+    }
+
+    template <class... C>
+    inline void broadcast(Event ev, C&... ctx) {
+        if (!event_in_range(ev)) {
+            return;
+        }
+        const index_type* next = next_.data() + column(ev);
+        index_type* states = states_.data();
+        const std::size_t n = states_.size();
+        const std::span<const Transition>* slow = slow_.data() + column(ev);
+        if constexpr (Timers::enabled) {
+            if (timers_.wheel != nullptr) {
+                /* Every taken transition restarts that instance's timeout. */
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (step(slow[states[i]], states[i], ctx...)
+                        == Result::Ok) {
+                        retime(i);
+                    }
+                }
+                return;
+            }
+        }
+        if (pure_column_[static_cast<std::size_t>(detail::underlying(ev))]) {
+            gather(states, next, n);
+            return;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const index_type s = states[i];
+            const auto cands = slow[s];
+            if (cands.size() == 1 && !(cands[0].guard || cands[0].action)) {
+                states[i] = next[s];
+            } else {
+                step(cands, states[i], ctx...);
+            }
+        }
+    }
+
+    template <class... C>
+    inline std::size_t batch(std::span<const std::size_t> ids,
+                             std::span<const Event> evs, C&... ctx) {
+        const std::size_t n = ids.size() < evs.size() ? ids.size() : evs.size();
+        std::size_t ok = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!event_in_range(evs[i])) {
+                continue;
+            }
+            index_type& s = states_[ids[i]];
+            const std::size_t cell = column(evs[i]) + s;
+            if (step(slow_[cell], s, ctx...) == Result::Ok) {
+                ++ok;
+                if constexpr (Timers::enabled) {
+                    if (timers_.wheel != nullptr) {
+                        retime(ids[i]);
+                    }
+                }
+            }
+        }
+        return ok;
+    }
+
+    inline void retime(std::size_t i) noexcept {
+        timing_wheel& wheel = *timers_.wheel;
+        if (const Timeout* to = timeouts_[states_[i]]) {
+            wheel.arm(timers_.timers[i], wheel.now() + to->after);
+        } else {
+            timers_.timers[i].cancel();
+        }
+    }
+
+    inline void attach(timing_wheel& wheel) noexcept {
+        timers_.wheel = &wheel;
+        for (std::size_t i = 0; i < states_.size(); ++i) {
+            retime(i);
+        }
+    }
+
+    static inline void expire(timer& t, void* self) {
+        bulk_machine& m = *static_cast<bulk_machine*>(self);
+        const auto i = static_cast<std::size_t>(&t - m.timers_.timers.get());
+        const Timeout* to = m.timeouts_[m.states_[i]];
+        if (to == nullptr) {
+            return;
+        }
+        if (to->action) {
+            if constexpr (std::is_void_v<Context>) {
+                to->action();
+            } else {
+                to->action(*m.timers_.ctx);
+            }
+        }
+        m.states_[i] = to_index(to->dst);
+        m.retime(i);
+    }
+
+    std::vector<index_type> next_;         /**< Event-major next-state table */
+    std::vector<std::span<const Transition>> slow_; /**< Event-major candidate lists */
+    std::vector<uint8_t> pure_column_;     /**< Column has no callables */
+    std::vector<index_type> states_;       /**< Current state per instance */
+    std::vector<const Timeout*> timeouts_; /**< Timeout per state, if enabled */
+    [[no_unique_address]] detail::timer_hook<Timers::enabled, Context,
+                                             std::unique_ptr<timer[]>>
+        timers_;                           /**< Instance timers, if enabled */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_BULK_MACHINE_HPP */
@@ -0,0 +1,1620 @@
+/**
+ * @file definition.hpp
+ * @brief Shareable FSM definition: the transition table without any state.
+ *
+ * `fsm::definition` owns the transitions of a machine (storage, key index,
+ * optional frozen perfect hash) but no current state.  It is the table
+ * behind `fsm::runtime`, and can also be built once and shared by any
+ * number of lightweight `fsm::instance` handles that each hold only a
+ * pointer to it and their own current state.
+ *
+ * Transitions are stored contiguously and indexed by a 64‑bit composite of
+ * the source state and event: through an `unordered_map` while the table
+ * is being built, and through a static perfect hash once `freeze()` has
+ * been called.
+ *
+ * All table storage (transitions, hot records, key index, perfect hash) is
+ * allocated from a `std::pmr::memory_resource` given at construction, so
+ * many machines can be built into one monotonic arena and released
+ * together.  Guards and actions never allocate (see inplace_function.hpp).
+ *
+ * Storage is split by temperature: dispatch reads a compact hot record
+ * per transition (destination plus guard/action flags) and only touches
+ * the full `Transition`, with its callable storage, when the transition
+ * actually has a guard or an action.
+ *
+ * States may be nested with `set_parent()`: an event the current state
+ * does not handle bubbles up to its ancestors.  `freeze()` flattens the
+ * inherited transitions into the perfect hash under each descendant's own
+ * key, so a frozen hierarchy dispatches with the same single lookup as a
+ * flat table.
+ */
+
+#ifndef FSM_DEFINITION_HPP
+#define FSM_DEFINITION_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <map>
+#include <memory_resource>
+#include <ostream>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <fsm/dot_writer.hpp>
+#include <fsm/inplace_function.hpp>
+#include <fsm/perfect_hash.hpp>
+
+namespace fsm {
+
+/**
+ * @brief Internal traits to handle void vs non-void context types.
+ *
+ * Guards and actions are `fsm::inplace_function`s: they never allocate and
+ * keep a `Transition` trivially copyable.
+ */
+template <typename Context>
+struct fsm_types {
+    using Guard = inplace_function<bool(const Context&)>;
+    using Action = inplace_function<void(Context&)>;
+};
+
+template <>
+struct fsm_types<void> {
+    using Guard = inplace_function<bool()>;
+    using Action = inplace_function<void()>;
+};
+
+/**
+ * @brief Result of a dispatch operation.
+ *
+ * Shared by every machine flavour so that call sites can switch between
+ * storage backends without touching their result handling.
+ */
+enum class result {
+    Ok,             /**< Transition performed */
+    NoTransition,   /**< No matching transition for current state/event */
+    GuardRejected   /**< Guard evaluated to false */
+};
+
+/**
+ * @brief How a table entry matches (see `definition::kind()`).
+ */
+enum class transition_kind : uint8_t {
+    Exact,    /**< One `(src, ev)` pair */
+    AnyState, /**< Event `ev` in any state (`src` is ignored) */
+    Default   /**< Any otherwise unhandled event in `src` (`ev` is ignored) */
+};
+
+/**
+ * @brief What `definition::add_transitions()` does with an entry whose
+ *        `(src, ev)` key is already in the table.
+ */
+enum class on_duplicate : uint8_t {
+    Overwrite, /**< Replace the existing entry, as `add_transition()` does */
+    Keep       /**< Keep the existing entry and skip the new one */
+};
+
+/**
+ * @brief Outcome of `definition::add_transitions()`.
+ *
+ * Every entry of the batch is counted exactly once.
+ */
+struct bulk_report {
+    std::size_t added = 0;      /**< Stored under a key new to the table */
+    std::size_t duplicates = 0; /**< Key already present (overwritten or kept) */
+    std::size_t rejected = 0;   /**< Out of range, or the table is frozen */
+
+    /** Whether every entry was stored under a fresh key. */
+    inline bool clean() const noexcept {
+        return duplicates == 0 && rejected == 0;
+    }
+};
+
+/**
+ * @brief Pending action of a transition taken by `dispatch_deferred()`.
+ *
+ * Four trivially copyable bytes naming the transition by ordinal, so a
+ * ticket can be kept in a batch or handed to a worker through an
+ * `fsm::event_queue`.  Run it with `run()` on the table that issued it,
+ * before that table is next modified.
+ */
+struct action_ticket {
+    uint32_t ordinal = perfect_hash::npos; /**< Transition, or npos when none */
+
+    /** Whether there is an action to run. */
+    explicit operator bool() const noexcept {
+        return ordinal != perfect_hash::npos;
+    }
+};
+
+/**
+ * @brief Per-machine state captured by `snapshot()` for `restore()`.
+ *
+ * Trivially copyable, so checkpoints can be written out and read back as
+ * raw bytes.  The transition table is not included: restore into a
+ * machine built from the same definition.
+ */
+template <class State>
+struct machine_snapshot {
+    State    state;            /**< Current state */
+    uint64_t timeout_left = 0; /**< Ticks left on a pending timeout, or 0 */
+};
+
+/**
+ * @brief An exact transition replaced by a later one with the same key.
+ *
+ * Recorded by `add_transition()` (and `add_transitions()` with
+ * `on_duplicate::Overwrite`); see `definition::shadowed()`.
+ */
+template <class State, class Event>
+struct shadowed_transition {
+    State src;   /**< Source state of the key */
+    Event ev;    /**< Event of the key */
+    State lost;  /**< Destination of the replaced entry */
+    State dst;   /**< Destination of the entry that replaced it */
+};
+
+/**
+ * @brief Declared number of values of a state or event type.
+ *
+ * Specialise with `static constexpr std::size_t value = N;` when every
+ * value of `T` lies in `[0, N)`.  Nothing is inferred from enumerator
+ * names, since a `Count` that is not last would silently drop values.
+ * Tables over counted types store states and keys in the narrowest
+ * unsigned type that fits (see `definition::key_type`) and reject
+ * out-of-range values.
+ */
+template <class T>
+struct enum_count {};
+
+/**
+ * @brief Whether `fsm::enum_count<T>` declares a value count.
+ */
+template <class T>
+inline constexpr bool has_enum_count = requires { enum_count<T>::value; };
+
+namespace detail {
+
+/**
+ * @brief Convert an enum or integral value to its underlying integer.
+ */
+template <class T>
+constexpr auto underlying(T v) noexcept {
+    if constexpr (std::is_enum_v<T>) {
+        return static_cast<std::underlying_type_t<T>>(v);
+    } else {
+        return v;
+    }
+}
+
+/**
+ * @brief Narrowest unsigned integer able to hold values in `[0, N)`.
+ */
+template <std::size_t N>
+using least_uint_t = std::conditional_t<
+    (N <= 0x100), uint8_t,
+    std::conditional_t<(N <= 0x10000), uint16_t,
+                       std::conditional_t<(N <= 0x100000000ULL), uint32_t,
+                                          uint64_t>>>;
+
+/**
+ * @brief Storage type for values of `T`: the narrowest index type when
+ *        `T` is counted, `T` itself otherwise.
+ */
+template <class T>
+struct compact {
+    using type = T;
+};
+
+template <class T>
+    requires has_enum_count<T>
+struct compact<T> {
+    using type = least_uint_t<enum_count<T>::value>;
+};
+
+template <class T>
+using compact_t = typename compact<T>::type;
+
+/**
+ * @brief Whether `v` lies in the declared range of a counted type (always
+ *        true for uncounted types).
+ */
+template <class T>
+constexpr bool in_declared_range(T v) noexcept {
+    if constexpr (has_enum_count<T>) {
+        return static_cast<uint64_t>(underlying(v)) < enum_count<T>::value;
+    } else {
+        (void)v;
+        return true;
+    }
+}
+
+/**
+ * @brief Composite (state, event) key layout.
+ *
+ * Counted state and event types whose product fits 32 bits use the dense
+ * key `s * EventCount + e` in the narrowest unsigned type; everything
+ * else packs the 32-bit-masked values into a `uint64_t`.
+ */
+template <class State, class Event>
+struct key_layout {
+    static constexpr bool compact = false;
+    using type = uint64_t;
+
+    static constexpr type make(State s, Event e) noexcept {
+        const auto s_val = static_cast<uint64_t>(underlying(s));
+        const auto e_val = static_cast<uint64_t>(underlying(e));
+        return ((s_val & 0xFFFFFFFFULL) << 32) | (e_val & 0xFFFFFFFFULL);
+    }
+};
+
+template <class State, class Event>
+    requires (has_enum_count<State> && has_enum_count<Event>
+              && enum_count<State>::value <= 0x100000000ULL
+              && enum_count<Event>::value <= 0x100000000ULL
+              && enum_count<State>::value * enum_count<Event>::value
+                     <= 0x100000000ULL)
+struct key_layout<State, Event> {
+    static constexpr bool compact = true;
+    using type = least_uint_t<enum_count<State>::value
+                              * enum_count<Event>::value>;
+
+    static constexpr type make(State s, Event e) noexcept {
+        return static_cast<type>(
+            static_cast<uint64_t>(underlying(s)) * enum_count<Event>::value
+            + static_cast<uint64_t>(underlying(e)));
+    }
+};
+
+/**
+ * @brief Fallback ordinal per value of `T`.
+ *
+ * A flat array indexed by value when `T` is counted (and small enough),
+ * so a lookup is one bounds check and one load; a hash map otherwise.
+ */
+template <class T>
+class fallback_slots {
+public:
+    static constexpr uint32_t npos = perfect_hash::npos;
+
+    explicit fallback_slots(std::pmr::memory_resource* mr)
+        : dense_(mr), sparse_(mr) {}
+
+    inline uint32_t get(T v) const noexcept {
+        if constexpr (dense) {
+            const auto i = static_cast<std::size_t>(underlying(v));
+            return i < dense_.size() ? dense_[i] : npos;
+        } else {
+            if (sparse_.empty()) {
+                return npos;
+            }
+            const auto it = sparse_.find(underlying(v));
+            return it == sparse_.end() ? npos : it->second;
+        }
+    }
+
+    inline void set(T v, uint32_t i) {
+        if constexpr (dense) {
+            if (dense_.empty()) {
+                dense_.assign(enum_count<T>::value, npos);
+            }
+            dense_[static_cast<std::size_t>(underlying(v))] = i;
+        } else {
+            sparse_.insert_or_assign(underlying(v), i);
+        }
+    }
+
+    /* Renumber after a layout change: ordinal `i` becomes `to[i]`. */
+    inline void remap(std::span<const uint32_t> to) noexcept {
+        for (uint32_t& i : dense_) {
+            i = i == npos ? npos : to[i];
+        }
+        for (auto& entry : sparse_) {
+            entry.second = to[entry.second];
+        }
+    }
+
+    inline std::size_t memory_usage() const noexcept {
+        return dense_.capacity() * sizeof(uint32_t)
+             + sparse_.size() * (2 * sizeof(void*) + sizeof(uint64_t))
+             + (sparse_.empty() ? 0 : sparse_.bucket_count() * sizeof(void*));
+    }
+
+private:
+    static constexpr bool dense = [] {
+        if constexpr (has_enum_count<T>) {
+            return enum_count<T>::value <= 0x10000;
+        } else {
+            return false;
+        }
+    }();
+
+    std::pmr::vector<uint32_t> dense_;
+    std::pmr::unordered_map<decltype(underlying(std::declval<T>())), uint32_t> sparse_;
+};
+
+} /* namespace detail */
+
+/**
+ * @brief Approximate memory footprint of a machine, in bytes.
+ *
+ * `cold` includes the inline guard/action storage, which is also reported
+ * separately as `callables`.  Hash map figures are estimates of node and
+ * bucket sizes.
+ */
+struct memory_report {
+    std::size_t hot = 0;          /**< Compact records read by dispatch */
+    std::size_t cold = 0;         /**< Full transition records */
+    std::size_t callables = 0;    /**< Part of `cold` holding guards/actions */
+    std::size_t index = 0;        /**< Key index (hash map / perfect hash) */
+    std::size_t per_instance = 0; /**< State held by one machine instance */
+    std::size_t instances = 0;    /**< State held for all instances here */
+
+    /** @brief Bytes of table plus instance state. */
+    inline std::size_t total() const noexcept {
+        return hot + cold + index + instances;
+    }
+};
+
+/*
+ * Forward declaration of helper used by definition::to_dot
+ */
+template<class T>
+std::string to_string(const T& value);
+
+
+/**
+ * @brief Transition table of a finite state machine.
+ *
+ * @tparam State   Enum class (or integral type) identifying states.
+ * @tparam Event   Enum class (or integral type) identifying events.
+ * @tparam Context User‑defined data that is passed to guard/action callables.
+ *
+ * A definition is built with `add_transition`, optionally frozen, and then
+ * only read.  Counted `State`/`Event` types (see `fsm::enum_count`) get a
+ * narrow key and narrow hot destination records.  Dispatching never
+ * modifies the definition, so one definition may back any number of
+ * machines, including machines used from different threads once
+ * construction has finished.
+ */
+template <class State, class Event, class Context = void>
+class definition {
+public:
+    /* ------------------------------------------------------------ */
+    /* Types                                                        */
+    /* ------------------------------------------------------------ */
+    using Guard = typename fsm_types<Context>::Guard;
+    using Action = typename fsm_types<Context>::Action;
+
+    /**
+     * @brief Structure describing a single transition.
+     */
+    struct Transition {
+        State   src;   /**< Source state */
+        Event   ev;    /**< Event triggering the transition */
+        State   dst;   /**< Destination state */
+        Guard   guard; /**< Optional guard, may be empty */
+        Action  action;/**< Optional action, may be empty */
+    };
+
+    /**
+     * @brief Transition taken when a state has been current for too long.
+     *
+     * Timeouts are driven by an `fsm::timing_wheel` attached to the
+     * machine (see `runtime::attach_timers()`); the definition only
+     * records them.
+     */
+    struct Timeout {
+        State    src;    /**< State the timeout is armed on entry to */
+        uint64_t after;  /**< Ticks after entering `src` */
+        State    dst;    /**< Destination state */
+        Action   action; /**< Optional action, may be empty */
+    };
+
+    /**
+     * @brief Result of a dispatch operation (see fsm::result).
+     */
+    using Result = result;
+
+    /**
+     * @brief Composite key type: narrow when State and Event are counted.
+     */
+    using key_type = typename detail::key_layout<State, Event>::type;
+
+    /* ------------------------------------------------------------ */
+    /* Construction                                                 */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Create an empty table.
+     *
+     * Copies of a definition allocate from the default resource.
+     *
+     * @param mr Resource every table allocation is made from; must
+     *           outlive the definition.
+     */
+    explicit definition(
+        std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : hot_(mr), transitions_(mr), index_(mr), hash_(mr), parents_(mr),
+          any_state_(mr), defaults_(mr), timeouts_(mr), timeout_slots_(mr),
+          shadowed_(mr) {}
+
+    /**
+     * @brief Resource the table allocates from.
+     */
+    inline std::pmr::memory_resource* resource() const noexcept {
+        return transitions_.get_allocator().resource();
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Transition management                                        */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Add a transition to the internal table.
+     *
+     * An existing entry for the same `(src, ev)` pair is overwritten.
+     *
+     * @param tr Transition description.
+     * @return `false` if the table is frozen (see `freeze()`) or a value
+     *         lies outside a declared `fsm::enum_count`, `true` otherwise.
+     */
+    inline bool add_transition(const Transition& tr) {
+        return store(tr, on_duplicate::Overwrite) != stored::Rejected;
+    }
+
+    /**
+     * @brief Add every transition of `range` in one pass.
+     *
+     * Equivalent to calling `add_transition()` on each element in order,
+     * except that the table is reserved once up front when the size of
+     * `range` is known, and that keys already present (in the table or
+     * earlier in the batch) are counted, listed and optionally kept
+     * instead of being silently overwritten.
+     *
+     * @param range      Transitions to add.
+     * @param policy     What to do with an entry whose key is present.
+     * @param duplicates If non-null, receives the position within `range`
+     *                   of every duplicate entry, in order.
+     * @return Per-outcome counts; a frozen table rejects every entry.
+     */
+    template <std::ranges::input_range R>
+        requires std::convertible_to<std::ranges::range_reference_t<R>,
+                                     const Transition&>
+    inline bulk_report add_transitions(R&& range,
+                                       on_duplicate policy = on_duplicate::Overwrite,
+                                       std::vector<std::size_t>* duplicates = nullptr) {
+        if constexpr (std::ranges::sized_range<R>) {
+            if (!frozen_) {
+                reserve(transitions_.size() + std::ranges::size(range));
+            }
+        }
+        bulk_report r;
+        std::size_t pos = 0;
+        for (const Transition& tr : range) {
+            switch (store(tr, policy)) {
+            case stored::Added:
+                ++r.added;
+                break;
+            case stored::Duplicate:
+                ++r.duplicates;
+                if (duplicates != nullptr) {
+                    duplicates->push_back(pos);
+                }
+                break;
+            case stored::Rejected:
+                ++r.rejected;
+                break;
+            }
+            ++pos;
+        }
+        return r;
+    }
+
+    /**
+     * @brief Add a braced list of transitions.
+     * @see add_transitions(R&&, on_duplicate, std::vector<std::size_t>*)
+     */
+    inline bulk_report add_transitions(std::initializer_list<Transition> list,
+                                       on_duplicate policy = on_duplicate::Overwrite,
+                                       std::vector<std::size_t>* duplicates = nullptr) {
+        return add_transitions(std::span<const Transition>(list.begin(), list.size()),
+                               policy, duplicates);
+    }
+
+    /**
+     * @brief Make room for `n` transitions in total.
+     *
+     * Avoids reallocating the transition arrays and rehashing the build
+     * index while the table grows to `n` entries.  Ignored once frozen.
+     */
+    inline void reserve(std::size_t n) {
+        if (frozen_) {
+            return;
+        }
+        hot_.reserve(n);
+        transitions_.reserve(n);
+        index_.reserve(n);
+    }
+
+    /**
+     * @brief Add another candidate transition for `(src, ev)`.
+     *
+     * Candidates of one key are stored contiguously and tried in the order
+     * they were added: the first whose guard passes (or that has no guard)
+     * is taken, and `GuardRejected` is returned only when every guard
+     * rejects.  An unguarded candidate therefore acts as the final else
+     * branch; candidates appended after it are unreachable.
+     * `add_transition` on the same key replaces all of them.
+     *
+     * Appending to a key other than the most recently added one shifts the
+     * ordinals of every later transition by one.
+     *
+     * @param tr Transition description.
+     * @return `false` if the table is frozen or a value lies outside a
+     *         declared `fsm::enum_count`, `true` otherwise.
+     */
+    inline bool append_transition(const Transition& tr) {
+        if (frozen_ || !detail::in_declared_range(tr.src)
+            || !detail::in_declared_range(tr.ev)
+            || !detail::in_declared_range(tr.dst)) {
+            return false;
+        }
+        const auto [it, inserted] = index_.try_emplace(
+            key(tr.src, tr.ev), static_cast<uint32_t>(transitions_.size()));
+        if (inserted) {
+            transitions_.push_back(tr);
+            hot_.push_back(hot_entry::of(tr));
+            return true;
+        }
+        const uint32_t end = group_end(it->second);
+        hot_[end - 1].flags |= hot_entry::has_next;
+        if (end < transitions_.size()) {
+            renumber(end, 1);
+        }
+        transitions_.insert(transitions_.begin() + end, tr);
+        hot_.insert(hot_.begin() + end, hot_entry::of(tr));
+        return true;
+    }
+
+    /**
+     * @brief Add a transition taken on `ev` from any state.
+     *
+     * Consulted only when the current state (and its ancestors, see
+     * `set_parent()`) has no exact transition for `ev`.  Adding a second
+     * one for the same event overwrites the first.  The entry appears in
+     * `transitions()` with kind `transition_kind::AnyState`.
+     *
+     * @return `false` if the table is frozen or a value lies outside a
+     *         declared `fsm::enum_count`.
+     */
+    inline bool add_any_state(Event ev, State dst, Guard guard = nullptr,
+                              Action action = nullptr) {
+        if (frozen_ || !detail::in_declared_range(ev)
+            || !detail::in_declared_range(dst)) {
+            return false;
+        }
+        place(any_state_, ev,
+              Transition{ State{}, ev, dst, std::move(guard), std::move(action) },
+              hot_entry::any_state);
+        return true;
+    }
+
+    /**
+     * @brief Add a transition taken from `src` on any unhandled event.
+     *
+     * Lowest priority: used only when neither an exact transition nor an
+     * `add_any_state()` entry matches.  Defaults are per state and are not
+     * inherited through `set_parent()`.  The entry appears in
+     * `transitions()` with kind `transition_kind::Default`.
+     *
+     * @return `false` if the table is frozen or a value lies outside a
+     *         declared `fsm::enum_count`.
+     */
+    inline bool add_default(State src, State dst, Guard guard = nullptr,
+                            Action action = nullptr) {
+        if (frozen_ || !detail::in_declared_range(src)
+            || !detail::in_declared_range(dst)) {
+            return false;
+        }
+        place(defaults_, src,
+              Transition{ src, Event{}, dst, std::move(guard), std::move(action) },
+              hot_entry::any_event);
+        return true;
+    }
+
+    /**
+     * @brief Leave `src` for `dst` once it has been current for `after` ticks.
+     *
+     * The timer is armed whenever a machine with attached timers takes a
+     * transition into `src` (self-transitions re-arm it) and cancelled
+     * when it leaves.  One timeout per state: a second call for `src`
+     * replaces the first.  Timeouts are not inherited through
+     * `set_parent()` and are not part of table images.
+     *
+     * @return `false` if the table is frozen or a value lies outside a
+     *         declared `fsm::enum_count`.
+     */
+    inline bool add_timeout(State src, uint64_t after, State dst,
+                            Action action = nullptr) {
+        if (frozen_ || !detail::in_declared_range(src)
+            || !detail::in_declared_range(dst)) {
+            return false;
+        }
+        Timeout to{ src, after, dst, std::move(action) };
+        const uint32_t i = timeout_slots_.get(src);
+        if (i == perfect_hash::npos) {
+            timeout_slots_.set(src, static_cast<uint32_t>(timeouts_.size()));
+            timeouts_.push_back(std::move(to));
+        } else {
+            timeouts_[i] = std::move(to);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Timeout of `s`, or `nullptr` if it has none.
+     */
+    inline const Timeout* timeout(State s) const noexcept {
+        const uint32_t i = timeout_slots_.get(s);
+        return i == perfect_hash::npos ? nullptr : &timeouts_[i];
+    }
+
+    /**
+     * @brief All timeouts, in the order their states were first given one.
+     */
+    inline std::span<const Timeout> timeouts() const noexcept {
+        return { timeouts_.data(), timeouts_.size() };
+    }
+
+    /**
+     * @brief Exact transitions lost to a later `add_transition()` with the
+     *        same `(src, ev)`, in the order they were overwritten.
+     *
+     * `append_transition()` candidates dropped with the list they belonged
+     * to are not listed separately.
+     */
+    inline std::span<const shadowed_transition<State, Event>> shadowed() const noexcept {
+        return { shadowed_.data(), shadowed_.size() };
+    }
+
+    /**
+     * @brief Nest `child` inside `parent`.
+     *
+     * Events that `child` has no transition for are looked up on `parent`,
+     * then on its parent, and so on; the first ancestor that handles the
+     * event supplies the transition (guard, action and destination).  Only
+     * a missing transition bubbles up: a rejected guard is final.  Setting
+     * a new parent replaces the previous one.
+     *
+     * @param child  Nested state.
+     * @param parent Enclosing state.
+     * @return `false` if the table is frozen, a value lies outside a
+     *         declared `fsm::enum_count`, or the link would form a cycle.
+     */
+    inline bool set_parent(State child, State parent) {
+        if (frozen_ || !detail::in_declared_range(child)
+            || !detail::in_declared_range(parent)) {
+            return false;
+        }
+        for (const State* a = &parent; a != nullptr; a = this->parent(*a)) {
+            if (*a == child) {
+                return false;
+            }
+        }
+        parents_.insert_or_assign(detail::underlying(child), parent);
+        return true;
+    }
+
+    /**
+     * @brief Enclosing state of `s`, or `nullptr` if `s` is top-level.
+     */
+    inline const State* parent(State s) const noexcept {
+        const auto it = parents_.find(detail::underlying(s));
+        return it == parents_.end() ? nullptr : &it->second;
+    }
+
+    /**
+     * @brief Compile the table into its immutable, perfectly hashed form.
+     *
+     * After freezing, lookups go through an `fsm::perfect_hash` over the
+     * contiguous transition array (two loads and one compare, no probing)
+     * and the build-time hash map is released.  `add_transition` is
+     * rejected from then on.  Freezing an already frozen table is a no-op.
+     *
+     * Transitions inherited through `set_parent()` are resolved here: each
+     * nested state gets a key of its own that maps to the nearest
+     * ancestor's transition, so bubbling up costs nothing at dispatch.
+     */
+    inline void freeze() {
+        if (frozen_) {
+            return;
+        }
+        std::vector<uint64_t> keys;
+        std::vector<uint32_t> values;
+        keys.reserve(transitions_.size());
+        values.reserve(transitions_.size());
+        for (uint32_t i = 0; i < transitions_.size(); ++i) {
+            if (keyed(i)) {
+                keys.push_back(key(transitions_[i].src, transitions_[i].ev));
+                values.push_back(i);
+            }
+        }
+        if (!parents_.empty()) {
+            flatten(keys, values);
+        }
+        /* Keys are unique by construction, so build() cannot fail. */
+        hash_.build(keys, values);
+        /* Release the map's nodes back to the resource. */
+        decltype(index_) released(index_.get_allocator());
+        index_.swap(released);
+        frozen_ = true;
+    }
+
+    /**
+     * @brief Reorder the table by profile, then freeze it.
+     * @see optimize_layout(), freeze()
+     */
+    inline void freeze(std::span<const uint64_t> profile) {
+        optimize_layout(profile);
+        freeze();
+    }
+
+    /**
+     * @brief Reorder transitions by observed hotness.
+     *
+     * Transitions are stably sorted by decreasing `hits[ordinal]` (entries
+     * past the end of `hits` count as zero), so the hot edges end up packed
+     * together at the front of the contiguous array and share cache lines,
+     * while cold ones keep their relative order behind them.  Candidates
+     * added with `append_transition()` stay together and in order, ranked
+     * by their summed hits.  Typical input
+     * is `instrumentation_snapshot::hits` or `fsm::edge_counts` of a trace.
+     *
+     * Ordinals change: data indexed by the old `transitions()` order no
+     * longer matches, and pointers from `find()` are invalidated.
+     *
+     * @param hits Dispatch count per transition ordinal.
+     * @return `false` if the table is frozen (it is left unchanged).
+     */
+    inline bool optimize_layout(std::span<const uint64_t> hits) {
+        if (frozen_) {
+            return false;
+        }
+        auto hit = [&hits](uint32_t i) -> uint64_t {
+            return i < hits.size() ? hits[i] : 0;
+        };
+        /* Candidates of one key move as a unit, ranked by their total. */
+        std::vector<uint32_t> groups;
+        std::vector<uint64_t> heat(transitions_.size(), 0);
+        for (uint32_t i = 0; i < transitions_.size(); ++i) {
+            if (leads(i)) {
+                groups.push_back(i);
+            }
+            heat[groups.back()] += hit(i);
+        }
+        std::stable_sort(groups.begin(), groups.end(),
+                         [&heat](uint32_t a, uint32_t b) {
+                             return heat[a] > heat[b];
+                         });
+        std::vector<uint32_t> order;
+        order.reserve(transitions_.size());
+        for (uint32_t g : groups) {
+            const uint32_t end = group_end(g);
+            for (uint32_t i = g; i < end; ++i) {
+                order.push_back(i);
+            }
+        }
+        std::pmr::vector<Transition> sorted(resource());
+        std::pmr::vector<hot_entry> hot(resource());
+        std::vector<uint32_t> renumbered(order.size());
+        sorted.reserve(transitions_.size());
+        hot.reserve(transitions_.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            const Transition& tr = transitions_[order[i]];
+            sorted.push_back(tr);
+            hot.push_back(hot_[order[i]]);
+            renumbered[order[i]] = static_cast<uint32_t>(i);
+            if (keyed(order[i])) {
+                index_[key(tr.src, tr.ev)] = static_cast<uint32_t>(i);
+            }
+        }
+        any_state_.remap(renumbered);
+        defaults_.remap(renumbered);
+        transitions_ = std::move(sorted);
+        hot_ = std::move(hot);
+        return true;
+    }
+
+    /**
+     * @brief Whether `freeze()` has been called.
+     */
+    inline bool frozen() const noexcept { return frozen_; }
+
+    /**
+     * @brief Perfect hash from keys to ordinals; empty until `freeze()`.
+     *
+     * Includes the keys that nested states inherit (see `set_parent()`).
+     */
+    inline const perfect_hash& frozen_index() const noexcept { return hash_; }
+
+    /**
+     * @brief Number of transitions in the table.
+     */
+    inline std::size_t size() const noexcept { return transitions_.size(); }
+
+    /**
+     * @brief All transitions, in insertion order.
+     */
+    inline std::span<const Transition> transitions() const noexcept {
+        return transitions_;
+    }
+
+    /**
+     * @brief All candidates for `(s, e)` in evaluation order (see
+     *        `append_transition()`), or an empty span.
+     */
+    inline std::span<const Transition> candidates(State s, Event e) const noexcept {
+        return candidates(ordinal(s, e));
+    }
+
+    /**
+     * @brief Candidates starting at ordinal `first`, as returned by
+     *        `ordinal()`; empty for `perfect_hash::npos`.
+     */
+    inline std::span<const Transition> candidates(uint32_t first) const noexcept {
+        if (first == perfect_hash::npos) {
+            return {};
+        }
+        return std::span<const Transition>(transitions_)
+            .subspan(first, group_end(first) - first);
+    }
+
+    /**
+     * @brief How the transition with ordinal `i` matches.
+     */
+    inline transition_kind kind(uint32_t i) const noexcept {
+        const uint8_t f = hot_[i].flags;
+        return (f & hot_entry::any_state) ? transition_kind::AnyState
+             : (f & hot_entry::any_event) ? transition_kind::Default
+             : transition_kind::Exact;
+    }
+
+    /**
+     * @brief Look up the transition for `(s, e)`.
+     *
+     * Matches are tried in a fixed order: the exact `(s, e)` entry, one
+     * inherited through `set_parent()` (whose `src` is that ancestor), the
+     * `add_any_state()` entry for `e`, then the `add_default()` entry
+     * for `s`.
+     *
+     * @return Pointer to the transition, or `nullptr` if none exists.  The
+     *         pointer stays valid until the next `add_transition`.
+     */
+    inline const Transition* find(State s, Event e) const noexcept {
+        const uint32_t i = ordinal(s, e);
+        return i == perfect_hash::npos ? nullptr : &transitions_[i];
+    }
+
+    /**
+     * @brief Ordinal (index in `transitions()`) of the transition for
+     *        `(s, e)`, or `perfect_hash::npos` if none exists.
+     */
+    inline uint32_t ordinal(State s, Event e) const noexcept {
+        if constexpr (detail::key_layout<State, Event>::compact) {
+            /* Out-of-range values would alias another dense key. */
+            if (!detail::in_declared_range(s) || !detail::in_declared_range(e)) {
+                return perfect_hash::npos;
+            }
+        }
+        const key_type k = key(s, e);
+        uint32_t i;
+        if (frozen_) {
+            i = hash_.find(k);
+        } else {
+            const auto it = index_.find(k);
+            i = it != index_.end() ? it->second
+              : parents_.empty()  ? perfect_hash::npos
+                                  : inherited(s, e);
+        }
+        if (i != perfect_hash::npos) [[likely]] {
+            return i;
+        }
+        /* A miss costs two extra loads per fallback table. */
+        i = any_state_.get(e);
+        return i != perfect_hash::npos ? i : defaults_.get(s);
+    }
+
+    /**
+     * @brief Approximate bytes used by the table (no per-instance state).
+     */
+    inline memory_report memory_usage() const noexcept {
+        memory_report r;
+        r.hot = hot_.capacity() * sizeof(hot_entry);
+        r.cold = transitions_.capacity() * sizeof(Transition);
+        r.callables = transitions_.size() * (sizeof(Guard) + sizeof(Action));
+        if (frozen_) {
+            r.index = hash_.memory_usage();
+        } else {
+            /* One singly linked node per entry plus the bucket array. */
+            constexpr std::size_t node =
+                (sizeof(void*) + sizeof(std::pair<const key_type, uint32_t>)
+                 + alignof(void*) - 1) / alignof(void*) * alignof(void*);
+            r.index = index_.size() * node
+                    + index_.bucket_count() * sizeof(void*);
+        }
+        r.index += any_state_.memory_usage() + defaults_.memory_usage()
+                 + timeout_slots_.memory_usage();
+        r.cold += timeouts_.capacity() * sizeof(Timeout)
+                + shadowed_.capacity() * sizeof(shadowed_transition<State, Event>);
+        if (!parents_.empty()) {
+            r.index += parents_.size() * (2 * sizeof(void*) + sizeof(State))
+                     + parents_.bucket_count() * sizeof(void*);
+        }
+        return r;
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Dispatch                                                     */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Dispatch an event on behalf of a machine whose current state
+     *        is held by the caller.
+     *
+     * @param state Current state; updated on success.
+     * @param ev    Event to dispatch.
+     * @param ctx   Context passed to guard/action callables.
+     * @return Result indicating success or failure reason.
+     */
+    template <typename C = Context>
+    inline Result dispatch(State& state, Event ev, C& ctx) const
+        requires (!std::is_void_v<C>) {
+        return step(state, ev, ctx);
+    }
+
+    inline Result dispatch(State& state, Event ev) const
+        requires (std::is_void_v<Context>) {
+        return step(state, ev);
+    }
+
+    /**
+     * @brief Dispatch a batch of events in one call.
+     *
+     * The state is kept in a local for the whole batch and written back
+     * once.  When `out` is non-empty, `out[i]` receives the result of
+     * `evs[i]` and only the first `min(evs.size(), out.size())` events are
+     * processed.
+     *
+     * @param state           Current state; updated as events succeed.
+     * @param evs             Events to dispatch, in order.
+     * @param ctx             Context passed to guard/action callables.
+     * @param out             Per-event results, or empty.
+     * @param stop_at_failure Stop after the first result other than `Ok`.
+     * @return Number of events consumed, including a failing event that
+     *         stopped the batch.
+     */
+    template <typename C = Context>
+    inline std::size_t dispatch_many(State& state, std::span<const Event> evs,
+                                     C& ctx, std::span<Result> out = {},
+                                     bool stop_at_failure = false) const
+        requires (!std::is_void_v<Context>) {
+        return step_many(state, evs, out, stop_at_failure, ctx);
+    }
+
+    inline std::size_t dispatch_many(State& state, std::span<const Event> evs,
+                                     std::span<Result> out = {},
+                                     bool stop_at_failure = false) const
+        requires (std::is_void_v<Context>) {
+        return step_many(state, evs, out, stop_at_failure);
+    }
+
+    /**
+     * @brief Dispatch an event but leave its action for later.
+     *
+     * Evaluates the guards and commits the new state exactly as
+     * `dispatch()` does, then, instead of running the action, hands it
+     * back as a ticket for `run()`.  Guards see `ctx` as usual; the action
+     * later receives whichever context is passed to `run()`.
+     *
+     * @param state Current state; updated on success.
+     * @param ev    Event to dispatch.
+     * @param ctx   Context passed to guards.
+     * @param t     Receives the pending action; empty when the dispatch
+     *              failed or the transition has no action.
+     * @return Result indicating success or failure reason.
+     */
+    template <typename C = Context>
+    inline Result dispatch_deferred(State& state, Event ev, const C& ctx,
+                                    action_ticket& t) const
+        requires (!std::is_void_v<C>) {
+        return defer(state, ev, t, ctx);
+    }
+
+    inline Result dispatch_deferred(State& state, Event ev,
+                                    action_ticket& t) const
+        requires (std::is_void_v<Context>) {
+        return defer(state, ev, t);
+    }
+
+    /**
+     * @brief Run the action a ticket stands for; empty tickets do nothing.
+     */
+    template <typename C = Context>
+    inline void run(action_ticket t, C& ctx) const requires (!std::is_void_v<C>) {
+        if (t) {
+            run_action(t.ordinal, ctx);
+        }
+    }
+
+    inline void run(action_ticket t) const requires (std::is_void_v<Context>) {
+        if (t) {
+            run_action(t.ordinal);
+        }
+    }
+
+    /**
+     * @brief Run a batch of tickets in order, skipping empty ones.
+     */
+    template <typename C = Context>
+    inline void run(std::span<const action_ticket> ts, C& ctx) const
+        requires (!std::is_void_v<C>) {
+        for (const action_ticket t : ts) {
+            run(t, ctx);
+        }
+    }
+
+    inline void run(std::span<const action_ticket> ts) const
+        requires (std::is_void_v<Context>) {
+        for (const action_ticket t : ts) {
+            run(t);
+        }
+    }
+
+    /**
+     * @brief First half of `dispatch()`: choose a transition, take none.
+     *
+     * Looks `(state, ev)` up and evaluates the guards of its candidates
+     * exactly as `dispatch()` does, but runs no action and changes no
+     * state.  The caller commits the choice its own way (for example with
+     * a compare-and-swap, see `fsm::atomic_runtime`), then moves to
+     * `target()` and calls `run_action()`.
+     *
+     * @param state Current state.
+     * @param ev    Event to dispatch.
+     * @param r     Set to `Ok` when a transition was chosen, otherwise to
+     *              the reason none was.
+     * @param ctx   Context passed to guards (none when `Context` is void).
+     * @return Ordinal of the chosen transition, or `perfect_hash::npos`.
+     */
+    template <class... C>
+        requires (sizeof...(C) == (std::is_void_v<Context> ? 0 : 1))
+    inline uint32_t resolve(State state, Event ev, Result& r, C&... ctx) const {
+        uint32_t i = ordinal(state, ev);
+        if (i == perfect_hash::npos) {
+            r = Result::NoTransition;
+            return i;
+        }
+        for (;; ++i) {
+            const uint8_t f = hot_[i].flags;
+            /* Cold path: only a guarded candidate touches its Transition. */
+            if ((f & hot_entry::has_guard) && !transitions_[i].guard(ctx...)) {
+                if (f & hot_entry::has_next) {
+                    continue;
+                }
+                r = Result::GuardRejected;
+                return perfect_hash::npos;
+            }
+            r = Result::Ok;
+            return i;
+        }
+    }
+
+    /**
+     * @brief Destination state of the transition with ordinal `i`.
+     */
+    inline State target(uint32_t i) const noexcept {
+        return static_cast<State>(hot_[i].dst);
+    }
+
+    /**
+     * @brief Run the action of the transition with ordinal `i`, if any.
+     */
+    template <class... C>
+        requires (sizeof...(C) == (std::is_void_v<Context> ? 0 : 1))
+    inline void run_action(uint32_t i, C&... ctx) const {
+        if (hot_[i].flags & hot_entry::has_action) {
+            transitions_[i].action(ctx...);
+        }
+    }
+
+    /* ------------------------------------------------------------ */
+    /* DOT graph generation                                         */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Generate a GraphViz DOT representation of the FSM.
+     *
+     * The function requires that `State` and `Event` can be converted to
+     * `std::string` via `std::to_string` or a user‑provided overload.
+     * For enum classes, users can specialise `std::to_string` or provide a
+     * custom formatter.  `add_any_state()` edges start at a `"*"` node
+     * and `add_default()` edges are labelled `*`.  `add_timeout()` edges
+     * are dashed and labelled `after N`.
+     *
+     * @return DOT language string describing states and transitions.
+     * @see write_dot() for large tables.
+     */
+    inline std::string to_dot() const {
+        std::string dot;
+        dot.reserve(32 + 24 * transitions_.size());
+        emit_dot(&dot, dot_options{}, false);
+        return dot;
+    }
+
+    /**
+     * @brief DOT graph with observed edge frequencies.
+     *
+     * Each edge is labelled `event (n)` and drawn with a pen width scaled
+     * to its share of the hottest edge.  Counts are indexed by transition
+     * ordinal (e.g. `instrumentation_snapshot::hits` or
+     * `fsm::edge_counts` of a trace); missing entries count as zero.
+     *
+     * @param counts Dispatch count per transition.
+     * @return DOT language string describing states and transitions.
+     */
+    inline std::string to_dot(std::span<const uint64_t> counts) const {
+        std::string dot;
+        dot.reserve(32 + 40 * transitions_.size());
+        dot_options opt;
+        opt.counts = counts;
+        emit_dot(&dot, opt, true);
+        return dot;
+    }
+
+    /**
+     * @brief Stream the DOT graph into an output iterator.
+     *
+     * Same text as `to_dot()` with default options, written straight into
+     * the sink: each state and event label is formatted once, numbers go
+     * through `std::to_chars`, and no intermediate string is built.  With
+     * `opt.merge_parallel` all events between the same two states share
+     * one edge (`"a, b"`); with `opt.cluster_parents` nested states are
+     * drawn inside a `cluster_<parent>` subgraph.  Label text is escaped.
+     *
+     * @param out Output iterator over `char`.
+     * @param opt Output options (see `fsm::dot_options`).
+     * @return Iterator past the last character written.
+     */
+    template <std::output_iterator<char> OutputIt>
+    inline OutputIt write_dot(OutputIt out, const dot_options& opt = {}) const {
+        return emit_dot(out, opt, !opt.counts.empty());
+    }
+
+    /**
+     * @brief Stream the DOT graph into `os`.
+     * @see write_dot(OutputIt, const dot_options&)
+     */
+    inline void write_dot(std::ostream& os, const dot_options& opt = {}) const {
+        write_dot(std::ostreambuf_iterator<char>(os), opt);
+    }
+
+private:
+    using state_key = decltype(detail::underlying(std::declval<State>()));
+
+    template <class T>
+    static inline const std::string& label(detail::label_cache<T>& cache, T v) {
+        return cache.get(v, [](T x) { return to_string(x); });
+    }
+
+    template <class OutputIt>
+    inline OutputIt emit_dot(OutputIt out, const dot_options& opt,
+                             bool weighted) const {
+        detail::dot_sink<OutputIt> sink(out);
+        detail::label_cache<State> states;
+        detail::label_cache<Event> events;
+        /* Wildcards are drawn as a "*" source node or a "*" label. */
+        const std::string_view star = "*";
+        auto src_of = [&](uint32_t i) -> std::string_view {
+            return kind(i) == transition_kind::AnyState
+                       ? star : std::string_view(label(states, transitions_[i].src));
+        };
+        auto ev_of = [&](uint32_t i) -> std::string_view {
+            return kind(i) == transition_kind::Default
+                       ? star : std::string_view(label(events, transitions_[i].ev));
+        };
+        auto count_of = [&opt](uint32_t i) -> uint64_t {
+            return i < opt.counts.size() ? opt.counts[i] : 0;
+        };
+
+        sink.put("digraph FSM {\n  rankdir=LR;\n");
+        if (opt.cluster_parents && !parents_.empty()) {
+            write_clusters(sink, states);
+        }
+
+        const uint32_t n = static_cast<uint32_t>(transitions_.size());
+        /* Edge groups as singly linked lists of ordinals, in first-seen
+           order. */
+        std::vector<uint32_t> heads;
+        std::vector<uint32_t> next;
+        std::vector<uint64_t> totals;
+        if (opt.merge_parallel) {
+            std::map<std::tuple<bool, uint64_t, uint64_t>, uint32_t> group;
+            std::vector<uint32_t> tails;
+            next.assign(n, perfect_hash::npos);
+            for (uint32_t i = 0; i < n; ++i) {
+                const Transition& tr = transitions_[i];
+                const bool any = kind(i) == transition_kind::AnyState;
+                const auto [it, inserted] = group.try_emplace(
+                    { any, any ? 0 : static_cast<uint64_t>(detail::underlying(tr.src)),
+                      static_cast<uint64_t>(detail::underlying(tr.dst)) },
+                    static_cast<uint32_t>(heads.size()));
+                if (inserted) {
+                    heads.push_back(i);
+                    tails.push_back(i);
+                    totals.push_back(count_of(i));
+                } else {
+                    next[tails[it->second]] = i;
+                    tails[it->second] = i;
+                    totals[it->second] += count_of(i);
+                }
+            }
+        } else {
+            heads.resize(n);
+            for (uint32_t i = 0; i < n; ++i) {
+                heads[i] = i;
+            }
+        }
+
+        uint64_t hottest = 1;
+        if (opt.merge_parallel) {
+            for (uint64_t t : totals) {
+                hottest = t > hottest ? t : hottest;
+            }
+        } else {
+            for (uint64_t c : opt.counts) {
+                hottest = c > hottest ? c : hottest;
+            }
+        }
+
+        for (std::size_t g = 0; g < heads.size(); ++g) {
+            const uint32_t first = heads[g];
+            sink.put("  ");
+            sink.put_quoted(src_of(first));
+            sink.put(" -> ");
+            sink.put_quoted(label(states, transitions_[first].dst));
+            sink.put(" [label=\"");
+            sink.put_escaped(ev_of(first));
+            if (opt.merge_parallel) {
+                for (uint32_t i = next[first]; i != perfect_hash::npos; i = next[i]) {
+                    sink.put(", ");
+                    sink.put_escaped(ev_of(i));
+                }
+            }
+            if (weighted) {
+                const uint64_t c = opt.merge_parallel ? totals[g] : count_of(first);
+                sink.put(" (");
+                sink.put_uint(c);
+                sink.put(")\", penwidth=");
+                sink.put_uint(1 + 4 * c / hottest);
+                sink.put("];\n");
+            } else {
+                sink.put("\"];\n");
+            }
+        }
+        for (const Timeout& to : timeouts_) {
+            sink.put("  ");
+            sink.put_quoted(label(states, to.src));
+            sink.put(" -> ");
+            sink.put_quoted(label(states, to.dst));
+            sink.put(" [label=\"after ");
+            sink.put_uint(to.after);
+            sink.put("\", style=dashed];\n");
+        }
+        sink.put("}\n");
+        return sink.flush();
+    }
+
+    /* One `subgraph cluster_<parent>` per state that has children. */
+    template <class Sink>
+    inline void write_clusters(Sink& sink, detail::label_cache<State>& states) const {
+        std::unordered_map<state_key, std::vector<State>> children;
+        for (const auto& [child, p] : parents_) {
+            children[detail::underlying(p)].push_back(static_cast<State>(child));
+        }
+        auto by_value = [](State a, State b) {
+            return detail::underlying(a) < detail::underlying(b);
+        };
+        std::vector<State> roots;
+        for (auto& [p, list] : children) {
+            std::sort(list.begin(), list.end(), by_value);
+            if (parent(static_cast<State>(p)) == nullptr) {
+                roots.push_back(static_cast<State>(p));
+            }
+        }
+        std::sort(roots.begin(), roots.end(), by_value);
+        for (State r : roots) {
+            write_cluster(sink, states, children, r, 1);
+        }
+    }
+
+    template <class Sink>
+    inline void write_cluster(
+        Sink& sink, detail::label_cache<State>& states,
+        const std::unordered_map<state_key, std::vector<State>>& children,
+        State p, std::size_t depth) const {
+        const std::string& name = label(states, p);
+        sink.indent(depth);
+        sink.put("subgraph \"cluster_");
+        sink.put_escaped(name);
+        sink.put("\" {\n");
+        sink.indent(depth + 1);
+        sink.put("label=");
+        sink.put_quoted(name);
+        sink.put(";\n");
+        sink.indent(depth + 1);
+        sink.put_quoted(name);
+        sink.put(";\n");
+        for (State c : children.at(detail::underlying(p))) {
+            if (children.count(detail::underlying(c)) != 0) {
+                write_cluster(sink, states, children, c, depth + 1);
+            } else {
+                sink.indent(depth + 1);
+                sink.put_quoted(label(states, c));
+                sink.put(";\n");
+            }
+        }
+        sink.indent(depth);
+        sink.put("}\n");
+    }
+
+    /* Build-time bubble-up: the nearest ancestor handling `e`. */
+    inline uint32_t inherited(State s, Event e) const noexcept {
+        for (const State* a = parent(s); a != nullptr; a = parent(*a)) {
+            const auto it = index_.find(key(*a, e));
+            if (it != index_.end()) {
+                return it->second;
+            }
+        }
+        return perfect_hash::npos;
+    }
+
+    /* Append a key for every (nested state, inherited event) pair. */
+    inline void flatten(std::vector<uint64_t>& keys,
+                        std::vector<uint32_t>& values) const {
+        std::unordered_map<state_key, std::vector<uint32_t>> by_src;
+        for (uint32_t i = 0; i < transitions_.size(); ++i) {
+            if (keyed(i)) {
+                by_src[detail::underlying(transitions_[i].src)].push_back(i);
+            }
+        }
+        std::unordered_set<uint64_t> seen(keys.begin(), keys.end());
+        for (const auto& [child, first] : parents_) {
+            const State s = static_cast<State>(child);
+            /* Nearest ancestor first, so it shadows the ones above it. */
+            for (const State* a = &first; a != nullptr; a = parent(*a)) {
+                const auto it = by_src.find(detail::underlying(*a));
+                if (it == by_src.end()) {
+                    continue;
+                }
+                for (uint32_t i : it->second) {
+                    const uint64_t k = key(s, transitions_[i].ev);
+                    if (seen.insert(k).second) {
+                        keys.push_back(k);
+                        values.push_back(i);
+                    }
+                }
+            }
+        }
+    }
+
+    /* Dispatch logic shared by the void and non-void overloads. */
+    template <class... C>
+    inline Result defer(State& state, Event ev, action_ticket& t,
+                        const C&... ctx) const {
+        Result r;
+        const uint32_t i = resolve(state, ev, r, ctx...);
+        t.ordinal = perfect_hash::npos;
+        if (i != perfect_hash::npos) {
+            if (hot_[i].flags & hot_entry::has_action) {
+                t.ordinal = i;
+            }
+            state = target(i);
+        }
+        return r;
+    }
+
+    template <class... C>
+    inline Result step(State& state, Event ev, C&... ctx) const {
+        Result r;
+        const uint32_t i = resolve(state, ev, r, ctx...);
+        if (i != perfect_hash::npos) {
+            run_action(i, ctx...);
+            state = target(i);
+        }
+        return r;
+    }
+
+    template <class... C>
+    inline std::size_t step_many(State& state, std::span<const Event> evs,
+                                 std::span<Result> out, bool stop_at_failure,
+                                 C&... ctx) const {
+        const std::size_t n = out.empty() || out.size() > evs.size()
+                                  ? evs.size() : out.size();
+        State s = state;
+        std::size_t i = 0;
+        while (i < n) {
+            const Result r = step(s, evs[i], ctx...);
+            if (!out.empty()) {
+                out[i] = r;
+            }
+            ++i;
+            if (stop_at_failure && r != Result::Ok) {
+                break;
+            }
+        }
+        state = s;
+        return i;
+    }
+
+    /**
+     * @brief Combine state and event into a composite key for the index.
+     * @param s State value.
+     * @param e Event value.
+     * @return Composite key (see detail::key_layout).
+     */
+    static constexpr key_type key(State s, Event e) noexcept {
+        return detail::key_layout<State, Event>::make(s, e);
+    }
+
+    /* Compact per-transition record read by every dispatch. */
+    struct hot_entry {
+        static constexpr uint8_t has_guard = 1;
+        static constexpr uint8_t has_action = 2;
+        static constexpr uint8_t callables = has_guard | has_action;
+        static constexpr uint8_t any_state = 4; /**< transition_kind::AnyState */
+        static constexpr uint8_t any_event = 8; /**< transition_kind::Default */
+        static constexpr uint8_t has_next = 16; /**< Next ordinal: same key */
+
+        detail::compact_t<State> dst; /**< Destination state */
+        uint8_t flags;                /**< Callable and kind bits */
+
+        static inline hot_entry of(const Transition& tr,
+                                   uint8_t kind = 0) noexcept {
+            return { static_cast<detail::compact_t<State>>(tr.dst),
+                     static_cast<uint8_t>((tr.guard ? has_guard : 0)
+                                          | (tr.action ? has_action : 0)
+                                          | kind) };
+        }
+    };
+
+    /* Whether ordinal `i` starts a candidate list (or stands alone). */
+    inline bool leads(uint32_t i) const noexcept {
+        return i == 0 || !(hot_[i - 1].flags & hot_entry::has_next);
+    }
+
+    /* Whether ordinal `i` owns an exact key in the index. */
+    inline bool keyed(uint32_t i) const noexcept {
+        return leads(i) && kind(i) == transition_kind::Exact;
+    }
+
+    /* One past the last candidate of the list starting at `first`. */
+    inline uint32_t group_end(uint32_t first) const noexcept {
+        while (hot_[first].flags & hot_entry::has_next) {
+            ++first;
+        }
+        return first + 1;
+    }
+
+    /* Shift every ordinal >= `from` by `delta` in the key tables. */
+    inline void renumber(uint32_t from, int64_t delta) {
+        auto moved = [from, delta](uint32_t i) {
+            return i < from ? i : static_cast<uint32_t>(i + delta);
+        };
+        for (auto& entry : index_) {
+            entry.second = moved(entry.second);
+        }
+        std::vector<uint32_t> to(transitions_.size());
+        for (uint32_t i = 0; i < to.size(); ++i) {
+            to[i] = moved(i);
+        }
+        any_state_.remap(to);
+        defaults_.remap(to);
+    }
+
+    /* Drop the (unkeyed) candidates in `[from, to)`. */
+    inline void erase(uint32_t from, uint32_t to) {
+        renumber(to, -static_cast<int64_t>(to - from));
+        transitions_.erase(transitions_.begin() + from, transitions_.begin() + to);
+        hot_.erase(hot_.begin() + from, hot_.begin() + to);
+    }
+
+    enum class stored : uint8_t { Added, Duplicate, Rejected };
+
+    /* Store an exact transition under its key, overwriting or keeping an
+       existing candidate list as `policy` says. */
+    inline stored store(const Transition& tr, on_duplicate policy) {
+        if (frozen_ || !detail::in_declared_range(tr.src)
+            || !detail::in_declared_range(tr.ev)
+            || !detail::in_declared_range(tr.dst)) {
+            return stored::Rejected;
+        }
+        const hot_entry h = hot_entry::of(tr);
+        const auto [it, inserted] = index_.try_emplace(
+            key(tr.src, tr.ev), static_cast<uint32_t>(transitions_.size()));
+        if (inserted) {
+            transitions_.push_back(tr);
+            hot_.push_back(h);
+            return stored::Added;
+        }
+        if (policy == on_duplicate::Keep) {
+            return stored::Duplicate;
+        }
+        /* Replace the whole candidate list with this one entry. */
+        const uint32_t first = it->second;
+        const uint32_t end = group_end(first);
+        shadowed_.push_back({ tr.src, tr.ev, transitions_[first].dst, tr.dst });
+        transitions_[first] = tr;
+        hot_[first] = h;
+        if (end - first > 1) {
+            erase(first + 1, end);
+        }
+        return stored::Duplicate;
+    }
+
+    /* Insert or overwrite the fallback entry for `v`. */
+    template <class T>
+    inline void place(detail::fallback_slots<T>& slots, T v, Transition&& tr,
+                      uint8_t kind) {
+        const hot_entry h = hot_entry::of(tr, kind);
+        uint32_t i = slots.get(v);
+        if (i == perfect_hash::npos) {
+            i = static_cast<uint32_t>(transitions_.size());
+            transitions_.push_back(std::move(tr));
+            hot_.push_back(h);
+            slots.set(v, i);
+        } else {
+            transitions_[i] = std::move(tr);
+            hot_[i] = h;
+        }
+    }
+
+    std::pmr::vector<hot_entry> hot_;             /**< Hot records, by ordinal */
+    std::pmr::vector<Transition> transitions_;    /**< Cold full transitions */
+    std::pmr::unordered_map<key_type, uint32_t> index_; /**< Build-time key index */
+    perfect_hash hash_;                           /**< Frozen key index */
+    std::pmr::unordered_map<state_key, State> parents_; /**< Child -> parent */
+    detail::fallback_slots<Event> any_state_;     /**< Wildcard source, by event */
+    detail::fallback_slots<State> defaults_;      /**< Wildcard event, by state */
+    std::pmr::vector<Timeout> timeouts_;          /**< Timed transitions */
+    detail::fallback_slots<State> timeout_slots_; /**< Timeouts, by state */
+    std::pmr::vector<shadowed_transition<State, Event>> shadowed_; /**< Overwrites */
+    bool frozen_ = false;                         /**< Set by freeze() */
+};
+
+/**
+ * @brief Helper to convert enums or integral types to string.
+ *
+ * Users can specialise this overload for their own enum classes.
+ */
+template <class T>
+inline std::string to_string(const T& value) {
+    if constexpr (std::is_enum_v<T>) {
+        return std::to_string(static_cast<std::underlying_type_t<T>>(value));
+    } else {
+        return std::to_string(value);
+    }
+}
+
+} /* namespace fsm */
+
+#endif /* FSM_DEFINITION_HPP */
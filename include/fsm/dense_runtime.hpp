@@ -0,0 +1,422 @@
+/**
+ * @file dense_runtime.hpp
+ * @brief Runtime FSM backed by a flat `[state][event]` transition array.
+ *
+ * `fsm::dense_runtime` offers the same interface as `fsm::runtime` but
+ * replaces the hash map with a contiguous array indexed directly by the
+ * underlying values of the state and the event.  Lookup is therefore a
+ * single multiply-add and one load, with no hashing and no bucket walk.
+ *
+ * The backend is intended for machines whose states and events have small,
+ * contiguous underlying values in the ranges `[0, StateCount)` and
+ * `[0, EventCount)`.  The array holds `StateCount * EventCount` slots, so
+ * it should only be chosen for modestly sized machines.
+ *
+ * `run()` feeds a whole event buffer through the machine.  For recognisers
+ * (no guard or action anywhere in the table) it walks a compact next-state
+ * array; with AVX2 available and at most 16 states it additionally
+ * processes two halves of the buffer at once, simulating the second half
+ * from every possible start state (`vpshufb` per event) so that the serial
+ * load-to-load dependency of table walking is broken.  Define
+ * `FSM_DISABLE_SIMD` to force the portable path.
+ */
+
+#ifndef FSM_DENSE_RUNTIME_HPP
+#define FSM_DENSE_RUNTIME_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__) && !defined(FSM_DISABLE_SIMD)
+#include <immintrin.h>
+#define FSM_DENSE_RUN_AVX2 1
+#endif
+
+#include <fsm/runtime.hpp>
+
+namespace fsm {
+
+/**
+ * @brief Runtime finite state machine with dense array storage.
+ *
+ * @tparam State      Enum class (or integral type) identifying states.
+ * @tparam Event      Enum class (or integral type) identifying events.
+ * @tparam StateCount Number of states; values must lie in `[0, StateCount)`.
+ * @tparam EventCount Number of events; values must lie in `[0, EventCount)`.
+ * @tparam Context    User-defined data passed to guard/action callables.
+ */
+template <class State, class Event, std::size_t StateCount,
+          std::size_t EventCount, class Context = void>
+class dense_runtime {
+    static_assert(StateCount > 0 && EventCount > 0,
+                  "dense_runtime requires at least one state and one event");
+
+public:
+    /* ------------------------------------------------------------ */
+    /* Types                                                        */
+    /* ------------------------------------------------------------ */
+    using Guard = typename fsm_types<Context>::Guard;
+    using Action = typename fsm_types<Context>::Action;
+    using Transition = typename runtime<State, Event, Context>::Transition;
+    using Result = result;
+
+    /**
+     * @brief Outcome of `run()`: final state and number of events that did
+     *        not produce a transition (`NoTransition` or `GuardRejected`).
+     */
+    struct run_result {
+        State state;            /**< State after the last event */
+        std::size_t rejected;   /**< Events that left the state unchanged */
+    };
+
+    /* ------------------------------------------------------------ */
+    /* Construction                                                 */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Construct the FSM with an initial state.
+     *
+     * The whole `[state][event]` array is allocated up front so that no
+     * allocation happens in `add_transition` or `dispatch`.
+     *
+     * @param start Initial state of the machine.
+     */
+    explicit dense_runtime(State start)
+        : table_(StateCount * EventCount),
+          next_(StateCount * EventCount, miss),
+          current_(start) {
+        if constexpr (StateCount <= 16) {
+            shuffle_.resize(EventCount + 1);
+            missing_.resize(EventCount + 1);
+            for (std::size_t e = 0; e <= EventCount; ++e) {
+                for (std::size_t i = 0; i < 16; ++i) {
+                    shuffle_[e][i] = static_cast<uint8_t>(i);
+                    missing_[e][i] = 1;
+                }
+            }
+        }
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Transition management                                        */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Add a transition to the internal table.
+     *
+     * An existing entry for the same `(src, ev)` pair is overwritten.
+     *
+     * @param tr Transition description.
+     * @return `false` if `src`, `ev` or `dst` lies outside the declared
+     *         ranges (the table is left unchanged), `true` otherwise.
+     */
+    inline bool add_transition(const Transition& tr) {
+        if (!in_range(tr.src, tr.ev) || !state_in_range(tr.dst)) {
+            return false;
+        }
+        const std::size_t cell = index(tr.src, tr.ev);
+        slot& sl = table_[cell];
+        if (sl.used && (sl.tr.guard || sl.tr.action)) {
+            --callables_;
+        }
+        sl.tr = tr;
+        sl.used = true;
+        if (tr.guard || tr.action) {
+            ++callables_;
+        }
+        const auto dst = static_cast<index_type>(detail::underlying(tr.dst));
+        next_[cell] = dst;
+        if constexpr (StateCount <= 16) {
+            const auto s_idx = static_cast<std::size_t>(detail::underlying(tr.src));
+            const auto e_idx = static_cast<std::size_t>(detail::underlying(tr.ev));
+            shuffle_[e_idx][s_idx] = static_cast<uint8_t>(dst);
+            missing_[e_idx][s_idx] = 0;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Dispatch an event.
+     *
+     * @param ev   Event to dispatch.
+     * @param ctx  Context passed to guard/action callables.
+     * @return Result indicating success or failure reason.
+     */
+    template <typename C = Context>
+    inline Result dispatch(Event ev, C& ctx) requires (!std::is_void_v<C>) {
+        const slot* sl = find(ev);
+        if (sl == nullptr) {
+            return Result::NoTransition;
+        }
+        if (sl->tr.guard && !sl->tr.guard(ctx)) {
+            return Result::GuardRejected;
+        }
+        if (sl->tr.action) {
+            sl->tr.action(ctx);
+        }
+        current_ = sl->tr.dst;
+        return Result::Ok;
+    }
+
+    inline Result dispatch(Event ev) requires (std::is_void_v<Context>) {
+        const slot* sl = find(ev);
+        if (sl == nullptr) {
+            return Result::NoTransition;
+        }
+        if (sl->tr.guard && !sl->tr.guard()) {
+            return Result::GuardRejected;
+        }
+        if (sl->tr.action) {
+            sl->tr.action();
+        }
+        current_ = sl->tr.dst;
+        return Result::Ok;
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Stream processing                                            */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Dispatch every event of a buffer, in order.
+     *
+     * Equivalent to calling `dispatch` for each event, but tables without
+     * guards or actions take a dedicated fast path (see file comment).
+     *
+     * @param evs Events to process.
+     * @param ctx Context passed to guard/action callables.
+     * @return Final state (also the new current state) and the number of
+     *         rejected events.
+     */
+    template <typename C = Context>
+    inline run_result run(std::span<const Event> evs, C& ctx)
+        requires (!std::is_void_v<C>) {
+        if (callables_ == 0) {
+            return run_pure(evs);
+        }
+        std::size_t rejected = 0;
+        for (Event ev : evs) {
+            rejected += dispatch(ev, ctx) != Result::Ok;
+        }
+        return { current_, rejected };
+    }
+
+    inline run_result run(std::span<const Event> evs)
+        requires (std::is_void_v<Context>) {
+        if (callables_ == 0) {
+            return run_pure(evs);
+        }
+        std::size_t rejected = 0;
+        for (Event ev : evs) {
+            rejected += dispatch(ev) != Result::Ok;
+        }
+        return { current_, rejected };
+    }
+
+    /**
+     * @brief Retrieve the current active state.
+     * @return Current state value.
+     */
+    inline State current() const noexcept { return current_; }
+
+    /**
+     * @brief Capture the current state.
+     */
+    inline machine_snapshot<State> snapshot() const noexcept {
+        return { current_ };
+    }
+
+    /**
+     * @brief Make `s.state` current without dispatching anything.
+     * @return `false` (and no change) if the state is not in
+     *         `[0, StateCount)`.
+     */
+    inline bool restore(const machine_snapshot<State>& s) noexcept {
+        if (!state_in_range(s.state)) {
+            return false;
+        }
+        current_ = s.state;
+        return true;
+    }
+
+    /**
+     * @brief Approximate bytes used by the arrays and the current state.
+     */
+    inline memory_report memory_usage() const noexcept {
+        memory_report r;
+        r.hot = next_.capacity() * sizeof(index_type)
+              + (shuffle_.capacity() + missing_.capacity())
+                    * sizeof(std::array<uint8_t, 16>);
+        r.cold = table_.capacity() * sizeof(slot);
+        r.callables = table_.size() * (sizeof(Guard) + sizeof(Action));
+        r.per_instance = sizeof(State);
+        r.instances = sizeof(State);
+        return r;
+    }
+
+    /* ------------------------------------------------------------ */
+    /* DOT graph generation                                         */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Generate a GraphViz DOT representation of the FSM.
+     *
+     * Same format as `runtime::to_dot()`; edges are emitted in
+     * `[state][event]` order.
+     *
+     * @return DOT language string describing states and transitions.
+     */
+    inline std::string to_dot() const {
+        std::string dot = "digraph FSM {\n  rankdir=LR;\n";
+        for (const auto& sl : table_) {
+            if (!sl.used) {
+                continue;
+            }
+            dot += "  \"" + to_string(sl.tr.src) + "\" -> \"" +
+                   to_string(sl.tr.dst) + "\" [label=\"" +
+                   to_string(sl.tr.ev) + "\"];\n";
+        }
+        dot += "}\n";
+        return dot;
+    }
+
+private:
+    /**
+     * @brief One cell of the `[state][event]` array.
+     */
+    struct slot {
+        Transition tr{};    /**< Transition stored in this cell */
+        bool       used{};  /**< Whether the cell holds a transition */
+    };
+
+    /** Compact state index; `StateCount` itself marks a missing cell. */
+    using index_type = detail::least_uint_t<StateCount + 1>;
+    static constexpr index_type miss = static_cast<index_type>(StateCount);
+
+    static constexpr bool state_in_range(State s) noexcept {
+        return static_cast<std::uint64_t>(detail::underlying(s)) < StateCount;
+    }
+
+    static constexpr bool in_range(State s, Event e) noexcept {
+        return state_in_range(s)
+            && static_cast<std::uint64_t>(detail::underlying(e)) < EventCount;
+    }
+
+    /**
+     * @brief Row-major index of the `(s, e)` cell; arguments must be in range.
+     */
+    static constexpr std::size_t index(State s, Event e) noexcept {
+        return static_cast<std::size_t>(detail::underlying(s)) * EventCount
+             + static_cast<std::size_t>(detail::underlying(e));
+    }
+
+    inline const slot* find(Event ev) const noexcept {
+        if (!in_range(current_, ev)) [[unlikely]] {
+            return nullptr;
+        }
+        const slot& sl = table_[index(current_, ev)];
+        return sl.used ? &sl : nullptr;
+    }
+
+    /*
+     * Guard/action free stream walk.
+     */
+    inline run_result run_pure(std::span<const Event> evs) noexcept {
+        if (!state_in_range(current_)) {
+            return { current_, evs.size() };
+        }
+        auto s = static_cast<index_type>(detail::underlying(current_));
+        std::size_t rejected = 0;
+        std::span<const Event> rest = evs;
+#if defined(FSM_DENSE_RUN_AVX2)
+        if constexpr (StateCount <= 16) {
+            if (evs.size() >= 64) {
+                const std::size_t half = evs.size() / 2;
+                rejected = run_avx2(evs.data(), half, s);
+                rest = evs.subspan(2 * half);
+            }
+        }
+#endif
+        const index_type* next = next_.data();
+        for (Event ev : rest) {
+            const auto e = static_cast<uint64_t>(detail::underlying(ev));
+            const index_type n = e < EventCount
+                ? next[static_cast<std::size_t>(s) * EventCount + e] : miss;
+            rejected += n == miss;
+            s = n == miss ? s : n;
+        }
+        current_ = static_cast<State>(s);
+        return { current_, rejected };
+    }
+
+#if defined(FSM_DENSE_RUN_AVX2)
+    /*
+     * Speculative multi-start kernel for up to 16 states.  The low 128-bit
+     * lane walks events [0, half) from state identity, the high lane walks
+     * [half, 2 * half) from all 16 start states at once; each byte lane i
+     * tracks "where would I be, and how many rejects, had I started in i".
+     * Both lanes advance with one vpshufb per event, then are stitched
+     * through the real start state.  Updates s, returns rejects.
+     */
+    inline std::size_t run_avx2(const Event* evs, std::size_t half,
+                                index_type& s) const noexcept {
+        const Event* a = evs;
+        const Event* b = evs + half;
+        const auto row = [](Event ev) noexcept {
+            const auto e = static_cast<uint64_t>(detail::underlying(ev));
+            return static_cast<std::size_t>(e < EventCount ? e : EventCount);
+        };
+        __m256i v = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                     12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,
+                                     8, 9, 10, 11, 12, 13, 14, 15);
+        uint64_t counts[32] = {};
+        alignas(32) uint8_t lanes[32];
+        for (std::size_t i = 0; i < half;) {
+            /* Byte counters are flushed before they can overflow. */
+            const std::size_t stop = half - i > 255 ? i + 255 : half;
+            __m256i acc = _mm256_setzero_si256();
+            for (; i < stop; ++i) {
+                const std::size_t ra = row(a[i]);
+                const std::size_t rb = row(b[i]);
+                const __m256i tbl = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(shuffle_[ra].data()))),
+                    _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(shuffle_[rb].data())),
+                    1);
+                const __m256i rej = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(missing_[ra].data()))),
+                    _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(missing_[rb].data())),
+                    1);
+                acc = _mm256_add_epi8(acc, _mm256_shuffle_epi8(rej, v));
+                v = _mm256_shuffle_epi8(tbl, v);
+            }
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+            for (std::size_t k = 0; k < 32; ++k) {
+                counts[k] += lanes[k];
+            }
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+        const std::size_t mid = lanes[s];
+        const std::size_t rejected = counts[s] + counts[16 + mid];
+        s = static_cast<index_type>(lanes[16 + mid]);
+        return rejected;
+    }
+#endif
+
+    std::vector<slot> table_;        /**< Row-major `[state][event]` table */
+    std::vector<index_type> next_;   /**< Row-major next state or `miss` */
+    /** Per-event byte shuffles (next state / miss flag), `StateCount <= 16`
+     *  only; row `EventCount` handles out-of-range events. */
+    std::vector<std::array<uint8_t, 16>> shuffle_;
+    std::vector<std::array<uint8_t, 16>> missing_;
+    std::size_t callables_ = 0;      /**< Cells with a guard or action */
+    State current_;                  /**< Current active state */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_DENSE_RUNTIME_HPP */
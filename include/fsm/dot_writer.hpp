@@ -0,0 +1,165 @@
+/**
+ * @file dot_writer.hpp
+ * @brief Building blocks of the streaming GraphViz writer.
+ *
+ * `definition::write_dot()` emits DOT text straight into an output
+ * iterator (or an `std::ostream`) through `detail::dot_sink`, which
+ * hands it over in blocks from a small stack buffer.  Numbers are
+ * formatted with `std::to_chars` into a stack buffer, and every state and
+ * event label is produced by `to_string` once and then reused from a
+ * `detail::label_cache`, so the only allocations are one string per
+ * distinct label (plus the edge table when parallel edges are merged).
+ */
+
+#ifndef FSM_DOT_WRITER_HPP
+#define FSM_DOT_WRITER_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+namespace fsm {
+
+/**
+ * @brief Options of `definition::write_dot()`.
+ */
+struct dot_options {
+    /**
+     * Dispatch count per transition ordinal (e.g.
+     * `instrumentation_snapshot::hits`).  When non-empty, edges are
+     * labelled `event (n)` and drawn with a pen width scaled to the
+     * hottest edge.
+     */
+    std::span<const uint64_t> counts = {};
+
+    /** Draw one edge per `(src, dst)` pair, listing all of its events. */
+    bool merge_parallel = false;
+
+    /** Draw states nested with `set_parent()` inside their parent's cluster. */
+    bool cluster_parents = false;
+};
+
+namespace detail {
+
+/**
+ * @brief Buffered character sink over an output iterator, or over a
+ *        `std::string*` that is appended to.
+ *
+ * Text is collected in a small stack buffer and handed to the output in
+ * blocks; `flush()` must be called once writing is done.
+ */
+template <class OutputIt>
+class dot_sink {
+public:
+    explicit dot_sink(OutputIt out) noexcept : out_(out) {}
+
+    inline void put(char c) {
+        if (len_ == sizeof(buf_)) {
+            flush();
+        }
+        buf_[len_++] = c;
+    }
+
+    inline void put(std::string_view s) {
+        if (s.size() > sizeof(buf_) - len_) {
+            flush();
+            if (s.size() > sizeof(buf_)) {
+                write(s);
+                return;
+            }
+        }
+        std::copy(s.begin(), s.end(), buf_ + len_);
+        len_ += s.size();
+    }
+
+    /* Hand buffered text to the output; returns the output position. */
+    inline OutputIt flush() {
+        write(std::string_view(buf_, len_));
+        len_ = 0;
+        return out_;
+    }
+
+    inline void put_uint(uint64_t v) {
+        char buf[20];
+        const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+        put(std::string_view(buf, static_cast<std::size_t>(r.ptr - buf)));
+    }
+
+    /* Text for inside a quoted DOT string. */
+    inline void put_escaped(std::string_view s) {
+        if (s.find_first_of("\"\\") == std::string_view::npos) {
+            put(s);
+            return;
+        }
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                put('\\');
+            }
+            put(c);
+        }
+    }
+
+    inline void put_quoted(std::string_view s) {
+        put('"');
+        put_escaped(s);
+        put('"');
+    }
+
+    inline void indent(std::size_t depth) {
+        for (std::size_t i = 0; i < depth; ++i) {
+            put("  ");
+        }
+    }
+
+private:
+    inline void write(std::string_view s) {
+        if constexpr (std::is_same_v<OutputIt, std::string*>) {
+            out_->append(s);
+        } else {
+            out_ = std::copy(s.begin(), s.end(), out_);
+        }
+    }
+
+    OutputIt out_;
+    std::size_t len_ = 0;
+    char buf_[1024];
+};
+
+/**
+ * @brief One formatted label per distinct value of `T`.
+ */
+template <class T>
+class label_cache {
+public:
+    /**
+     * @brief Label of `v`, formatted by `make(v)` on first use only.
+     * @return Reference that stays valid for the cache's lifetime.
+     */
+    template <class Format>
+    inline const std::string& get(T v, Format&& make) {
+        const auto [it, inserted] = labels_.try_emplace(static_cast<key>(v));
+        if (inserted) {
+            it->second = make(v);
+        }
+        return it->second;
+    }
+
+private:
+    using key = typename std::conditional_t<std::is_enum_v<T>,
+                                            std::underlying_type<T>,
+                                            std::type_identity<T>>::type;
+
+    std::unordered_map<key, std::string> labels_;
+};
+
+} /* namespace detail */
+
+} /* namespace fsm */
+
+#endif /* FSM_DOT_WRITER_HPP */
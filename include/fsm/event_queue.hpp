@@ -0,0 +1,157 @@
+/**
+ * @file event_queue.hpp
+ * @brief Bounded lock-free multi-producer / single-consumer event queue.
+ *
+ * `fsm::event_queue` lets ISRs and worker threads hand events to the thread
+ * that owns a machine.  Producers call `post()`, which never blocks, never
+ * allocates and simply fails when the queue is full; the owning thread
+ * calls `drain()` to dispatch everything queued so far, in FIFO order.
+ * Unlike the one-flag-per-event deferred pattern, repeated events are not
+ * coalesced.
+ *
+ * The ring follows D. Vyukov's bounded queue: every cell carries a sequence
+ * number that tells producers and the consumer whether it is free or
+ * published, so the only contended operation is one compare-and-swap on
+ * the producer index.  `post()` is lock-free (a producer may retry when it
+ * loses a race with another producer, but never waits for one); the
+ * consumer side is wait-free.  The consumer role may move between threads
+ * provided the hand-over itself synchronises (as `fsm::executor` does).
+ */
+
+#ifndef FSM_EVENT_QUEUE_HPP
+#define FSM_EVENT_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace fsm {
+
+/**
+ * @brief Bounded lock-free MPSC queue of events.
+ *
+ * @tparam Event    Event type; must be trivially copyable.
+ * @tparam Capacity Number of slots; must be a power of two.
+ */
+template <class Event, std::size_t Capacity>
+class event_queue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "event_queue capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<Event>,
+                  "event_queue requires trivially copyable events");
+    static_assert(std::atomic<std::size_t>::is_always_lock_free,
+                  "event_queue requires lock-free size_t atomics");
+
+public:
+    /** @brief Create an empty queue. */
+    event_queue() noexcept {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    event_queue(const event_queue&) = delete;
+    event_queue& operator=(const event_queue&) = delete;
+
+    /* ------------------------------------------------------------ */
+    /* Producer side (any thread / ISR)                             */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Enqueue an event.
+     * @param ev Event to enqueue.
+     * @return `false` if the queue is full (the event is dropped).
+     */
+    inline bool post(Event ev) noexcept {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell& c = cells_[pos & mask];
+            const std::size_t seq = c.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq)
+                            - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    c.ev = ev;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Consumer side (one thread at a time)                         */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Dequeue the oldest published event.
+     * @param out Receives the event.
+     * @return `false` if no event is available.
+     */
+    inline bool try_pop(Event& out) noexcept {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        cell& c = cells_[head & mask];
+        if (c.seq.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+        out = c.ev;
+        c.seq.store(head + Capacity, std::memory_order_release);
+        head_.store(head + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Dispatch every queued event on a machine, oldest first.
+     *
+     * Events posted while draining are dispatched too if they become
+     * visible before the queue is observed empty.
+     *
+     * @param machine Any machine with `dispatch(Event, Ctx&...)`.
+     * @param ctx     Context forwarded to `dispatch` (omit for void).
+     * @return Number of events dispatched.
+     */
+    template <class Machine, class... Ctx>
+    inline std::size_t drain(Machine& machine, Ctx&... ctx) {
+        std::size_t n = 0;
+        Event ev;
+        while (try_pop(ev)) {
+            machine.dispatch(ev, ctx...);
+            ++n;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Approximate number of queued events; safe from any thread.
+     *
+     * Includes slots claimed by producers that are still being written.
+     */
+    inline std::size_t size_approx() const noexcept {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    /** @brief Number of slots. */
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+private:
+    static constexpr std::size_t mask = Capacity - 1;
+
+    struct cell {
+        std::atomic<std::size_t> seq; /**< Publication sequence number */
+        Event ev;                     /**< Stored event */
+    };
+
+    /* Producer and consumer indices live on separate cache lines. */
+    alignas(64) std::atomic<std::size_t> tail_{0}; /**< Next slot to claim */
+    alignas(64) std::atomic<std::size_t> head_{0}; /**< Next slot to read */
+    alignas(64) cell cells_[Capacity];             /**< Ring storage */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_EVENT_QUEUE_HPP */
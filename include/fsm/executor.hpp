@@ -0,0 +1,301 @@
+/**
+ * @file executor.hpp
+ * @brief Sharded multi-threaded executor for many FSM instances.
+ *
+ * `fsm::executor` owns a set of `fsm::instance`s that share one definition
+ * and spreads them over shards, one per worker thread.  `post(id, ev)`
+ * routes an event to the lock-free `fsm::event_queue` of the shard owning
+ * instance `id`; each worker runs a single-threaded drain loop over its
+ * shard, so `dispatch` itself never takes a lock.
+ *
+ * A shard is processed by whichever thread holds its claim flag.  An idle
+ * worker may claim (steal) another shard whose backlog exceeds a
+ * threshold, so load spreads across cores when shards are imbalanced.
+ * Because every event for an instance goes through the same FIFO queue and
+ * only one thread at a time drains it, per-instance ordering is preserved.
+ *
+ * On Linux worker `i` can be pinned to CPU `i % hardware_concurrency()`.
+ */
+
+#ifndef FSM_EXECUTOR_HPP
+#define FSM_EXECUTOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <fsm/definition.hpp>
+#include <fsm/event_queue.hpp>
+#include <fsm/instance.hpp>
+
+namespace fsm {
+
+namespace detail {
+
+/* Per-instance contexts; empty when Context is void. */
+template <class Context>
+struct context_store {
+    std::vector<Context> items;
+    explicit context_store(std::size_t n) : items(n) {}
+};
+
+template <>
+struct context_store<void> {
+    explicit context_store(std::size_t) {}
+};
+
+} /* namespace detail */
+
+/**
+ * @brief Thread-per-core executor over many instances of one definition.
+ *
+ * @tparam State         Enum class (or integral type) identifying states.
+ * @tparam Event         Event type; must be trivially copyable.
+ * @tparam Context       Per-instance context type, or `void`.
+ * @tparam QueueCapacity Capacity of each shard's queue (power of two).
+ */
+template <class State, class Event, class Context = void,
+          std::size_t QueueCapacity = 4096>
+class executor {
+public:
+    using Definition = definition<State, Event, Context>;
+    using Instance = instance<State, Event, Context>;
+
+    /**
+     * @brief Create the instances and shards (threads are not started).
+     *
+     * @param def       Shared transition table; must outlive the executor.
+     * @param count     Number of instances, identified by `[0, count)`.
+     * @param start     Initial state of every instance.
+     * @param shards    Number of shards / worker threads (at least one).
+     */
+    executor(const Definition& def, std::size_t count, State start,
+             std::size_t shards = default_shards())
+        : instances_(count, Instance(def, start)),
+          contexts_(count),
+          shard_count_(shards == 0 ? 1 : shards),
+          shards_(std::make_unique<shard[]>(shard_count_)) {}
+
+    executor(const executor&) = delete;
+    executor& operator=(const executor&) = delete;
+
+    /** @brief Stops the workers, dispatching whatever is still queued. */
+    ~executor() { stop(); }
+
+    /* ------------------------------------------------------------ */
+    /* Event delivery                                               */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Queue an event for an instance; callable from any thread.
+     * @return `false` if `id` is not an instance of this executor or the
+     *         owning shard's queue is full.
+     */
+    inline bool post(std::size_t id, Event ev) noexcept {
+        if (id >= instances_.size()) {
+            return false;
+        }
+        return shards_[shard_of(id)].queue.post(message{ id, ev });
+    }
+
+    /** @brief Shard owning instance `id`. */
+    inline std::size_t shard_of(std::size_t id) const noexcept {
+        return id % shard_count_;
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Worker control                                               */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Start one worker thread per shard.
+     * @param pin Pin worker `i` to CPU `i` (Linux only, ignored elsewhere).
+     */
+    inline void start(bool pin = false) {
+        if (running_.exchange(true)) {
+            return;
+        }
+        workers_.reserve(shard_count_);
+        for (std::size_t w = 0; w < shard_count_; ++w) {
+            workers_.emplace_back([this, w] { worker_loop(w); });
+            if (pin) {
+                pin_to_cpu(workers_.back(), w);
+            }
+        }
+    }
+
+    /**
+     * @brief Stop and join the workers, then dispatch any events still
+     *        queued on the calling thread.
+     */
+    inline void stop() {
+        running_.store(false);
+        for (auto& t : workers_) {
+            t.join();
+        }
+        workers_.clear();
+        run_pending();
+    }
+
+    /**
+     * @brief Drain every shard on the calling thread.
+     *
+     * Useful to drive the executor without worker threads; safe to call
+     * concurrently with running workers (busy shards are skipped).
+     *
+     * @return Number of events dispatched.
+     */
+    inline std::size_t run_pending() {
+        std::size_t n = 0;
+        for (std::size_t s = 0; s < shard_count_; ++s) {
+            if (claim(s)) {
+                n += drain(s, static_cast<std::size_t>(-1));
+                release(s);
+            }
+        }
+        return n;
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Observers (only meaningful while workers are stopped)        */
+    /* ------------------------------------------------------------ */
+    /** @brief Number of instances. */
+    inline std::size_t size() const noexcept { return instances_.size(); }
+
+    /** @brief Number of shards. */
+    inline std::size_t shards() const noexcept { return shard_count_; }
+
+    /** @brief Current state of instance `id`. */
+    inline State state(std::size_t id) const noexcept {
+        return instances_[id].current();
+    }
+
+    /** @brief Context of instance `id`. */
+    template <typename C = Context>
+    inline C& context(std::size_t id) noexcept requires (!std::is_void_v<C>) {
+        return contexts_.items[id];
+    }
+
+    /** @brief Total number of events dispatched so far. */
+    inline std::size_t processed() const noexcept {
+        std::size_t n = 0;
+        for (std::size_t s = 0; s < shard_count_; ++s) {
+            n += shards_[s].processed.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    /** @brief Number of shard drains performed by non-owning workers. */
+    inline std::size_t steals() const noexcept {
+        return steals_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct message {
+        std::size_t id; /**< Target instance */
+        Event ev;       /**< Event to dispatch */
+    };
+
+    struct shard {
+        event_queue<message, QueueCapacity> queue;     /**< Inbound events */
+        alignas(64) std::atomic<bool> busy{false};     /**< Claim flag */
+        std::atomic<std::size_t> processed{0};         /**< Statistics */
+    };
+
+    /** Events drained per claim before the shard is offered again. */
+    static constexpr std::size_t batch = 256;
+    /** Backlog above which an idle worker steals a foreign shard. */
+    static constexpr std::size_t steal_threshold = 64;
+
+    static std::size_t default_shards() noexcept {
+        const unsigned n = std::thread::hardware_concurrency();
+        return n == 0 ? 1 : n;
+    }
+
+    static void pin_to_cpu(std::thread& t, std::size_t w) noexcept {
+#if defined(__linux__)
+        const unsigned cpus = std::thread::hardware_concurrency();
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus == 0 ? 0 : w % cpus, &set);
+        pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+        (void)t;
+        (void)w;
+#endif
+    }
+
+    inline bool claim(std::size_t s) noexcept {
+        return !shards_[s].busy.load(std::memory_order_relaxed)
+            && !shards_[s].busy.exchange(true, std::memory_order_acquire);
+    }
+
+    inline void release(std::size_t s) noexcept {
+        shards_[s].busy.store(false, std::memory_order_release);
+    }
+
+    /* Caller holds the claim on shard s. */
+    inline std::size_t drain(std::size_t s, std::size_t limit) {
+        shard& sh = shards_[s];
+        std::size_t n = 0;
+        message m;
+        while (n < limit && sh.queue.try_pop(m)) {
+            if constexpr (std::is_void_v<Context>) {
+                instances_[m.id].dispatch(m.ev);
+            } else {
+                instances_[m.id].dispatch(m.ev, contexts_.items[m.id]);
+            }
+            ++n;
+        }
+        sh.processed.fetch_add(n, std::memory_order_relaxed);
+        return n;
+    }
+
+    inline void worker_loop(std::size_t w) {
+        unsigned idle = 0;
+        while (running_.load(std::memory_order_relaxed)) {
+            std::size_t done = 0;
+            if (claim(w)) {
+                done = drain(w, batch);
+                release(w);
+            }
+            if (done == 0) {
+                for (std::size_t k = 1; k < shard_count_; ++k) {
+                    const std::size_t s = (w + k) % shard_count_;
+                    if (shards_[s].queue.size_approx() < steal_threshold
+                        || !claim(s)) {
+                        continue;
+                    }
+                    done = drain(s, batch);
+                    release(s);
+                    if (done != 0) {
+                        steals_.fetch_add(1, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+            }
+            idle = done == 0 ? idle + 1 : 0;
+            if (idle > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    std::vector<Instance> instances_;          /**< All instances */
+    detail::context_store<Context> contexts_;  /**< Per-instance contexts */
+    std::size_t shard_count_;                  /**< Number of shards */
+    std::unique_ptr<shard[]> shards_;          /**< Shard queues & flags */
+    std::vector<std::thread> workers_;         /**< Worker threads */
+    std::atomic<bool> running_{false};         /**< Workers should run */
+    std::atomic<std::size_t> steals_{0};       /**< Foreign drains */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_EXECUTOR_HPP */
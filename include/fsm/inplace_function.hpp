@@ -0,0 +1,123 @@
+/**
+ * @file inplace_function.hpp
+ * @brief Fixed-capacity, non-allocating callable wrapper.
+ *
+ * `fsm::inplace_function<R(Args...), Capacity>` stores a callable inside a
+ * small inline buffer instead of on the heap.  It only accepts callables
+ * that are trivially copyable and trivially destructible (function
+ * pointers, capture-less lambdas and lambdas capturing pointers, references
+ * or other trivial values), which makes the wrapper itself trivially
+ * copyable: it can be relocated with `memcpy` and never runs a destructor.
+ *
+ * Construction from an oversized or non-trivial callable is a compile-time
+ * error rather than a silent heap allocation.
+ */
+
+#ifndef FSM_INPLACE_FUNCTION_HPP
+#define FSM_INPLACE_FUNCTION_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Default inline capacity, in bytes, of `fsm::inplace_function`.
+ *
+ * Two pointers' worth keeps a `runtime::Transition` for 32-bit states and
+ * events at 64 bytes (one cache line).  Define before including any fsm
+ * header to enlarge it.
+ */
+#ifndef FSM_INPLACE_FUNCTION_CAPACITY
+#define FSM_INPLACE_FUNCTION_CAPACITY (2 * sizeof(void *))
+#endif
+
+namespace fsm {
+
+template <class Signature,
+          std::size_t Capacity = FSM_INPLACE_FUNCTION_CAPACITY>
+class inplace_function;
+
+/**
+ * @brief Non-allocating callable wrapper with inline storage.
+ *
+ * @tparam R        Return type.
+ * @tparam Args     Argument types.
+ * @tparam Capacity Size of the inline buffer in bytes.
+ */
+template <class R, class... Args, std::size_t Capacity>
+class inplace_function<R(Args...), Capacity> {
+public:
+    /** @brief Construct an empty wrapper. */
+    constexpr inplace_function() noexcept = default;
+
+    /** @brief Construct an empty wrapper from `nullptr`. */
+    constexpr inplace_function(std::nullptr_t) noexcept {}
+
+    /**
+     * @brief Construct from a function pointer; a null pointer yields an
+     *        empty wrapper.
+     */
+    inplace_function(R (*fn)(Args...)) noexcept {
+        if (fn != nullptr) {
+            emplace(fn);
+        }
+    }
+
+    /**
+     * @brief Construct from any trivially copyable callable object.
+     * @param f Callable; must fit in `Capacity` bytes.
+     */
+    template <class F>
+        requires (!std::is_same_v<std::decay_t<F>, inplace_function>
+                  && !std::is_pointer_v<std::decay_t<F>>
+                  && !std::is_null_pointer_v<std::decay_t<F>>
+                  && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+    inplace_function(F&& f) noexcept {
+        emplace(std::forward<F>(f));
+    }
+
+    /**
+     * @brief Invoke the stored callable.
+     *
+     * The wrapper must not be empty; unlike `std::function` no exception
+     * is thrown, calling an empty wrapper is undefined behaviour.
+     */
+    R operator()(Args... args) const {
+        return invoke_(storage_, std::forward<Args>(args)...);
+    }
+
+    /** @brief Whether a callable is stored. */
+    explicit operator bool() const noexcept { return invoke_ != nullptr; }
+
+    friend bool operator==(const inplace_function& f, std::nullptr_t) noexcept {
+        return !f;
+    }
+
+private:
+    template <class F>
+    void emplace(F&& f) noexcept {
+        using Fn = std::decay_t<F>;
+        static_assert(sizeof(Fn) <= Capacity,
+                      "callable does not fit in inplace_function storage; "
+                      "capture less or raise FSM_INPLACE_FUNCTION_CAPACITY");
+        static_assert(alignof(Fn) <= alignof(void *),
+                      "callable is over-aligned for inplace_function");
+        static_assert(std::is_trivially_copyable_v<Fn>
+                          && std::is_trivially_destructible_v<Fn>,
+                      "inplace_function only stores trivially copyable "
+                      "callables; capture by pointer or reference instead");
+        ::new (static_cast<void *>(storage_)) Fn(std::forward<F>(f));
+        invoke_ = [](void *p, Args... args) -> R {
+            return (*std::launder(static_cast<Fn *>(p)))(
+                std::forward<Args>(args)...);
+        };
+    }
+
+    R (*invoke_)(void *, Args...) = nullptr;      /**< Type-erased call */
+    alignas(void *) mutable unsigned char storage_[Capacity]{}; /**< Callable */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_INPLACE_FUNCTION_HPP */
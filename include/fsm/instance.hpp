@@ -0,0 +1,143 @@
+/**
+ * @file instance.hpp
+ * @brief Lightweight FSM handle over a shared `fsm::definition`.
+ *
+ * An `fsm::instance` stores only a pointer to its definition and its own
+ * current state, so millions of machines sharing one transition table cost
+ * a few bytes each instead of a full copy of the table.  The definition
+ * must outlive every instance that refers to it and must not be modified
+ * while instances are dispatching.
+ */
+
+#ifndef FSM_INSTANCE_HPP
+#define FSM_INSTANCE_HPP
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include <fsm/definition.hpp>
+
+namespace fsm {
+
+/**
+ * @brief Finite state machine instance referencing a shared definition.
+ *
+ * @tparam State   Enum class (or integral type) identifying states.
+ * @tparam Event   Enum class (or integral type) identifying events.
+ * @tparam Context User‑defined data that is passed to guard/action callables.
+ */
+template <class State, class Event, class Context = void>
+class instance {
+public:
+    using Definition = definition<State, Event, Context>;
+    using Transition = typename Definition::Transition;
+    using Result = result;
+
+    /**
+     * @brief Bind an instance to a definition.
+     * @param def   Shared transition table; must outlive the instance.
+     * @param start Initial state of the machine.
+     */
+    instance(const Definition& def, State start) noexcept
+        : def_(&def), current_(start) {}
+
+    /**
+     * @brief Dispatch an event.
+     *
+     * @param ev   Event to dispatch.
+     * @param ctx  Context passed to guard/action callables.
+     * @return Result indicating success or failure reason.
+     */
+    template <typename C = Context>
+    inline Result dispatch(Event ev, C& ctx) requires (!std::is_void_v<C>) {
+        return def_->dispatch(current_, ev, ctx);
+    }
+
+    inline Result dispatch(Event ev) requires (std::is_void_v<Context>) {
+        return def_->dispatch(current_, ev);
+    }
+
+    /**
+     * @brief Dispatch an event and return its action as a ticket.
+     * @see definition::dispatch_deferred()
+     */
+    template <typename C = Context>
+    inline Result dispatch_deferred(Event ev, const C& ctx, action_ticket& t)
+        requires (!std::is_void_v<C>) {
+        return def_->dispatch_deferred(current_, ev, ctx, t);
+    }
+
+    inline Result dispatch_deferred(Event ev, action_ticket& t)
+        requires (std::is_void_v<Context>) {
+        return def_->dispatch_deferred(current_, ev, t);
+    }
+
+    /**
+     * @brief Dispatch a batch of events in one call.
+     * @see definition::dispatch_many()
+     */
+    template <typename C = Context>
+    inline std::size_t dispatch_many(std::span<const Event> evs, C& ctx,
+                                     std::span<Result> out = {},
+                                     bool stop_at_failure = false)
+        requires (!std::is_void_v<Context>) {
+        return def_->dispatch_many(current_, evs, ctx, out, stop_at_failure);
+    }
+
+    inline std::size_t dispatch_many(std::span<const Event> evs,
+                                     std::span<Result> out = {},
+                                     bool stop_at_failure = false)
+        requires (std::is_void_v<Context>) {
+        return def_->dispatch_many(current_, evs, out, stop_at_failure);
+    }
+
+    /**
+     * @brief Retrieve the current active state.
+     * @return Current state value.
+     */
+    inline State current() const noexcept { return current_; }
+
+    /**
+     * @brief Capture the current state.
+     */
+    inline machine_snapshot<State> snapshot() const noexcept {
+        return { current_ };
+    }
+
+    /**
+     * @brief Make `s.state` current without dispatching anything.
+     * @return `false` (and no change) if the state lies outside a declared
+     *         `fsm::enum_count`.
+     */
+    inline bool restore(const machine_snapshot<State>& s) noexcept {
+        if (!detail::in_declared_range(s.state)) {
+            return false;
+        }
+        current_ = s.state;
+        return true;
+    }
+
+    /**
+     * @brief Access the shared transition table.
+     */
+    inline const Definition& table() const noexcept { return *def_; }
+
+    /**
+     * @brief Approximate bytes of the shared table plus this handle.
+     */
+    inline memory_report memory_usage() const noexcept {
+        memory_report r = def_->memory_usage();
+        r.per_instance = sizeof(instance);
+        r.instances = sizeof(instance);
+        return r;
+    }
+
+private:
+    const Definition* def_; /**< Shared transition table */
+    State current_;         /**< Current active state */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_INSTANCE_HPP */
@@ -0,0 +1,257 @@
+/**
+ * @file instrumentation.hpp
+ * @brief Opt-in dispatch instrumentation policies for `fsm::runtime`.
+ *
+ * `fsm::runtime` takes an instrumentation policy as its last template
+ * parameter.  The default, `fsm::no_instrumentation`, is an empty type
+ * whose `enabled` flag is `false`: the runtime then dispatches straight
+ * through the definition, stores nothing extra and calls no hook, so the
+ * policy can be left in every build at no cost.
+ *
+ * An enabled policy receives, for every dispatch, the ordinal of the
+ * matching transition (its index in `definition::transitions()`, or
+ * `fsm::no_transition` on a miss), the source state, event, destination
+ * state and result.  When its `timing` flag is set the runtime also
+ * measures guard and action durations in cycles and reports them
+ * separately.  The hook interface is:
+ *
+ * @code
+ * struct my_policy {
+ *     static constexpr bool enabled = true;
+ *     static constexpr bool timing  = false;
+ *     void resize(std::size_t transitions);
+ *     template <class State, class Event>
+ *     void on_dispatch(std::size_t ordinal, State src, Event ev,
+ *                      State dst, fsm::result r) noexcept;
+ *     // Only called (and only required) when timing is true:
+ *     void on_guard(std::size_t ordinal, uint64_t cycles) noexcept;
+ *     void on_action(std::size_t ordinal, uint64_t cycles) noexcept;
+ * };
+ * @endcode
+ *
+ * `fsm::counting_instrumentation` implements it with relaxed atomic
+ * counters (and optionally log2 cycle histograms) that can be read from
+ * any thread through `snapshot()` while the owning thread dispatches.
+ */
+
+#ifndef FSM_INSTRUMENTATION_HPP
+#define FSM_INSTRUMENTATION_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <fsm/definition.hpp>
+
+namespace fsm {
+
+/** @brief Ordinal reported for dispatches that found no transition. */
+inline constexpr std::size_t no_transition = static_cast<std::size_t>(-1);
+
+/**
+ * @brief Default policy: no instrumentation, no storage, no hooks.
+ */
+struct no_instrumentation {
+    static constexpr bool enabled = false;
+    static constexpr bool timing = false;
+};
+
+namespace detail {
+
+/**
+ * @brief Cheap monotonic timestamp: the TSC on x86, nanoseconds elsewhere.
+ */
+inline uint64_t cycle_count() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/* Relaxed atomic counter that vectors can copy while resizing. */
+struct relaxed_counter {
+    std::atomic<uint64_t> value{0};
+
+    relaxed_counter() noexcept = default;
+    relaxed_counter(const relaxed_counter& o) noexcept
+        : value(o.load()) {}
+
+    inline void add(uint64_t n = 1) noexcept {
+        value.fetch_add(n, std::memory_order_relaxed);
+    }
+    inline uint64_t load() const noexcept {
+        return value.load(std::memory_order_relaxed);
+    }
+    inline void reset() noexcept {
+        value.store(0, std::memory_order_relaxed);
+    }
+};
+
+} /* namespace detail */
+
+/** @brief Number of log2 buckets in a cycle histogram. */
+inline constexpr std::size_t histogram_buckets = 32;
+
+/**
+ * @brief Cycle histogram: bucket `i` counts samples in `[2^(i-1), 2^i)`
+ *        (bucket 0 counts zero-cycle samples, the last one everything
+ *        above).
+ */
+using cycle_histogram = std::array<uint64_t, histogram_buckets>;
+
+/**
+ * @brief Point-in-time copy of the counters of a
+ *        `counting_instrumentation`.
+ */
+struct instrumentation_snapshot {
+    std::vector<uint64_t> hits;     /**< Successful dispatches per transition */
+    std::vector<uint64_t> rejected; /**< Guard rejections per transition */
+    std::array<uint64_t, 3> results{}; /**< Dispatches per `fsm::result` */
+    std::vector<cycle_histogram> guard_cycles;  /**< Per transition, if timed */
+    std::vector<cycle_histogram> action_cycles; /**< Per transition, if timed */
+
+    /** @brief Number of dispatches that returned `r`. */
+    inline uint64_t count(result r) const noexcept {
+        return results[static_cast<std::size_t>(r)];
+    }
+};
+
+/**
+ * @brief Per-transition and per-result counters, optionally with guard
+ *        and action cycle histograms.
+ *
+ * Counters are relaxed atomics: the dispatching thread pays one
+ * uncontended `fetch_add` per counter, and any other thread may take a
+ * `snapshot()` or `reset()` concurrently.  `resize` is only called while
+ * transitions are being added and must not race with either.
+ *
+ * @tparam Timing Also record guard/action durations (two timestamp reads
+ *                around each callable).
+ */
+template <bool Timing = false>
+class counting_instrumentation {
+public:
+    static constexpr bool enabled = true;
+    static constexpr bool timing = Timing;
+
+    /* ------------------------------------------------------------ */
+    /* Hooks (called by the runtime)                                */
+    /* ------------------------------------------------------------ */
+    /** @brief Make room for counters of `transitions` transitions. */
+    inline void resize(std::size_t transitions) {
+        if (transitions <= per_transition_.size()) {
+            return;
+        }
+        per_transition_.resize(transitions);
+        if constexpr (Timing) {
+            guard_cycles_.resize(transitions);
+            action_cycles_.resize(transitions);
+        }
+    }
+
+    template <class State, class Event>
+    inline void on_dispatch(std::size_t ordinal, State, Event, State,
+                            result r) noexcept {
+        results_[static_cast<std::size_t>(r)].add();
+        if (ordinal < per_transition_.size()) {
+            if (r == result::Ok) {
+                per_transition_[ordinal].hits.add();
+            } else {
+                per_transition_[ordinal].rejected.add();
+            }
+        }
+    }
+
+    inline void on_guard(std::size_t ordinal, uint64_t cycles) noexcept {
+        if (ordinal < guard_cycles_.size()) {
+            guard_cycles_[ordinal][bucket(cycles)].add();
+        }
+    }
+
+    inline void on_action(std::size_t ordinal, uint64_t cycles) noexcept {
+        if (ordinal < action_cycles_.size()) {
+            action_cycles_[ordinal][bucket(cycles)].add();
+        }
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Read-out                                                     */
+    /* ------------------------------------------------------------ */
+    /** @brief Copy every counter; safe while another thread dispatches. */
+    inline instrumentation_snapshot snapshot() const {
+        instrumentation_snapshot s;
+        s.hits.reserve(per_transition_.size());
+        s.rejected.reserve(per_transition_.size());
+        for (const auto& c : per_transition_) {
+            s.hits.push_back(c.hits.load());
+            s.rejected.push_back(c.rejected.load());
+        }
+        for (std::size_t r = 0; r < results_.size(); ++r) {
+            s.results[r] = results_[r].load();
+        }
+        copy_histograms(guard_cycles_, s.guard_cycles);
+        copy_histograms(action_cycles_, s.action_cycles);
+        return s;
+    }
+
+    /** @brief Zero every counter. */
+    inline void reset() noexcept {
+        for (auto& c : per_transition_) {
+            c.hits.reset();
+            c.rejected.reset();
+        }
+        for (auto& c : results_) {
+            c.reset();
+        }
+        for (auto* hs : { &guard_cycles_, &action_cycles_ }) {
+            for (auto& h : *hs) {
+                for (auto& b : h) {
+                    b.reset();
+                }
+            }
+        }
+    }
+
+    /** @brief Histogram bucket of a cycle count. */
+    static constexpr std::size_t bucket(uint64_t cycles) noexcept {
+        const auto b = static_cast<std::size_t>(std::bit_width(cycles));
+        return b < histogram_buckets ? b : histogram_buckets - 1;
+    }
+
+private:
+    using histogram = std::array<detail::relaxed_counter, histogram_buckets>;
+
+    struct transition_counters {
+        detail::relaxed_counter hits;     /**< Result::Ok */
+        detail::relaxed_counter rejected; /**< Result::GuardRejected */
+    };
+
+    static inline void copy_histograms(const std::vector<histogram>& from,
+                                       std::vector<cycle_histogram>& to) {
+        to.resize(from.size());
+        for (std::size_t t = 0; t < from.size(); ++t) {
+            for (std::size_t b = 0; b < histogram_buckets; ++b) {
+                to[t][b] = from[t][b].load();
+            }
+        }
+    }
+
+    std::vector<transition_counters> per_transition_; /**< By ordinal */
+    std::array<detail::relaxed_counter, 3> results_;  /**< By fsm::result */
+    std::vector<histogram> guard_cycles_;             /**< Timing only */
+    std::vector<histogram> action_cycles_;            /**< Timing only */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_INSTRUMENTATION_HPP */
@@ -0,0 +1,252 @@
+/**
+ * @file perfect_hash.hpp
+ * @brief Static perfect hash over 64-bit keys (hash-and-displace).
+ *
+ * `fsm::perfect_hash` maps a fixed set of distinct 64-bit keys to their
+ * positions in the input sequence without collisions.  Keys are first
+ * split into buckets by one hash; each bucket then receives a displacement
+ * seed, chosen at build time, that sends all of its keys to free slots of
+ * a power-of-two table.  A lookup is therefore always exactly two loads
+ * (displacement, slot) and one key compare, with no probing and no rehash.
+ *
+ * The structure is immutable once built; it is used by `runtime::freeze()`.
+ * The final arrays are allocated from a `std::pmr::memory_resource`; the
+ * scratch space of the build itself comes from the default heap, so an
+ * arena only ever receives the table that is kept.
+ */
+
+#ifndef FSM_PERFECT_HASH_HPP
+#define FSM_PERFECT_HASH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace fsm {
+
+/**
+ * @brief Immutable collision-free hash table from 64-bit keys to indices.
+ */
+class perfect_hash {
+public:
+    /** @brief Value returned by `find` for keys not in the set. */
+    static constexpr uint32_t npos = 0xFFFFFFFFu;
+
+    /**
+     * @brief One table slot: the key stored there and its input index.
+     */
+    struct slot {
+        uint64_t key = 0;      /**< Stored key (meaningless when empty) */
+        uint32_t index = npos; /**< Position of the key in the input */
+    };
+
+    /**
+     * @brief Create an empty table.
+     * @param mr Resource the table arrays are allocated from.
+     */
+    explicit perfect_hash(
+        std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : disp_(mr), slots_(mr) {}
+
+    /**
+     * @brief Build the table for a set of distinct keys.
+     * @param keys Keys to index; `find(keys[i]) == i` afterwards.
+     * @return `false` if the keys contain duplicates (table left empty).
+     */
+    inline bool build(std::span<const uint64_t> keys) {
+        disp_.clear();
+        slots_.clear();
+        if (keys.empty()) {
+            return true;
+        }
+        std::vector<uint32_t> disp;
+        std::vector<slot> slots;
+        for (std::size_t slot_bits = log2_ceil(keys.size() + keys.size() / 4);
+             slot_bits < 40; ++slot_bits) {
+            if (try_build(keys, slot_bits, disp, slots)) {
+                disp_.assign(disp.begin(), disp.end());
+                slots_.assign(slots.begin(), slots.end());
+                disp_mask_ = disp_.size() - 1;
+                slot_mask_ = slots_.size() - 1;
+                return true;
+            }
+            if (has_duplicates(keys)) {
+                break;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Build the table with an explicit value per key.
+     * @param keys   Keys to index.
+     * @param values Value stored for each key; `find(keys[i]) == values[i]`
+     *               afterwards.  Must have the same length as `keys`.
+     * @return `false` if the keys contain duplicates (table left empty).
+     */
+    inline bool build(std::span<const uint64_t> keys,
+                      std::span<const uint32_t> values) {
+        if (!build(keys)) {
+            return false;
+        }
+        for (slot& s : slots_) {
+            if (s.index != npos) {
+                s.index = values[s.index];
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Look up a key.
+     * @param k Key to find.
+     * @return Input index of the key, or `npos` if absent.
+     */
+    inline uint32_t find(uint64_t k) const noexcept {
+        if (slots_.empty()) [[unlikely]] {
+            return npos;
+        }
+        const uint64_t h = mix(k);
+        const uint32_t d = disp_[static_cast<std::size_t>(h >> 32) & disp_mask_];
+        const slot& s = slots_[static_cast<std::size_t>(mix(h ^ d)) & slot_mask_];
+        return s.key == k ? s.index : npos;
+    }
+
+    /**
+     * @brief Look up a key in externally stored arrays, e.g. the ones
+     *        saved from `displacements()` and `slots()` into an image.
+     * @param disp  Displacement array (power-of-two length).
+     * @param slots Slot array (power-of-two length).
+     * @param k     Key to find.
+     * @return Stored index of the key, or `npos` if absent.
+     */
+    static inline uint32_t find(std::span<const uint32_t> disp,
+                                std::span<const slot> slots,
+                                uint64_t k) noexcept {
+        if (slots.empty()) [[unlikely]] {
+            return npos;
+        }
+        const uint64_t h = mix(k);
+        const uint32_t d = disp[static_cast<std::size_t>(h >> 32) & (disp.size() - 1)];
+        const slot& s = slots[static_cast<std::size_t>(mix(h ^ d)) & (slots.size() - 1)];
+        return s.key == k ? s.index : npos;
+    }
+
+    /** @brief Displacement array, for serialisation. */
+    inline std::span<const uint32_t> displacements() const noexcept { return disp_; }
+
+    /** @brief Slot array, for serialisation. */
+    inline std::span<const slot> slots() const noexcept { return slots_; }
+
+    /** @brief Number of slots in the table. */
+    inline std::size_t slot_count() const noexcept { return slots_.size(); }
+
+    /** @brief Number of displacement buckets. */
+    inline std::size_t bucket_count() const noexcept { return disp_.size(); }
+
+    /** @brief Bytes held by the displacement and slot arrays. */
+    inline std::size_t memory_usage() const noexcept {
+        return disp_.capacity() * sizeof(uint32_t)
+             + slots_.capacity() * sizeof(slot);
+    }
+
+private:
+    /*
+     * splitmix64 finaliser: cheap and well distributed in all bits.
+     */
+    static constexpr uint64_t mix(uint64_t x) noexcept {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    static constexpr std::size_t log2_ceil(std::size_t n) noexcept {
+        std::size_t bits = 0;
+        while ((std::size_t{1} << bits) < n) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    static bool has_duplicates(std::span<const uint64_t> keys) {
+        std::vector<uint64_t> sorted(keys.begin(), keys.end());
+        std::sort(sorted.begin(), sorted.end());
+        return std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end();
+    }
+
+    static bool try_build(std::span<const uint64_t> keys, std::size_t slot_bits,
+                          std::vector<uint32_t>& disp,
+                          std::vector<slot>& slots) {
+        /* About four keys per bucket keeps the displacement array small. */
+        const std::size_t bucket_bits = log2_ceil((keys.size() + 3) / 4);
+        disp.assign(std::size_t{1} << bucket_bits, 0);
+        slots.assign(std::size_t{1} << slot_bits, slot{});
+        const std::size_t disp_mask = disp.size() - 1;
+        const std::size_t slot_mask = slots.size() - 1;
+
+        std::vector<std::vector<uint32_t>> buckets(disp.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            const uint64_t h = mix(keys[i]);
+            buckets[static_cast<std::size_t>(h >> 32) & disp_mask]
+                .push_back(static_cast<uint32_t>(i));
+        }
+
+        /* Place the largest buckets first, while the table is emptiest. */
+        std::vector<uint32_t> order(buckets.size());
+        for (std::size_t b = 0; b < order.size(); ++b) {
+            order[b] = static_cast<uint32_t>(b);
+        }
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        std::vector<uint8_t> taken(slots.size(), 0);
+        std::vector<std::size_t> placed;
+        for (uint32_t b : order) {
+            const auto& members = buckets[b];
+            if (members.empty()) {
+                break;
+            }
+            bool ok = false;
+            for (uint32_t d = 0; d < (1u << 16) && !ok; ++d) {
+                placed.clear();
+                ok = true;
+                for (uint32_t i : members) {
+                    const std::size_t pos = static_cast<std::size_t>(
+                        mix(mix(keys[i]) ^ d)) & slot_mask;
+                    if (taken[pos]
+                        || std::find(placed.begin(), placed.end(), pos)
+                               != placed.end()) {
+                        ok = false;
+                        break;
+                    }
+                    placed.push_back(pos);
+                }
+                if (ok) {
+                    disp[b] = d;
+                    for (std::size_t j = 0; j < members.size(); ++j) {
+                        taken[placed[j]] = 1;
+                        slots[placed[j]] = slot{ keys[members[j]], members[j] };
+                    }
+                }
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::pmr::vector<uint32_t> disp_; /**< Per-bucket displacement seeds */
+    std::pmr::vector<slot> slots_;    /**< Power-of-two slot table */
+    std::size_t disp_mask_ = 0;       /**< `disp_.size() - 1` */
+    std::size_t slot_mask_ = 0;       /**< `slots_.size() - 1` */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_PERFECT_HASH_HPP */
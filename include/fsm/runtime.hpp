@@ -7,8 +7,16 @@
  * integral‑convertible types) and an optional `Context` object that is
  * passed to guard and action callables.
  *
- * The design uses an `unordered_map` keyed by a 64‑bit composite of the
- * source state and event for O(1) lookup.
+ * A `runtime` couples an owned `fsm::definition` (the transition table)
+ * with the current state.  Machines that share one table should use
+ * `fsm::instance` instead, which only references the definition.
+ *
+ * An optional instrumentation policy (see instrumentation.hpp) observes
+ * every dispatch; the default `fsm::no_instrumentation` compiles away.
+ *
+ * Timeouts added with `add_timeout()` fire on an `fsm::timing_wheel` (see
+ * timing_wheel.hpp) when the `fsm::wheel_timers` policy is selected; the
+ * default `fsm::no_timers` adds nothing.
  *
  * The implementation is deliberately header-only; the class is declared
  * `inline` so that the library can be used as an INTERFACE target in CMake.
@@ -17,36 +25,25 @@
 #ifndef FSM_RUNTIME_HPP
 #define FSM_RUNTIME_HPP
 
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
-#include <functional>
-#include <unordered_map>
-#include <utility>
+#include <initializer_list>
+#include <iterator>
+#include <memory_resource>
+#include <ostream>
+#include <ranges>
+#include <span>
 #include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
-namespace fsm {
-
-/**
- * @brief Internal traits to handle void vs non-void context types.
- */
-template <typename Context>
-struct fsm_types {
-    using Guard = std::function<bool(const Context&)>;
-    using Action = std::function<void(Context&)>;
-};
-
-template <>
-struct fsm_types<void> {
-    using Guard = std::function<bool()>;
-    using Action = std::function<void()>;
-};
-
-/*
- * Forward declaration of helper used by runtime::to_dot
- */
-template<class T>
-std::string to_string(const T& value);
+#include <fsm/definition.hpp>
+#include <fsm/instrumentation.hpp>
+#include <fsm/timing_wheel.hpp>
 
+namespace fsm {
 
 /**
  * @brief Runtime finite state machine.
@@ -54,38 +51,28 @@ std::string to_string(const T& value);
  * @tparam State   Enum class (or integral type) identifying states.
  * @tparam Event   Enum class (or integral type) identifying events.
  * @tparam Context User‑defined data that is passed to guard/action callables.
+ * @tparam Instrumentation Dispatch observer policy (see instrumentation.hpp).
+ * @tparam Timers  Timeout policy (see timing_wheel.hpp).
  *
  * The `Context` type defaults to `void` when no external data is needed.
  * In that case guard/action callables receive no arguments.
  */
-template <class State, class Event, class Context = void>
+template <class State, class Event, class Context = void,
+          class Instrumentation = no_instrumentation, class Timers = no_timers>
 class runtime {
 public:
     /* ------------------------------------------------------------ */
     /* Types                                                        */
     /* ------------------------------------------------------------ */
-    using Guard = typename fsm_types<Context>::Guard;
-    using Action = typename fsm_types<Context>::Action;
+    using Definition = definition<State, Event, Context>;
+    using Guard = typename Definition::Guard;
+    using Action = typename Definition::Action;
+    using Transition = typename Definition::Transition;
 
     /**
-     * @brief Structure describing a single transition.
+     * @brief Result of a dispatch operation (see fsm::result).
      */
-    struct Transition {
-        State   src;   /**< Source state */
-        Event   ev;    /**< Event triggering the transition */
-        State   dst;   /**< Destination state */
-        Guard   guard; /**< Optional guard, may be empty */
-        Action  action;/**< Optional action, may be empty */
-    };
-
-    /**
-     * @brief Result of a dispatch operation.
-     */
-    enum class Result {
-        Ok,             /**< Transition performed */
-        NoTransition,   /**< No matching transition for current state/event */
-        GuardRejected   /**< Guard evaluated to false */
-    };
+    using Result = result;
 
     /* ------------------------------------------------------------ */
     /* Construction                                                 */
@@ -93,20 +80,153 @@ public:
     /**
      * @brief Construct the FSM with an initial state.
      * @param start Initial state of the machine.
+     * @param mr    Resource the transition table allocates from (e.g. a
+     *              `std::pmr::monotonic_buffer_resource` shared by many
+     *              machines); must outlive the runtime.
      */
-    explicit runtime(State start) noexcept : current_(start) {}
+    explicit runtime(State start,
+                     std::pmr::memory_resource* mr =
+                         std::pmr::get_default_resource())
+        : table_(mr), current_(start) {}
 
     /* ------------------------------------------------------------ */
     /* Transition management                                        */
     /* ------------------------------------------------------------ */
     /**
      * @brief Add a transition to the internal table.
+     *
+     * An existing entry for the same `(src, ev)` pair is overwritten.
+     *
      * @param tr Transition description.
+     * @return `false` if the table is frozen (see `freeze()`), `true`
+     *         otherwise.
+     */
+    inline bool add_transition(const Transition& tr) {
+        return grown(table_.add_transition(tr));
+    }
+
+    /**
+     * @brief Add every transition of `range` in one pass.
+     * @see definition::add_transitions()
+     */
+    template <std::ranges::input_range R>
+        requires std::convertible_to<std::ranges::range_reference_t<R>,
+                                     const Transition&>
+    inline bulk_report add_transitions(R&& range,
+                                       on_duplicate policy = on_duplicate::Overwrite,
+                                       std::vector<std::size_t>* duplicates = nullptr) {
+        const bulk_report r =
+            table_.add_transitions(std::forward<R>(range), policy, duplicates);
+        grown(r.added + r.duplicates > 0);
+        return r;
+    }
+
+    inline bulk_report add_transitions(std::initializer_list<Transition> list,
+                                       on_duplicate policy = on_duplicate::Overwrite,
+                                       std::vector<std::size_t>* duplicates = nullptr) {
+        const bulk_report r = table_.add_transitions(list, policy, duplicates);
+        grown(r.added + r.duplicates > 0);
+        return r;
+    }
+
+    /**
+     * @brief Make room for `n` transitions in total.
+     * @see definition::reserve()
+     */
+    inline void reserve(std::size_t n) { table_.reserve(n); }
+
+    /**
+     * @brief Add another guarded candidate for `(src, ev)`.
+     * @see definition::append_transition()
+     */
+    inline bool append_transition(const Transition& tr) {
+        return grown(table_.append_transition(tr));
+    }
+
+    /**
+     * @brief Add a transition taken on `ev` from any state.
+     * @see definition::add_any_state()
+     */
+    inline bool add_any_state(Event ev, State dst, Guard guard = nullptr,
+                              Action action = nullptr) {
+        return grown(table_.add_any_state(ev, dst, std::move(guard),
+                                          std::move(action)));
+    }
+
+    /**
+     * @brief Add a transition taken from `src` on any unhandled event.
+     * @see definition::add_default()
+     */
+    inline bool add_default(State src, State dst, Guard guard = nullptr,
+                            Action action = nullptr) {
+        return grown(table_.add_default(src, dst, std::move(guard),
+                                        std::move(action)));
+    }
+
+    /**
+     * @brief Nest `child` inside `parent` so unhandled events bubble up.
+     * @see definition::set_parent()
+     */
+    inline bool set_parent(State child, State parent) {
+        return table_.set_parent(child, parent);
+    }
+
+    /**
+     * @brief Leave `src` for `dst` after it has been current for `after` ticks.
+     * @see definition::add_timeout()
+     */
+    inline bool add_timeout(State src, uint64_t after, State dst,
+                            Action action = nullptr) {
+        return table_.add_timeout(src, after, dst, std::move(action));
+    }
+
+    /**
+     * @brief Compile the table into its immutable, perfectly hashed form.
+     * @see definition::freeze()
+     */
+    inline void freeze() { table_.freeze(); }
+
+    /**
+     * @brief Reorder the table by profile, then freeze it.
+     * @see definition::freeze(std::span<const uint64_t>)
      */
-    inline void add_transition(const Transition& tr) {
-        table_[key(tr.src, tr.ev)] = tr;
+    inline void freeze(std::span<const uint64_t> profile) {
+        optimize_layout(profile);
+        freeze();
     }
 
+    /**
+     * @brief Reorder transitions by observed hotness.
+     *
+     * Ordinals change, so a counting instrumentation policy is reset.
+     *
+     * @see definition::optimize_layout()
+     */
+    inline bool optimize_layout(std::span<const uint64_t> hits) {
+        if (!table_.optimize_layout(hits)) {
+            return false;
+        }
+        if constexpr (requires { instr_.reset(); }) {
+            instr_.reset();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Whether `freeze()` has been called.
+     */
+    inline bool frozen() const noexcept { return table_.frozen(); }
+
+    /**
+     * @brief Number of transitions in the table.
+     */
+    inline std::size_t size() const noexcept { return table_.size(); }
+
+    /**
+     * @brief Access the underlying transition table.
+     */
+    inline const Definition& table() const noexcept { return table_; }
+
     /**
      * @brief Dispatch an event.
      *
@@ -116,35 +236,96 @@ public:
      */
     template <typename C = Context>
     inline Result dispatch(Event ev, C& ctx) requires (!std::is_void_v<C>) {
-        auto it = table_.find(key(current_, ev));
-        if (it == table_.end()) {
-            return Result::NoTransition;
-        }
-        const auto& tr = it->second;
-        if (tr.guard && !tr.guard(ctx)) {
-            return Result::GuardRejected;
-        }
-        if (tr.action) {
-            tr.action(ctx);
-        }
-        current_ = tr.dst;
-        return Result::Ok;
+        return one(ev, ctx);
     }
 
     inline Result dispatch(Event ev) requires (std::is_void_v<Context>) {
-        auto it = table_.find(key(current_, ev));
-        if (it == table_.end()) {
-            return Result::NoTransition;
+        return one(ev);
+    }
+
+    /**
+     * @brief Dispatch an event and return its action as a ticket.
+     *
+     * The state is committed at once; the action runs only when the
+     * ticket is passed to `run()`, for example by a worker or in a batch.
+     * Instrumentation sees the dispatch as usual, but guard cycles are not
+     * timed on this path.
+     *
+     * @see definition::dispatch_deferred()
+     */
+    template <typename C = Context>
+    inline Result dispatch_deferred(Event ev, const C& ctx, action_ticket& t)
+        requires (!std::is_void_v<C>) {
+        if constexpr (Instrumentation::enabled) {
+            return timed(instrumented_defer(ev, t, ctx));
+        } else {
+            return timed(table_.dispatch_deferred(current_, ev, ctx, t));
         }
-        const auto& tr = it->second;
-        if (tr.guard && !tr.guard()) {
-            return Result::GuardRejected;
+    }
+
+    inline Result dispatch_deferred(Event ev, action_ticket& t)
+        requires (std::is_void_v<Context>) {
+        if constexpr (Instrumentation::enabled) {
+            return timed(instrumented_defer(ev, t));
+        } else {
+            return timed(table_.dispatch_deferred(current_, ev, t));
         }
-        if (tr.action) {
-            tr.action();
+    }
+
+    /**
+     * @brief Run the action a ticket from `dispatch_deferred()` stands for.
+     * @see definition::run()
+     */
+    template <typename C = Context>
+    inline void run(action_ticket t, C& ctx) requires (!std::is_void_v<C>) {
+        run_ticket(t, ctx);
+    }
+
+    inline void run(action_ticket t) requires (std::is_void_v<Context>) {
+        run_ticket(t);
+    }
+
+    /**
+     * @brief Run a batch of tickets in order, skipping empty ones.
+     */
+    template <typename C = Context>
+    inline void run(std::span<const action_ticket> ts, C& ctx)
+        requires (!std::is_void_v<C>) {
+        for (const action_ticket t : ts) {
+            run_ticket(t, ctx);
+        }
+    }
+
+    inline void run(std::span<const action_ticket> ts)
+        requires (std::is_void_v<Context>) {
+        for (const action_ticket t : ts) {
+            run_ticket(t);
         }
-        current_ = tr.dst;
-        return Result::Ok;
+    }
+
+    /**
+     * @brief Dispatch a batch of events in one call.
+     *
+     * @param evs             Events to dispatch, in order.
+     * @param ctx             Context passed to guard/action callables.
+     * @param out             Per-event results, or empty.
+     * @param stop_at_failure Stop after the first result other than `Ok`.
+     * @return Number of events consumed.
+     * @see definition::dispatch_many()
+     */
+    template <typename C = Context>
+    inline std::size_t dispatch_many(std::span<const Event> evs, C& ctx,
+                                     std::span<Result> out = {},
+                                     bool stop_at_failure = false)
+        requires (!std::is_void_v<Context>) {
+        return many(evs, out, stop_at_failure, ctx);
+    }
+
+    inline std::size_t dispatch_many(std::span<const Event> evs,
+                                     std::span<Result> out = {},
+                                     bool stop_at_failure = false)
+        requires (std::is_void_v<Context>) {
+        return many(evs, out, stop_at_failure);
     }
 
     /**
@@ -153,74 +334,348 @@ public:
      */
     inline State current() const noexcept { return current_; }
 
+    /**
+     * @brief Capture the current state (and any pending timeout).
+     *
+     * With `fsm::wheel_timers` and attached timers, `timeout_left` holds
+     * the ticks left before the current state's timeout fires.
+     */
+    inline machine_snapshot<State> snapshot() const noexcept {
+        machine_snapshot<State> s{ current_ };
+        if constexpr (Timers::enabled) {
+            if (timers_.timers.armed()) {
+                s.timeout_left = timers_.timers.deadline() - timers_.wheel->now();
+            }
+        }
+        return s;
+    }
+
+    /**
+     * @brief Make `s.state` current without dispatching anything.
+     *
+     * No action runs.  With attached timers, the timeout of the restored
+     * state is armed for `s.timeout_left` ticks, or for its full duration
+     * when `timeout_left` is 0.
+     *
+     * @return `false` (and no change) if the state lies outside a declared
+     *         `fsm::enum_count`.
+     */
+    inline bool restore(const machine_snapshot<State>& s) noexcept {
+        if (!detail::in_declared_range(s.state)) {
+            return false;
+        }
+        current_ = s.state;
+        if constexpr (Timers::enabled) {
+            if (timers_.wheel != nullptr) {
+                const auto* to = table_.timeout(current_);
+                if (to != nullptr && s.timeout_left != 0) {
+                    timers_.wheel->arm(timers_.timers,
+                                       timers_.wheel->now() + s.timeout_left);
+                } else {
+                    retime();
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Approximate bytes used by the table and the current state.
+     */
+    inline memory_report memory_usage() const noexcept {
+        memory_report r = table_.memory_usage();
+        r.per_instance = sizeof(State);
+        r.instances = sizeof(State);
+        return r;
+    }
+
     /* ------------------------------------------------------------ */
-    /* DOT graph generation                                         */
+    /* Timeouts                                                     */
     /* ------------------------------------------------------------ */
     /**
-     * @brief Generate a GraphViz DOT representation of the FSM.
+     * @brief Drive this machine's timeouts from `wheel`.
      *
-     * The function requires that `State` and `Event` can be converted to
-     * `std::string` via `std::to_string` or a user‑provided overload.
-     * For enum classes, users can specialise `std::to_string` or provide a
-     * custom formatter.
+     * Requires the `fsm::wheel_timers` policy.  The timeout of the
+     * current state is armed at once, relative to `wheel.now()`; from then
+     * on every transition re-arms or cancels it and `wheel.tick()` takes
+     * expired timeouts, running their actions with `ctx`.  Arming and
+     * cancelling never allocate.  Timeout transitions are not reported to
+     * the instrumentation policy.
      *
+     * @param wheel Wheel to arm on; must outlive the attachment.
+     * @param ctx   Context for timeout actions; must outlive the attachment.
+     */
+    template <typename C = Context>
+    inline void attach_timers(timing_wheel& wheel, C& ctx)
+        requires (Timers::enabled && !std::is_void_v<C>) {
+        timers_.ctx = &ctx;
+        attach(wheel);
+    }
+
+    inline void attach_timers(timing_wheel& wheel)
+        requires (Timers::enabled && std::is_void_v<Context>) {
+        attach(wheel);
+    }
+
+    /**
+     * @brief Cancel the pending timeout and stop arming new ones.
+     */
+    inline void detach_timers() noexcept requires (Timers::enabled) {
+        timers_.timers.cancel();
+        timers_.wheel = nullptr;
+    }
+
+    /**
+     * @brief Timer of the current state's timeout (armed while pending).
+     */
+    inline const timer& timeout_timer() const noexcept
+        requires (Timers::enabled) {
+        return timers_.timers;
+    }
+
+    /* ------------------------------------------------------------ */
+    /* DOT graph generation                                         */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Generate a GraphViz DOT representation of the FSM.
+     * @see definition::to_dot()
      * @return DOT language string describing states and transitions.
      */
-    inline std::string to_dot() const {
-        std::string dot = "digraph FSM {\n  rankdir=LR;\n";
-        for (const auto& kv : table_) {
-            const auto& tr = kv.second;
-            dot += "  \"" + to_string(tr.src) + "\" -> \"" +
-                   to_string(tr.dst) + "\" [label=\"" +
-                   to_string(tr.ev) + "\"];\n";
-        }
-        dot += "}\n";
-        return dot;
+    inline std::string to_dot() const { return table_.to_dot(); }
+
+    /**
+     * @brief DOT graph with observed edge frequencies.
+     * @see definition::to_dot(std::span<const uint64_t>)
+     */
+    inline std::string to_dot(std::span<const uint64_t> counts) const {
+        return table_.to_dot(counts);
+    }
+
+    /**
+     * @brief Stream the DOT graph into an output iterator.
+     * @see definition::write_dot()
+     */
+    template <std::output_iterator<char> OutputIt>
+    inline OutputIt write_dot(OutputIt out, const dot_options& opt = {}) const {
+        return table_.write_dot(out, opt);
     }
 
-private:
     /**
-     * @brief Combine state and event into a 64-bit key for the hash map.
-     * @param s State value.
-     * @param e Event value.
-     * @return 64‑bit composite key.
+     * @brief Stream the DOT graph into `os`.
+     * @see definition::write_dot()
      */
-    static constexpr uint64_t key(State s, Event e) noexcept {
-        uint64_t s_val = 0;
-        uint64_t e_val = 0;
+    inline void write_dot(std::ostream& os, const dot_options& opt = {}) const {
+        table_.write_dot(os, opt);
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Instrumentation                                              */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Access the instrumentation policy (e.g. for `snapshot()`).
+     */
+    inline const Instrumentation& instrumentation() const noexcept {
+        return instr_;
+    }
 
-        if constexpr (std::is_enum_v<State>) {
-            s_val = static_cast<uint64_t>(static_cast<std::underlying_type_t<State>>(s));
+    inline Instrumentation& instrumentation() noexcept { return instr_; }
+
+private:
+    /* Keep per-transition instrumentation in step with the table. */
+    inline bool grown(bool added) {
+        if constexpr (Instrumentation::enabled) {
+            if (added) {
+                instr_.resize(table_.size());
+            }
+        }
+        return added;
+    }
+
+private:
+    template <class... C>
+    inline Result one(Event ev, C&... ctx) {
+        if constexpr (Instrumentation::enabled) {
+            return timed(instrumented_dispatch(ev, ctx...));
         } else {
-            s_val = static_cast<uint64_t>(s);
+            return timed(table_.dispatch(current_, ev, ctx...));
         }
+    }
 
-        if constexpr (std::is_enum_v<Event>) {
-            e_val = static_cast<uint64_t>(static_cast<std::underlying_type_t<Event>>(e));
+    template <class... C>
+    inline std::size_t many(std::span<const Event> evs, std::span<Result> out,
+                            bool stop_at_failure, C&... ctx) {
+        if constexpr (!Instrumentation::enabled) {
+            if (!attached()) {
+                return table_.dispatch_many(current_, evs, ctx..., out,
+                                            stop_at_failure);
+            }
+        }
+        const std::size_t n = out.empty() || out.size() > evs.size()
+                                  ? evs.size() : out.size();
+        std::size_t i = 0;
+        while (i < n) {
+            const Result r = one(evs[i], ctx...);
+            if (!out.empty()) {
+                out[i] = r;
+            }
+            ++i;
+            if (stop_at_failure && r != Result::Ok) {
+                break;
+            }
+        }
+        return i;
+    }
+
+    /* Every taken transition restarts the timeout of the state entered. */
+    inline Result timed(Result r) noexcept {
+        if constexpr (Timers::enabled) {
+            if (timers_.wheel != nullptr && r == Result::Ok) {
+                retime();
+            }
+        }
+        return r;
+    }
+
+    inline bool attached() const noexcept {
+        if constexpr (Timers::enabled) {
+            return timers_.wheel != nullptr;
         } else {
-            e_val = static_cast<uint64_t>(e);
+            return false;
         }
+    }
 
-        return ((s_val & 0xFFFFFFFFULL) << 32) | (e_val & 0xFFFFFFFFULL);
+    inline void retime() noexcept {
+        timing_wheel& wheel = *timers_.wheel;
+        if (const auto* to = table_.timeout(current_)) {
+            wheel.arm(timers_.timers, wheel.now() + to->after);
+        } else {
+            timers_.timers.cancel();
+        }
     }
 
-    std::unordered_map<uint64_t, Transition> table_; /**< Transition table */
-    State current_;                                 /**< Current active state */
-};
+    inline void attach(timing_wheel& wheel) noexcept {
+        timers_.timers.cancel();
+        timers_.timers.bind(&expire, this);
+        timers_.wheel = &wheel;
+        retime();
+    }
 
-/**
- * @brief Helper to convert enums or integral types to string.
- *
- * Users can specialise this overload for their own enum classes.
- */
-template <class T>
-inline std::string to_string(const T& value) {
-    if constexpr (std::is_enum_v<T>) {
-        return std::to_string(static_cast<std::underlying_type_t<T>>(value));
-    } else {
-        return std::to_string(value);
-    }
-}
+    static inline void expire(timer&, void* self) {
+        runtime& rt = *static_cast<runtime*>(self);
+        const auto* to = rt.table_.timeout(rt.current_);
+        if (to == nullptr) {
+            return;
+        }
+        if (to->action) {
+            if constexpr (std::is_void_v<Context>) {
+                to->action();
+            } else {
+                to->action(*rt.timers_.ctx);
+            }
+        }
+        rt.current_ = to->dst;
+        rt.retime();
+    }
+
+    /*
+     * Same flow as definition::dispatch, reporting the transition ordinal
+     * and, for timing policies, guard/action cycle counts to the policy.
+     */
+    template <class... C>
+    inline Result instrumented_dispatch(Event ev, C&... ctx) {
+        const State src = current_;
+        const uint32_t i = table_.ordinal(src, ev);
+        if (i == perfect_hash::npos) {
+            instr_.on_dispatch(no_transition, src, ev, src,
+                               Result::NoTransition);
+            return Result::NoTransition;
+        }
+        const auto candidates = table_.candidates(i);
+        const Transition* tr = nullptr;
+        std::size_t ordinal = i;
+        for (const Transition& c : candidates) {
+            if (!c.guard) {
+                tr = &c;
+                break;
+            }
+            bool pass;
+            if constexpr (Instrumentation::timing) {
+                const uint64_t t0 = detail::cycle_count();
+                pass = c.guard(ctx...);
+                instr_.on_guard(ordinal, detail::cycle_count() - t0);
+            } else {
+                pass = c.guard(ctx...);
+            }
+            if (pass) {
+                tr = &c;
+                break;
+            }
+            ++ordinal;
+        }
+        if (tr == nullptr) {
+            /* Every candidate rejected: reported against the first. */
+            instr_.on_dispatch(i, src, ev, candidates.front().dst,
+                               Result::GuardRejected);
+            return Result::GuardRejected;
+        }
+        if (tr->action) {
+            if constexpr (Instrumentation::timing) {
+                const uint64_t t0 = detail::cycle_count();
+                tr->action(ctx...);
+                instr_.on_action(ordinal, detail::cycle_count() - t0);
+            } else {
+                tr->action(ctx...);
+            }
+        }
+        current_ = tr->dst;
+        instr_.on_dispatch(ordinal, src, ev, tr->dst, Result::Ok);
+        return Result::Ok;
+    }
+
+    /* instrumented_dispatch without the action, which becomes `t`. */
+    template <class... C>
+    inline Result instrumented_defer(Event ev, action_ticket& t, const C&... ctx) {
+        const State src = current_;
+        Result r;
+        const uint32_t i = table_.resolve(src, ev, r, ctx...);
+        t.ordinal = perfect_hash::npos;
+        if (i == perfect_hash::npos) {
+            if (r == Result::GuardRejected) {
+                const uint32_t first = table_.ordinal(src, ev);
+                instr_.on_dispatch(first, src, ev, table_.target(first), r);
+            } else {
+                instr_.on_dispatch(no_transition, src, ev, src, r);
+            }
+            return r;
+        }
+        if (table_.transitions()[i].action) {
+            t.ordinal = i;
+        }
+        current_ = table_.target(i);
+        instr_.on_dispatch(i, src, ev, current_, Result::Ok);
+        return Result::Ok;
+    }
+
+    template <class... C>
+    inline void run_ticket(action_ticket t, C&... ctx) {
+        if (!t) {
+            return;
+        }
+        if constexpr (Instrumentation::timing) {
+            const uint64_t t0 = detail::cycle_count();
+            table_.run_action(t.ordinal, ctx...);
+            instr_.on_action(t.ordinal, detail::cycle_count() - t0);
+        } else {
+            table_.run_action(t.ordinal, ctx...);
+        }
+    }
+
+    Definition table_; /**< Transition table */
+    State current_;    /**< Current active state */
+    [[no_unique_address]] Instrumentation instr_; /**< Dispatch observer */
+    [[no_unique_address]] detail::timer_hook<Timers::enabled, Context, timer>
+        timers_;                       /**< Timeout state, if enabled */
+};
 
 } /* namespace fsm */
 
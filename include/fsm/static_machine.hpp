@@ -0,0 +1,198 @@
+/**
+ * @file static_machine.hpp
+ * @brief Compile-time (type-encoded) finite state machine.
+ *
+ * `fsm::static_machine` takes its whole transition table as template
+ * arguments.  Each `fsm::transition<Src, Ev, Dst, Guard, Action>` entry
+ * carries its guard and action as non-type template parameters (function
+ * pointers or capture-less lambdas), so `dispatch` expands into a chain of
+ * constant key comparisons the compiler lowers to a switch / jump table,
+ * with the guards and actions inlined as direct calls.
+ *
+ * There is no table to build: no allocation and no `std::function`
+ * indirection, and `dispatch` is usable in constant expressions.  The
+ * `current()` / `dispatch()` / `Result` interface matches `fsm::runtime`.
+ */
+
+#ifndef FSM_STATIC_MACHINE_HPP
+#define FSM_STATIC_MACHINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <fsm/runtime.hpp>
+
+namespace fsm {
+
+/**
+ * @brief Compile-time description of a single transition.
+ *
+ * @tparam Src    Source state.
+ * @tparam Ev     Event triggering the transition.
+ * @tparam Dst    Destination state.
+ * @tparam Guard  Optional guard callable, `nullptr` when absent.
+ * @tparam Action Optional action callable, `nullptr` when absent.
+ */
+template <auto Src, auto Ev, auto Dst, auto Guard = nullptr,
+          auto Action = nullptr>
+struct transition {
+    static constexpr auto src = Src;       /**< Source state */
+    static constexpr auto ev = Ev;         /**< Triggering event */
+    static constexpr auto dst = Dst;       /**< Destination state */
+    static constexpr auto guard = Guard;   /**< Guard or nullptr */
+    static constexpr auto action = Action; /**< Action or nullptr */
+
+    static constexpr bool has_guard =
+        !std::is_null_pointer_v<std::remove_cv_t<decltype(Guard)>>;
+    static constexpr bool has_action =
+        !std::is_null_pointer_v<std::remove_cv_t<decltype(Action)>>;
+};
+
+/**
+ * @brief Finite state machine whose table is fixed at compile time.
+ *
+ * @tparam State       Enum class (or integral type) identifying states.
+ * @tparam Event       Enum class (or integral type) identifying events.
+ * @tparam Context     User data passed to guards/actions, or `void`.
+ * @tparam Transitions `fsm::transition<...>` entries; each `(src, ev)` pair
+ *                     may appear at most once.
+ */
+template <class State, class Event, class Context, class... Transitions>
+class static_machine {
+public:
+    using Result = result;
+
+    /* ------------------------------------------------------------ */
+    /* Construction                                                 */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Construct the FSM with an initial state.
+     * @param start Initial state of the machine.
+     */
+    constexpr explicit static_machine(State start) noexcept
+        : current_(start) {}
+
+    /* ------------------------------------------------------------ */
+    /* Dispatch                                                     */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Dispatch an event.
+     *
+     * @param ev   Event to dispatch.
+     * @param ctx  Context passed to guard/action callables.
+     * @return Result indicating success or failure reason.
+     */
+    template <typename C = Context>
+    constexpr Result dispatch(Event ev, C& ctx) requires (!std::is_void_v<C>) {
+        const uint64_t k = key(current_, ev);
+        Result r = Result::NoTransition;
+        (void)(try_entry<Transitions>(k, r, ctx) || ...);
+        return r;
+    }
+
+    constexpr Result dispatch(Event ev) requires (std::is_void_v<Context>) {
+        const uint64_t k = key(current_, ev);
+        Result r = Result::NoTransition;
+        (void)(try_entry<Transitions>(k, r) || ...);
+        return r;
+    }
+
+    /**
+     * @brief Retrieve the current active state.
+     * @return Current state value.
+     */
+    constexpr State current() const noexcept { return current_; }
+
+    /**
+     * @brief Number of transitions in the table.
+     */
+    static constexpr std::size_t size() noexcept {
+        return sizeof...(Transitions);
+    }
+
+    /* ------------------------------------------------------------ */
+    /* DOT graph generation                                         */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Generate a GraphViz DOT representation of the FSM.
+     *
+     * Same format as `runtime::to_dot()`, edges in declaration order.
+     *
+     * @return DOT language string describing states and transitions.
+     */
+    static std::string to_dot() {
+        std::string dot = "digraph FSM {\n  rankdir=LR;\n";
+        ((dot += "  \"" + to_string(Transitions::src) + "\" -> \"" +
+                 to_string(Transitions::dst) + "\" [label=\"" +
+                 to_string(Transitions::ev) + "\"];\n"),
+         ...);
+        dot += "}\n";
+        return dot;
+    }
+
+private:
+    static constexpr uint64_t key(State s, Event e) noexcept {
+        const auto s_val = static_cast<uint64_t>(detail::underlying(s));
+        const auto e_val = static_cast<uint64_t>(detail::underlying(e));
+        return ((s_val & 0xFFFFFFFFULL) << 32) | (e_val & 0xFFFFFFFFULL);
+    }
+
+    template <class T>
+    static constexpr uint64_t entry_key = key(T::src, T::ev);
+
+    static constexpr bool unique_keys() noexcept {
+        constexpr uint64_t keys[] = { entry_key<Transitions>..., 0 };
+        for (std::size_t i = 0; i < sizeof...(Transitions); ++i) {
+            for (std::size_t j = i + 1; j < sizeof...(Transitions); ++j) {
+                if (keys[i] == keys[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static_assert((std::is_same_v<std::remove_cv_t<decltype(Transitions::src)>,
+                                  State> && ...),
+                  "transition source must be of type State");
+    static_assert((std::is_same_v<std::remove_cv_t<decltype(Transitions::dst)>,
+                                  State> && ...),
+                  "transition destination must be of type State");
+    static_assert((std::is_same_v<std::remove_cv_t<decltype(Transitions::ev)>,
+                                  Event> && ...),
+                  "transition event must be of type Event");
+    static_assert(unique_keys(),
+                  "each (src, ev) pair may appear only once");
+
+    /*
+     * Try a single table entry.  Returns true when the entry matched the
+     * key (whether or not its guard accepted), which stops the fold.
+     */
+    template <class T, class... C>
+    constexpr bool try_entry(uint64_t k, Result& r, C&... ctx) {
+        if (k != entry_key<T>) {
+            return false;
+        }
+        if constexpr (T::has_guard) {
+            if (!T::guard(std::as_const(ctx)...)) {
+                r = Result::GuardRejected;
+                return true;
+            }
+        }
+        if constexpr (T::has_action) {
+            T::action(ctx...);
+        }
+        current_ = T::dst;
+        r = Result::Ok;
+        return true;
+    }
+
+    State current_; /**< Current active state */
+};
+
+} /* namespace fsm */
+
+#endif /* FSM_STATIC_MACHINE_HPP */
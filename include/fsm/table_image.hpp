@@ -0,0 +1,634 @@
+/**
+ * @file table_image.hpp
+ * @brief Binary images of frozen tables, dispatched from in place.
+ *
+ * `fsm::save_image()` writes a frozen `fsm::definition` as a versioned,
+ * position-independent byte image: a header with section offsets, one
+ * fixed-size record per transition, the arrays of the perfect hash, the
+ * wildcard fallbacks and an optional table of callable names.  Guards and
+ * actions are not stored; each transition refers to them by slot index
+ * instead.
+ *
+ * `fsm::table_view` validates an image and dispatches straight from its
+ * bytes (typically a file mapped with `fsm::mapped_file`), without
+ * copying or rebuilding anything.  Callables are bound to its slots after
+ * loading, by index or by the names saved with the image, so a process
+ * start costs one `mmap` and a header check instead of building the
+ * table.
+ *
+ * Images are in host byte order and must be 8-byte aligned; they are
+ * only valid for the `State`/`Event` types they were saved from (their
+ * declared counts and key layout are checked).
+ */
+
+#ifndef FSM_TABLE_IMAGE_HPP
+#define FSM_TABLE_IMAGE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FSM_HAS_MMAP 1
+#endif
+
+#include <fsm/definition.hpp>
+
+namespace fsm {
+
+/** @brief Magic bytes at the start of every table image. */
+inline constexpr char image_magic[8] = { 'F', 'S', 'M', 'T', 'A', 'B', 'L', 'E' };
+
+/** @brief Current image format version. */
+inline constexpr uint32_t image_version = 1;
+
+/** @brief Callable slot of a transition without a guard or action. */
+inline constexpr uint32_t no_callable = 0xFFFFFFFFu;
+
+/**
+ * @brief Guard and action slots of one transition in an image.
+ */
+struct callable_ids {
+    uint32_t guard = no_callable;  /**< Guard slot, or `no_callable` */
+    uint32_t action = no_callable; /**< Action slot, or `no_callable` */
+};
+
+/**
+ * @brief Callable slot assignment passed to `save_image()`.
+ *
+ * `ids[ordinal]` names the slots of each transition.  Ordinals past the
+ * end count as `callable_ids{}`; a callable without a slot is dropped
+ * (the loaded transition behaves as if it had none).  The
+ * optional `guard_names[i]` / `action_names[i]` are stored with the image
+ * so `table_view::bind_guard(name, ...)` can find slot `i`.
+ */
+struct image_bindings {
+    std::span<const callable_ids> ids = {};
+    std::span<const std::string_view> guard_names = {};
+    std::span<const std::string_view> action_names = {};
+};
+
+/**
+ * @brief Image header; all offsets are from the start of the image.
+ */
+struct image_header {
+    char     magic[8];       /**< `image_magic` */
+    uint32_t version;        /**< `image_version` */
+    uint32_t header_size;    /**< `sizeof(image_header)` */
+    uint64_t state_count;    /**< Declared `enum_count<State>`, or 0 */
+    uint64_t event_count;    /**< Declared `enum_count<Event>`, or 0 */
+    uint32_t key_bytes;      /**< `sizeof(definition::key_type)` */
+    uint32_t transitions;    /**< Number of `image_record`s */
+    uint32_t guard_slots;    /**< Number of guard slots */
+    uint32_t action_slots;   /**< Number of action slots */
+    uint32_t disp_count;     /**< Perfect-hash displacement entries */
+    uint32_t slot_count;     /**< Perfect-hash slots */
+    uint32_t any_state_count;/**< `image_fallback`s for any-state entries */
+    uint32_t default_count;  /**< `image_fallback`s for default entries */
+    uint32_t guard_names;    /**< Leading `image_name`s, for guard slots */
+    uint32_t action_names;   /**< Following `image_name`s, for action slots */
+    uint64_t records;        /**< Offset of the `image_record` array */
+    uint64_t disp;           /**< Offset of the displacement array */
+    uint64_t slots;          /**< Offset of the `perfect_hash::slot` array */
+    uint64_t any_state;      /**< Offset of the any-state fallbacks */
+    uint64_t defaults;       /**< Offset of the default fallbacks */
+    uint64_t names;          /**< Offset of the `image_name` array */
+    uint64_t size;           /**< Total image size in bytes */
+};
+
+/**
+ * @brief One transition: underlying values plus callable slots.
+ */
+struct image_record {
+    uint64_t src;    /**< Source state (underlying value) */
+    uint64_t ev;     /**< Event (underlying value) */
+    uint64_t dst;    /**< Destination state (underlying value) */
+    uint32_t guard;  /**< Guard slot, or `no_callable` */
+    uint32_t action; /**< Action slot, or `no_callable` */
+    uint8_t  kind;   /**< `transition_kind` */
+    uint8_t  next;   /**< 1 if the next record is another candidate */
+    uint8_t  pad[6]; /**< Zero */
+};
+
+/**
+ * @brief Wildcard entry: event (any-state) or state (default) value and
+ *        the ordinal it resolves to, sorted by value.
+ */
+struct image_fallback {
+    uint64_t value;   /**< Underlying event or state value */
+    uint32_t ordinal; /**< Record index */
+    uint32_t pad;     /**< Zero */
+};
+
+/**
+ * @brief Callable name: `length` bytes at `offset` from the image start.
+ */
+struct image_name {
+    uint64_t offset;
+    uint64_t length;
+};
+
+static_assert(sizeof(image_header) == 128 && sizeof(image_record) == 40
+              && sizeof(image_fallback) == 16 && sizeof(image_name) == 16
+              && sizeof(perfect_hash::slot) == 16,
+              "image layout must stay fixed");
+
+namespace detail {
+
+template <class T>
+inline constexpr uint64_t declared_count() noexcept {
+    if constexpr (has_enum_count<T>) {
+        return enum_count<T>::value;
+    } else {
+        return 0;
+    }
+}
+
+template <class T>
+inline constexpr uint64_t image_value(T v) noexcept {
+    return static_cast<uint64_t>(underlying(v));
+}
+
+/* Append `n` bytes at an 8-byte aligned offset; returns the offset. */
+inline uint64_t image_append(std::string& out, const void* p, std::size_t n) {
+    out.resize((out.size() + 7) & ~std::size_t{7}, '\0');
+    const uint64_t at = out.size();
+    out.append(static_cast<const char*>(p), n);
+    return at;
+}
+
+} /* namespace detail */
+
+/**
+ * @brief Serialise a frozen definition into an image.
+ *
+ * @param def Frozen table; guards and actions are replaced by slots.
+ * @param out Receives the image (replaced).
+ * @param b   Callable slots and names.
+ * @return `false` if `def` is not frozen.
+ */
+template <class State, class Event, class Context>
+inline bool save_image(const definition<State, Event, Context>& def,
+                       std::string& out, const image_bindings& b = {}) {
+    if (!def.frozen()) {
+        return false;
+    }
+    const auto trs = def.transitions();
+    image_header h{};
+    std::memcpy(h.magic, image_magic, sizeof(h.magic));
+    h.version = image_version;
+    h.header_size = sizeof(image_header);
+    h.state_count = detail::declared_count<State>();
+    h.event_count = detail::declared_count<Event>();
+    h.key_bytes = sizeof(typename definition<State, Event, Context>::key_type);
+    h.transitions = static_cast<uint32_t>(trs.size());
+
+    std::vector<image_record> records(trs.size());
+    std::vector<image_fallback> any_state;
+    std::vector<image_fallback> defaults;
+    for (uint32_t i = 0; i < trs.size(); ++i) {
+        const auto& tr = trs[i];
+        const callable_ids ids = i < b.ids.size() ? b.ids[i] : callable_ids{};
+        image_record& r = records[i];
+        r.src = detail::image_value(tr.src);
+        r.ev = detail::image_value(tr.ev);
+        r.dst = detail::image_value(tr.dst);
+        r.guard = tr.guard ? ids.guard : no_callable;
+        r.action = tr.action ? ids.action : no_callable;
+        r.kind = static_cast<uint8_t>(def.kind(i));
+        if (r.guard != no_callable && r.guard >= h.guard_slots) {
+            h.guard_slots = r.guard + 1;
+        }
+        if (r.action != no_callable && r.action >= h.action_slots) {
+            h.action_slots = r.action + 1;
+        }
+        if (def.kind(i) == transition_kind::AnyState) {
+            any_state.push_back({ r.ev, i, 0 });
+        } else if (def.kind(i) == transition_kind::Default) {
+            defaults.push_back({ r.src, i, 0 });
+        }
+    }
+    /* Mark every candidate but the last of each list. */
+    for (uint32_t i = 0; i < trs.size();) {
+        const auto n = static_cast<uint32_t>(def.candidates(i).size());
+        for (uint32_t j = i; j + 1 < i + n; ++j) {
+            records[j].next = 1;
+        }
+        i += n;
+    }
+    auto by_value = [](const image_fallback& x, const image_fallback& y) {
+        return x.value < y.value;
+    };
+    std::sort(any_state.begin(), any_state.end(), by_value);
+    std::sort(defaults.begin(), defaults.end(), by_value);
+    h.any_state_count = static_cast<uint32_t>(any_state.size());
+    h.default_count = static_cast<uint32_t>(defaults.size());
+
+    if (h.guard_slots < b.guard_names.size()) {
+        h.guard_slots = static_cast<uint32_t>(b.guard_names.size());
+    }
+    if (h.action_slots < b.action_names.size()) {
+        h.action_slots = static_cast<uint32_t>(b.action_names.size());
+    }
+    h.guard_names = static_cast<uint32_t>(b.guard_names.size());
+    h.action_names = static_cast<uint32_t>(b.action_names.size());
+
+    const auto disp = def.frozen_index().displacements();
+    const auto slots = def.frozen_index().slots();
+    h.disp_count = static_cast<uint32_t>(disp.size());
+    h.slot_count = static_cast<uint32_t>(slots.size());
+
+    out.assign(sizeof(image_header), '\0');
+    h.records = detail::image_append(out, records.data(),
+                                     records.size() * sizeof(image_record));
+    h.disp = detail::image_append(out, disp.data(), disp.size() * sizeof(uint32_t));
+    h.slots = detail::image_append(out, slots.data(),
+                                   slots.size() * sizeof(perfect_hash::slot));
+    h.any_state = detail::image_append(out, any_state.data(),
+                                       any_state.size() * sizeof(image_fallback));
+    h.defaults = detail::image_append(out, defaults.data(),
+                                      defaults.size() * sizeof(image_fallback));
+
+    /* Name table first, then the text it points into. */
+    std::vector<image_name> names;
+    names.reserve(h.guard_names + h.action_names);
+    for (auto list : { b.guard_names, b.action_names }) {
+        for (std::string_view n : list) {
+            names.push_back({ 0, n.size() });
+        }
+    }
+    h.names = detail::image_append(out, names.data(), names.size() * sizeof(image_name));
+    std::size_t k = 0;
+    for (auto list : { b.guard_names, b.action_names }) {
+        for (std::string_view n : list) {
+            names[k++].offset = out.size();
+            out.append(n.data(), n.size());
+        }
+    }
+    if (!names.empty()) {
+        std::memcpy(out.data() + h.names, names.data(), names.size() * sizeof(image_name));
+    }
+    out.resize((out.size() + 7) & ~std::size_t{7}, '\0');
+    h.size = out.size();
+    std::memcpy(out.data(), &h, sizeof(h));
+    return true;
+}
+
+/**
+ * @brief Read-only table dispatching from an image in place.
+ *
+ * The view keeps pointers into the image, which must stay mapped and
+ * unchanged while the view is used.  Only the callable slots are owned.
+ * A guard slot that was never bound rejects; an unbound action does
+ * nothing (see `bound()`).
+ *
+ * @tparam State   Enum class (or integral type) identifying states.
+ * @tparam Event   Enum class (or integral type) identifying events.
+ * @tparam Context User‑defined data that is passed to guard/action callables.
+ */
+template <class State, class Event, class Context = void>
+class table_view {
+public:
+    using Definition = definition<State, Event, Context>;
+    using Guard = typename Definition::Guard;
+    using Action = typename Definition::Action;
+    using Result = result;
+
+    /**
+     * @brief Validate an image and point the view at it.
+     *
+     * Checks the magic, version, declared counts, key layout, alignment
+     * and that every section lies inside `image`, then that every index
+     * the view follows stays in bounds: hash slots and fallbacks name
+     * existing records, the last record ends its candidate list, callable
+     * slots exist and destinations lie inside a declared `State` count.
+     * Callable slots are reset to unbound.
+     *
+     * @return `false` (view left empty) if the image is not usable.
+     */
+    inline bool open(std::span<const char> image) {
+        *this = table_view();
+        image_header h;
+        if (image.size() < sizeof(h)
+            || reinterpret_cast<std::uintptr_t>(image.data()) % 8 != 0) {
+            return false;
+        }
+        std::memcpy(&h, image.data(), sizeof(h));
+        if (std::memcmp(h.magic, image_magic, sizeof(h.magic)) != 0
+            || h.version != image_version || h.header_size != sizeof(h)
+            || h.size > image.size()
+            || h.state_count != detail::declared_count<State>()
+            || h.event_count != detail::declared_count<Event>()
+            || h.key_bytes != sizeof(typename Definition::key_type)
+            || (h.disp_count & (h.disp_count - 1)) != 0
+            || (h.slot_count & (h.slot_count - 1)) != 0
+            || (h.slot_count != 0 && h.disp_count == 0)
+            || !inside(h, h.records, h.transitions, sizeof(image_record))
+            || !inside(h, h.disp, h.disp_count, sizeof(uint32_t))
+            || !inside(h, h.slots, h.slot_count, sizeof(perfect_hash::slot))
+            || !inside(h, h.any_state, h.any_state_count, sizeof(image_fallback))
+            || !inside(h, h.defaults, h.default_count, sizeof(image_fallback))
+            || h.guard_names > h.guard_slots || h.action_names > h.action_slots
+            || !inside(h, h.names, uint64_t{ h.guard_names } + h.action_names,
+                       sizeof(image_name))) {
+            return false;
+        }
+        const char* base = image.data();
+        records_ = { reinterpret_cast<const image_record*>(base + h.records), h.transitions };
+        disp_ = { reinterpret_cast<const uint32_t*>(base + h.disp), h.disp_count };
+        slots_ = { reinterpret_cast<const perfect_hash::slot*>(base + h.slots), h.slot_count };
+        any_state_ = { reinterpret_cast<const image_fallback*>(base + h.any_state),
+                       h.any_state_count };
+        defaults_ = { reinterpret_cast<const image_fallback*>(base + h.defaults),
+                      h.default_count };
+        for (const auto& s : slots_) {
+            if (s.index != perfect_hash::npos && s.index >= h.transitions) {
+                *this = table_view();
+                return false;
+            }
+        }
+        for (const auto& r : records_) {
+            if ((r.guard != no_callable && r.guard >= h.guard_slots)
+                || (r.action != no_callable && r.action >= h.action_slots)
+                || (h.state_count != 0 && r.dst >= h.state_count)) {
+                *this = table_view();
+                return false;
+            }
+        }
+        if ((!records_.empty() && records_.back().next != 0)
+            || !ordinals_inside(any_state_, h.transitions)
+            || !ordinals_inside(defaults_, h.transitions)) {
+            *this = table_view();
+            return false;
+        }
+        names_ = { reinterpret_cast<const image_name*>(base + h.names),
+                   std::size_t{ h.guard_names } + h.action_names };
+        for (const auto& n : names_) {
+            if (n.offset > h.size || n.length > h.size - n.offset) {
+                *this = table_view();
+                return false;
+            }
+        }
+        base_ = base;
+        guards_.resize(h.guard_slots);
+        actions_.resize(h.action_slots);
+        guard_names_ = h.guard_names;
+        return true;
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Callable binding                                             */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Bind guard slot `id`.
+     * @return `false` if the image has no such slot.
+     */
+    inline bool bind_guard(uint32_t id, Guard g) {
+        if (id >= guards_.size()) {
+            return false;
+        }
+        guards_[id] = std::move(g);
+        return true;
+    }
+
+    /**
+     * @brief Bind action slot `id`.
+     * @return `false` if the image has no such slot.
+     */
+    inline bool bind_action(uint32_t id, Action a) {
+        if (id >= actions_.size()) {
+            return false;
+        }
+        actions_[id] = std::move(a);
+        return true;
+    }
+
+    /**
+     * @brief Bind the guard slot saved under `name`.
+     * @return `false` if the image has no guard of that name.
+     */
+    inline bool bind_guard(std::string_view name, Guard g) {
+        const uint32_t id = lookup(name, 0, guard_names_);
+        return id != no_callable && bind_guard(id, std::move(g));
+    }
+
+    /**
+     * @brief Bind the action slot saved under `name`.
+     * @return `false` if the image has no action of that name.
+     */
+    inline bool bind_action(std::string_view name, Action a) {
+        const uint32_t id = lookup(name, guard_names_, names_.size());
+        return id != no_callable
+               && bind_action(id - static_cast<uint32_t>(guard_names_), std::move(a));
+    }
+
+    /**
+     * @brief Whether every callable slot used by a transition is bound.
+     */
+    inline bool bound() const noexcept {
+        for (const auto& r : records_) {
+            if ((r.guard != no_callable && !guards_[r.guard])
+                || (r.action != no_callable && !actions_[r.action])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Observers                                                    */
+    /* ------------------------------------------------------------ */
+    /** @brief Whether `open()` succeeded. */
+    inline bool is_open() const noexcept { return base_ != nullptr; }
+
+    /** @brief Number of transitions in the image. */
+    inline std::size_t size() const noexcept { return records_.size(); }
+
+    /** @brief Transition records, by ordinal. */
+    inline std::span<const image_record> records() const noexcept { return records_; }
+
+    /** @brief Number of guard and action slots. */
+    inline std::size_t guard_slots() const noexcept { return guards_.size(); }
+    inline std::size_t action_slots() const noexcept { return actions_.size(); }
+
+    /**
+     * @brief Ordinal of the transition for `(s, e)`, resolved like
+     *        `definition::ordinal()`, or `perfect_hash::npos`.
+     */
+    inline uint32_t ordinal(State s, Event e) const noexcept {
+        if constexpr (detail::key_layout<State, Event>::compact) {
+            if (!detail::in_declared_range(s) || !detail::in_declared_range(e)) {
+                return perfect_hash::npos;
+            }
+        }
+        const uint32_t i = perfect_hash::find(
+            disp_, slots_, detail::key_layout<State, Event>::make(s, e));
+        if (i != perfect_hash::npos) [[likely]] {
+            return i;
+        }
+        const uint32_t a = fallback(any_state_, detail::image_value(e));
+        return a != perfect_hash::npos ? a : fallback(defaults_, detail::image_value(s));
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Dispatch                                                     */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Dispatch an event for a caller-held state, exactly like
+     *        `definition::dispatch()`.
+     */
+    template <typename C = Context>
+    inline Result dispatch(State& state, Event ev, C& ctx) const
+        requires (!std::is_void_v<C>) {
+        return step(state, ev, ctx);
+    }
+
+    inline Result dispatch(State& state, Event ev) const
+        requires (std::is_void_v<Context>) {
+        return step(state, ev);
+    }
+
+private:
+    static inline bool inside(const image_header& h, uint64_t offset,
+                              uint64_t count, uint64_t size) noexcept {
+        return offset % 8 == 0 && offset <= h.size
+               && count <= (h.size - offset) / size;
+    }
+
+    static inline bool ordinals_inside(std::span<const image_fallback> list,
+                                       uint32_t transitions) noexcept {
+        for (const auto& f : list) {
+            if (f.ordinal >= transitions) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static inline uint32_t fallback(std::span<const image_fallback> list,
+                                    uint64_t value) noexcept {
+        if (list.empty()) {
+            return perfect_hash::npos;
+        }
+        const auto it = std::lower_bound(
+            list.begin(), list.end(), value,
+            [](const image_fallback& f, uint64_t v) { return f.value < v; });
+        return it != list.end() && it->value == value ? it->ordinal
+                                                      : perfect_hash::npos;
+    }
+
+    inline uint32_t lookup(std::string_view name, std::size_t from,
+                           std::size_t to) const noexcept {
+        for (std::size_t i = from; i < to; ++i) {
+            const auto& n = names_[i];
+            if (std::string_view(base_ + n.offset, n.length) == name) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+        return no_callable;
+    }
+
+    template <class... C>
+    inline Result step(State& state, Event ev, C&... ctx) const {
+        uint32_t i = ordinal(state, ev);
+        if (i == perfect_hash::npos) {
+            return Result::NoTransition;
+        }
+        for (;; ++i) {
+            const image_record& r = records_[i];
+            if (r.guard != no_callable
+                && !(guards_[r.guard] && guards_[r.guard](ctx...))) {
+                if (r.next) {
+                    continue;
+                }
+                return Result::GuardRejected;
+            }
+            if (r.action != no_callable && actions_[r.action]) {
+                actions_[r.action](ctx...);
+            }
+            state = static_cast<State>(r.dst);
+            return Result::Ok;
+        }
+    }
+
+    const char* base_ = nullptr;
+    std::span<const image_record> records_;
+    std::span<const uint32_t> disp_;
+    std::span<const perfect_hash::slot> slots_;
+    std::span<const image_fallback> any_state_;
+    std::span<const image_fallback> defaults_;
+    std::span<const image_name> names_;
+    std::size_t guard_names_ = 0;  /**< Leading entries of names_ for guards */
+    std::vector<Guard> guards_;    /**< Bound guard slots */
+    std::vector<Action> actions_;  /**< Bound action slots */
+};
+
+#ifdef FSM_HAS_MMAP
+/**
+ * @brief Read-only memory mapping of a whole file (POSIX).
+ */
+class mapped_file {
+public:
+    mapped_file() = default;
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    ~mapped_file() { close(); }
+
+    /**
+     * @brief Map `path` read-only, replacing any previous mapping.
+     * @return `false` if the file cannot be opened or mapped.
+     */
+    inline bool open(const char* path) {
+        close();
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                         PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<const char*>(p);
+        size_ = static_cast<std::size_t>(st.st_size);
+        return true;
+    }
+
+    /** @brief Unmap the file, if mapped. */
+    inline void close() noexcept {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<char*>(data_), size_);
+            data_ = nullptr;
+            size_ = 0;
+        }
+    }
+
+    /** @brief Mapped bytes (page aligned), or an empty span. */
+    inline std::span<const char> bytes() const noexcept { return { data_, size_ }; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+#endif
+
+} /* namespace fsm */
+
+#endif /* FSM_TABLE_IMAGE_HPP */
@@ -0,0 +1,469 @@
+/**
+ * @file timing_wheel.hpp
+ * @brief Hierarchical timing wheel driving timeouts of many machines.
+ *
+ * `fsm::timing_wheel` keeps armed `fsm::timer`s in four levels of 64
+ * slots each.  Level 0 holds the deadlines of the current 64-tick block,
+ * one slot per tick; level `l` holds later deadlines of the current
+ * `64^(l+1)`-tick span, one slot per `64^l` ticks, and deadlines further
+ * out wait in an overflow list.  When time enters a new block, the slot of
+ * the next level that covers it is emptied into the levels below.
+ *
+ * Timers are intrusive: the list links live in the `fsm::timer` object
+ * itself, so arming, re-arming and cancelling are a few pointer writes and
+ * never allocate.  Each level keeps a 64-bit occupancy mask, so `tick()`
+ * visits occupied slots only and skips empty stretches of time in one
+ * step.
+ *
+ * Time is an abstract `uint64_t` tick count supplied by the caller (e.g.
+ * milliseconds of a monotonic clock).  A wheel and the timers armed on it
+ * are not thread-safe; drive them from one thread.
+ */
+
+#ifndef FSM_TIMING_WHEEL_HPP
+#define FSM_TIMING_WHEEL_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace fsm {
+
+class timing_wheel;
+
+namespace detail {
+
+/**
+ * @brief Doubly linked list node shared by timers and slot sentinels.
+ */
+struct timer_link {
+    timer_link* prev = nullptr;
+    timer_link* next = nullptr;
+
+    inline void make_empty() noexcept { prev = next = this; }
+    inline bool empty() const noexcept { return next == this; }
+
+    inline void unlink() noexcept {
+        prev->next = next;
+        next->prev = prev;
+        prev = next = nullptr;
+    }
+
+    inline void push_back(timer_link& n) noexcept {
+        n.prev = prev;
+        n.next = this;
+        prev->next = &n;
+        prev = &n;
+    }
+
+    /* Move every node of `from` (a sentinel) to the end of this list. */
+    inline void splice(timer_link& from) noexcept {
+        if (from.empty()) {
+            return;
+        }
+        from.next->prev = prev;
+        from.prev->next = this;
+        prev->next = from.next;
+        prev = from.prev;
+        from.make_empty();
+    }
+};
+
+} /* namespace detail */
+
+/**
+ * @brief A single timeout that can be armed on a `timing_wheel`.
+ *
+ * When its deadline passes, `tick()` disarms the timer and then calls
+ * `cb(timer, data)`; the callback may re-arm it.  A timer is disarmed on
+ * destruction.  Moving an armed timer moves its place on the wheel.
+ */
+class timer : private detail::timer_link {
+public:
+    /** @brief Expiry callback: the timer and its bound `data`. */
+    using callback = void (*)(timer&, void*);
+
+    timer() noexcept = default;
+
+    timer(callback cb, void* data) noexcept : cb_(cb), data_(data) {}
+
+    timer(const timer&) = delete;
+    timer& operator=(const timer&) = delete;
+
+    timer(timer&& o) noexcept { take(o); }
+
+    timer& operator=(timer&& o) noexcept {
+        if (this != &o) {
+            cancel();
+            take(o);
+        }
+        return *this;
+    }
+
+    ~timer() { cancel(); }
+
+    /**
+     * @brief Set the expiry callback; an armed timer stays armed.
+     */
+    inline void bind(callback cb, void* data) noexcept {
+        cb_ = cb;
+        data_ = data;
+    }
+
+    /** @brief Whether the timer is waiting on a wheel. */
+    inline bool armed() const noexcept { return wheel_ != nullptr; }
+
+    /** @brief Tick the timer fires at; meaningful while armed. */
+    inline uint64_t deadline() const noexcept { return deadline_; }
+
+    /** @brief Disarm the timer; no-op if it is not armed. */
+    inline void cancel() noexcept;
+
+private:
+    friend class timing_wheel;
+
+    inline void take(timer& o) noexcept {
+        cb_ = o.cb_;
+        data_ = o.data_;
+        deadline_ = o.deadline_;
+        slot_ = o.slot_;
+        wheel_ = std::exchange(o.wheel_, nullptr);
+        if (wheel_ != nullptr) {
+            prev = o.prev;
+            next = o.next;
+            prev->next = this;
+            next->prev = this;
+            o.prev = o.next = nullptr;
+        }
+    }
+
+    uint64_t deadline_ = 0;          /**< Absolute expiry tick */
+    timing_wheel* wheel_ = nullptr;  /**< Wheel armed on, or nullptr */
+    callback cb_ = nullptr;          /**< Expiry callback */
+    void* data_ = nullptr;           /**< Callback argument */
+    uint32_t slot_ = 0;              /**< Level * 64 + slot, or overflow */
+};
+
+/**
+ * @brief Four-level hierarchical timing wheel.
+ *
+ * `tick(now)` fires, in deadline order, every armed timer whose deadline
+ * is at most `now`.  A deadline that is not later than `now()` when armed
+ * fires on the next tick that advances time.  Timers firing on the same
+ * tick fire in the order they reached their slot.
+ */
+class timing_wheel {
+public:
+    static constexpr unsigned slot_bits = 6;
+    static constexpr unsigned slots = 1u << slot_bits;
+    static constexpr unsigned levels = 4;
+
+    /**
+     * @brief Create an empty wheel whose clock reads `now`.
+     */
+    explicit timing_wheel(uint64_t now = 0) noexcept : now_(now) {
+        for (detail::timer_link& s : slots_) {
+            s.make_empty();
+        }
+        overflow_.make_empty();
+    }
+
+    timing_wheel(const timing_wheel&) = delete;
+    timing_wheel& operator=(const timing_wheel&) = delete;
+
+    /** @brief Timers still armed are disarmed without firing. */
+    ~timing_wheel() {
+        for (detail::timer_link& s : slots_) {
+            detach(s);
+        }
+        detach(overflow_);
+    }
+
+    /** @brief Last tick passed to `tick()` (or the construction time). */
+    inline uint64_t now() const noexcept { return now_; }
+
+    /** @brief Number of armed timers. */
+    inline std::size_t size() const noexcept { return size_; }
+
+    inline bool empty() const noexcept { return size_ == 0; }
+
+    /**
+     * @brief Arm `t` to fire at tick `deadline`.
+     *
+     * An armed timer is moved to the new deadline, on this wheel even if
+     * it was armed on another one.
+     */
+    inline void arm(timer& t, uint64_t deadline) noexcept {
+        t.cancel();
+        t.deadline_ = deadline > now_ ? deadline : now_ + 1;
+        t.wheel_ = this;
+        ++size_;
+        place(t);
+    }
+
+    /** @brief Arm `t` to fire `delay` ticks from `now()`. */
+    inline void arm_after(timer& t, uint64_t delay) noexcept {
+        arm(t, now_ + delay);
+    }
+
+    /** @brief Disarm `t`; no-op unless it is armed on this wheel. */
+    inline void cancel(timer& t) noexcept {
+        if (t.wheel_ != this) {
+            return;
+        }
+        t.unlink();
+        t.wheel_ = nullptr;
+        --size_;
+        if (t.slot_ < levels * slots && slots_[t.slot_].empty()) {
+            occupied_[t.slot_ >> slot_bits] &=
+                ~(uint64_t{1} << (t.slot_ & (slots - 1)));
+        }
+    }
+
+    /**
+     * @brief Advance the clock to `now` and fire every expired timer.
+     *
+     * Callbacks run with `now()` reading the tick they expired at, so
+     * timers they arm are relative to that tick.  Calls with a `now` that
+     * is not later than `now()` do nothing.
+     *
+     * @return Number of callbacks run.
+     */
+    inline std::size_t tick(uint64_t now) {
+        std::size_t fired = 0;
+        while (now_ < now) {
+            const uint64_t base = now_ + 1;
+            if ((base & (slots - 1)) == 0) {
+                cascade(base);
+            }
+            const uint64_t last = base | (slots - 1);
+            const uint64_t upto = now < last ? now : last;
+            fired += expire(base, upto);
+            now_ = upto;
+            if (now_ == now) {
+                break;
+            }
+            /* A callback on the block's last tick may have armed the next
+               tick, which lands in level 0; otherwise level 0 is drained
+               and the clock jumps to the next block with work. */
+            if (occupied_[0] != 0) {
+                continue;
+            }
+            const uint64_t next = next_cascade(now_ + 1);
+            now_ = next > now ? now : next - 1;
+        }
+        return fired;
+    }
+
+private:
+    static constexpr uint32_t overflow_slot = levels * slots;
+
+    /* File `t` by its deadline relative to the next unprocessed tick. */
+    inline void place(timer& t) noexcept {
+        const uint64_t diff = t.deadline_ ^ (now_ + 1);
+        const unsigned level =
+            diff == 0 ? 0
+                      : static_cast<unsigned>(std::bit_width(diff) - 1)
+                            / slot_bits;
+        if (level >= levels) {
+            t.slot_ = overflow_slot;
+            overflow_.push_back(t);
+            return;
+        }
+        const unsigned s =
+            static_cast<unsigned>(t.deadline_ >> (level * slot_bits))
+            & (slots - 1);
+        t.slot_ = level * slots + s;
+        slots_[t.slot_].push_back(t);
+        occupied_[level] |= uint64_t{1} << s;
+    }
+
+    /* Move a slot's timers into `out`, leaving the slot empty. */
+    inline void take_slot(unsigned level, unsigned s,
+                          detail::timer_link& out) noexcept {
+        out.splice(slots_[level * slots + s]);
+        occupied_[level] &= ~(uint64_t{1} << s);
+    }
+
+    /* Refile every timer of `list` (a detached sentinel). */
+    inline void refile(detail::timer_link& list) noexcept {
+        while (!list.empty()) {
+            timer& t = static_cast<timer&>(*list.next);
+            t.unlink();
+            place(t);
+        }
+    }
+
+    /* `base` starts a level-0 block: pull down the slots covering it. */
+    inline void cascade(uint64_t base) noexcept {
+        unsigned top = 1;
+        while (top < levels - 1
+               && (base & ((uint64_t{1} << ((top + 1) * slot_bits)) - 1))
+                      == 0) {
+            ++top;
+        }
+        detail::timer_link list;
+        list.make_empty();
+        if ((base & ((uint64_t{1} << (levels * slot_bits)) - 1)) == 0) {
+            list.splice(overflow_);
+            refile(list);
+        }
+        for (unsigned level = top; level >= 1; --level) {
+            const unsigned s =
+                static_cast<unsigned>(base >> (level * slot_bits))
+                & (slots - 1);
+            take_slot(level, s, list);
+            refile(list);
+        }
+    }
+
+    /* Fire the level-0 slots for ticks [base, upto] of one block. */
+    inline std::size_t expire(uint64_t base, uint64_t upto) {
+        const uint64_t block = base & ~uint64_t{slots - 1};
+        const unsigned hi = static_cast<unsigned>(upto & (slots - 1));
+        const uint64_t upper = hi == slots - 1 ? ~uint64_t{0}
+                                               : (uint64_t{1} << (hi + 1)) - 1;
+        unsigned lo = static_cast<unsigned>(base & (slots - 1));
+        std::size_t fired = 0;
+        detail::timer_link list;
+        list.make_empty();
+        while (lo < slots) {
+            /* Re-read: callbacks may arm timers later in this block. */
+            const uint64_t pending =
+                occupied_[0] & upper & (~uint64_t{0} << lo);
+            if (pending == 0) {
+                break;
+            }
+            const unsigned s = static_cast<unsigned>(std::countr_zero(pending));
+            now_ = block | s;
+            take_slot(0, s, list);
+            while (!list.empty()) {
+                timer& t = static_cast<timer&>(*list.next);
+                t.unlink();
+                t.wheel_ = nullptr;
+                --size_;
+                ++fired;
+                if (t.cb_ != nullptr) {
+                    t.cb_(t, t.data_);
+                }
+            }
+            lo = s + 1;
+        }
+        return fired;
+    }
+
+    /*
+     * Earliest block start at or after `base` whose cascade has something
+     * to pull down, or UINT64_MAX if nothing is armed.  Every level is
+     * checked: a callback on the last tick of a span files the next span's
+     * timers in low levels, ahead of a higher slot due at the span start.
+     */
+    inline uint64_t next_cascade(uint64_t base) const noexcept {
+        uint64_t best = ~uint64_t{0};
+        if (size_ == 0) {
+            return best;
+        }
+        for (unsigned level = 1; level < levels && best != base; ++level) {
+            const unsigned shift = level * slot_bits;
+            const unsigned cur =
+                static_cast<unsigned>(base >> shift) & (slots - 1);
+            const uint64_t pending = occupied_[level] & (~uint64_t{0} << cur);
+            if (pending != 0) {
+                const unsigned up = shift + slot_bits;
+                const uint64_t span = (base >> up) << up;
+                const uint64_t first =
+                    static_cast<uint64_t>(std::countr_zero(pending));
+                const uint64_t at = span | (first << shift);
+                best = std::min(best, at > base ? at : base);
+            }
+        }
+        /* The overflow list is refiled at the next top-level span at the
+           earliest; only scan it when every level is empty until then. */
+        constexpr unsigned shift = levels * slot_bits;
+        constexpr uint64_t top = (uint64_t{1} << shift) - 1;
+        const uint64_t boundary = (base + top) & ~top;
+        if (overflow_.empty() || best <= boundary) {
+            return best;
+        }
+        uint64_t earliest = ~uint64_t{0};
+        for (const detail::timer_link* n = overflow_.next; n != &overflow_;
+             n = n->next) {
+            const uint64_t d = static_cast<const timer*>(n)->deadline_;
+            earliest = d < earliest ? d : earliest;
+        }
+        const uint64_t at = (earliest >> shift) << shift;
+        return std::min(best, at > base ? at : base);
+    }
+
+    static inline void detach(detail::timer_link& list) noexcept {
+        while (!list.empty()) {
+            timer& t = static_cast<timer&>(*list.next);
+            t.unlink();
+            t.wheel_ = nullptr;
+        }
+    }
+
+    detail::timer_link slots_[levels * slots]; /**< Slot sentinels, by level */
+    detail::timer_link overflow_;              /**< Beyond the top level */
+    uint64_t occupied_[levels] = {};           /**< Non-empty slots, by level */
+    uint64_t now_;                             /**< Last processed tick */
+    std::size_t size_ = 0;                     /**< Armed timers */
+};
+
+inline void timer::cancel() noexcept {
+    if (wheel_ != nullptr) {
+        wheel_->cancel(*this);
+    }
+}
+
+/* ------------------------------------------------------------ */
+/* Machine policies                                             */
+/* ------------------------------------------------------------ */
+/**
+ * @brief Timers policy of machines without timeouts (the default).
+ *
+ * Adds no storage and no work to dispatch; `add_timeout()` entries are
+ * recorded but never fire.
+ */
+struct no_timers {
+    static constexpr bool enabled = false;
+};
+
+/**
+ * @brief Timers policy of machines whose timeouts run on a `timing_wheel`.
+ *
+ * The wheel refers to the machine, so a machine with this policy can be
+ * neither copied nor moved.
+ */
+struct wheel_timers {
+    static constexpr bool enabled = true;
+};
+
+namespace detail {
+
+/**
+ * @brief What a machine keeps for its timeouts: nothing unless enabled.
+ *
+ * @tparam Slots Timer storage (one `timer`, or one per instance).
+ */
+template <bool Enabled, class Context, class Slots>
+struct timer_hook {};
+
+template <class Context, class Slots>
+struct timer_hook<true, Context, Slots> {
+    timer_hook() = default;
+    timer_hook(const timer_hook&) = delete;
+    timer_hook& operator=(const timer_hook&) = delete;
+
+    Slots timers{};                 /**< Armed while a timeout is pending */
+    timing_wheel* wheel = nullptr;  /**< Attached wheel, or nullptr */
+    Context* ctx = nullptr;         /**< Context for timeout actions */
+};
+
+} /* namespace detail */
+
+} /* namespace fsm */
+
+#endif /* FSM_TIMING_WHEEL_HPP */
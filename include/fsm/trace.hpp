@@ -0,0 +1,338 @@
+/**
+ * @file trace.hpp
+ * @brief Lock-free binary trace ring buffer of dispatched transitions.
+ *
+ * `fsm::trace_ring` keeps the last `Capacity` dispatches of a machine as
+ * fixed-size 24-byte records `{timestamp, src, ev, dst, result}`.  One
+ * thread writes (the thread dispatching the machine, or the owner of a
+ * thread-local ring); any thread may read concurrently.  Each slot is a
+ * small seqlock built from relaxed atomic words, so writing is a handful
+ * of plain stores and readers simply skip slots that are being
+ * overwritten.
+ *
+ * `fsm::tracing_instrumentation` plugs a per-machine ring into
+ * `fsm::runtime` through the instrumentation policy (see
+ * instrumentation.hpp); `fsm::thread_tracing_instrumentation` writes to a
+ * per-thread ring instead.  Traces can be iterated, serialised with
+ * `dump()` for the `fsm_trace` timeline tool, parsed back with
+ * `parse_trace()`, and folded into per-transition edge counts for
+ * `definition::to_dot(edge_counts)`.
+ *
+ * Timestamps come from `detail::cycle_count()` (the TSC on x86).  State
+ * and event values are stored as their underlying integers truncated to
+ * 32 bits, like the composite lookup key.
+ */
+
+#ifndef FSM_TRACE_HPP
+#define FSM_TRACE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fsm/definition.hpp>
+#include <fsm/instrumentation.hpp>
+
+namespace fsm {
+
+/**
+ * @brief One dispatched event as stored in a trace.
+ */
+struct trace_record {
+    uint64_t timestamp; /**< detail::cycle_count() at dispatch */
+    uint32_t src;       /**< Source state (underlying value) */
+    uint32_t ev;        /**< Event (underlying value) */
+    uint32_t dst;       /**< Destination state; equals src on failure */
+    result   outcome;   /**< Dispatch result */
+};
+
+static_assert(sizeof(trace_record) == 24 &&
+              std::is_trivially_copyable_v<trace_record>,
+              "trace_record must stay a fixed-size binary record");
+
+/**
+ * @brief Header of a serialised trace (`trace_ring::dump()`).
+ *
+ * Followed by `count` `trace_record`s, oldest first, in host byte order.
+ */
+struct trace_header {
+    char     magic[8];    /**< "FSMTRACE" */
+    uint32_t version;     /**< Format version, currently 1 */
+    uint32_t record_size; /**< sizeof(trace_record) */
+    uint64_t count;       /**< Number of records that follow */
+};
+
+inline constexpr char trace_magic[8] = { 'F', 'S', 'M', 'T', 'R', 'A', 'C', 'E' };
+inline constexpr uint32_t trace_version = 1;
+
+/**
+ * @brief Single-writer, multi-reader overwrite ring of trace records.
+ *
+ * @tparam Capacity Number of records kept; must be a power of two.
+ */
+template <std::size_t Capacity>
+class trace_ring {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "trace_ring capacity must be a power of two");
+
+public:
+    trace_ring() noexcept = default;
+    trace_ring(const trace_ring&) = delete;
+    trace_ring& operator=(const trace_ring&) = delete;
+
+    /* ------------------------------------------------------------ */
+    /* Writer side (one thread)                                     */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Append a record, overwriting the oldest one when full.
+     */
+    inline void push(const trace_record& r) noexcept {
+        const uint64_t pos = head_.load(std::memory_order_relaxed);
+        slot& s = slots_[pos & mask];
+        s.seq.store(2 * pos + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.words[0].store(r.timestamp, std::memory_order_relaxed);
+        s.words[1].store(r.src | (static_cast<uint64_t>(r.ev) << 32),
+                         std::memory_order_relaxed);
+        s.words[2].store(r.dst | (static_cast<uint64_t>(r.outcome) << 32),
+                         std::memory_order_relaxed);
+        s.seq.store(2 * pos + 2, std::memory_order_release);
+        head_.store(pos + 1, std::memory_order_release);
+    }
+
+    /** @brief Record a dispatch of `(src, ev)` with its outcome. */
+    template <class State, class Event>
+    inline void record(State src, Event ev, State dst, result r) noexcept {
+        push({ detail::cycle_count(), narrow(src), narrow(ev), narrow(dst), r });
+    }
+
+    /* ------------------------------------------------------------ */
+    /* Reader side (any thread)                                     */
+    /* ------------------------------------------------------------ */
+    /**
+     * @brief Visit the retained records, oldest first.
+     *
+     * Records overwritten while iterating are skipped, so a concurrent
+     * reader sees a consistent, possibly shorter, suffix of the trace.
+     *
+     * @param f Callable invoked as `f(const trace_record&)`.
+     */
+    template <class F>
+    inline void for_each(F&& f) const {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        const uint64_t first = head > Capacity ? head - Capacity : 0;
+        for (uint64_t pos = first; pos < head; ++pos) {
+            const slot& s = slots_[pos & mask];
+            const uint64_t seq = s.seq.load(std::memory_order_acquire);
+            if (seq != 2 * pos + 2) {
+                continue;
+            }
+            const uint64_t w0 = s.words[0].load(std::memory_order_relaxed);
+            const uint64_t w1 = s.words[1].load(std::memory_order_relaxed);
+            const uint64_t w2 = s.words[2].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) != seq) {
+                continue;
+            }
+            f(trace_record{ w0, static_cast<uint32_t>(w1),
+                            static_cast<uint32_t>(w1 >> 32),
+                            static_cast<uint32_t>(w2),
+                            static_cast<result>(w2 >> 32) });
+        }
+    }
+
+    /** @brief Copy of the retained records, oldest first. */
+    inline std::vector<trace_record> records() const {
+        std::vector<trace_record> out;
+        out.reserve(size());
+        for_each([&out](const trace_record& r) { out.push_back(r); });
+        return out;
+    }
+
+    /**
+     * @brief Serialise the retained records (header + records).
+     * @return Binary blob suitable for a file read by `fsm_trace`.
+     */
+    inline std::string dump() const {
+        const auto recs = records();
+        trace_header h{};
+        std::memcpy(h.magic, trace_magic, sizeof(h.magic));
+        h.version = trace_version;
+        h.record_size = sizeof(trace_record);
+        h.count = recs.size();
+        std::string out(sizeof(h) + recs.size() * sizeof(trace_record), '\0');
+        std::memcpy(out.data(), &h, sizeof(h));
+        if (!recs.empty()) {
+            std::memcpy(out.data() + sizeof(h), recs.data(),
+                        recs.size() * sizeof(trace_record));
+        }
+        return out;
+    }
+
+    /** @brief Number of records written since construction/clear. */
+    inline uint64_t written() const noexcept {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    /** @brief Number of records currently retained. */
+    inline std::size_t size() const noexcept {
+        const uint64_t n = written();
+        return n < Capacity ? static_cast<std::size_t>(n) : Capacity;
+    }
+
+    /** @brief Number of records kept. */
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+    /** @brief Forget every record; must not race with `push`. */
+    inline void clear() noexcept {
+        head_.store(0, std::memory_order_release);
+        for (auto& s : slots_) {
+            s.seq.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    static constexpr std::size_t mask = Capacity - 1;
+
+    template <class T>
+    static constexpr uint32_t narrow(T v) noexcept {
+        return static_cast<uint32_t>(
+            static_cast<uint64_t>(detail::underlying(v)) & 0xFFFFFFFFULL);
+    }
+
+    /* Seqlock slot: seq is odd while being written, 2*pos+2 once done. */
+    struct slot {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<uint64_t> words[3] = {};
+    };
+
+    alignas(64) std::atomic<uint64_t> head_{0}; /**< Records written */
+    slot slots_[Capacity];                      /**< Ring storage */
+};
+
+/**
+ * @brief Instrumentation policy recording every dispatch into a ring.
+ *
+ * @tparam Capacity Records retained; must be a power of two.
+ */
+template <std::size_t Capacity = 4096>
+class tracing_instrumentation {
+public:
+    static constexpr bool enabled = true;
+    static constexpr bool timing = false;
+
+    inline void resize(std::size_t) noexcept {}
+
+    template <class State, class Event>
+    inline void on_dispatch(std::size_t, State src, Event ev, State dst,
+                            result r) noexcept {
+        ring_.record(src, ev, dst, r);
+    }
+
+    /** @brief The trace (iterate, dump or clear it). */
+    inline const trace_ring<Capacity>& trace() const noexcept { return ring_; }
+    inline trace_ring<Capacity>& trace() noexcept { return ring_; }
+
+private:
+    trace_ring<Capacity> ring_; /**< Dispatch records */
+};
+
+/**
+ * @brief Instrumentation policy recording into the calling thread's ring.
+ *
+ * Every machine using this policy on a given thread shares that thread's
+ * ring, so a machine costs no extra storage and a thread's trace shows
+ * all of its machines interleaved.
+ *
+ * @tparam Capacity Records retained per thread; must be a power of two.
+ */
+template <std::size_t Capacity = 4096>
+struct thread_tracing_instrumentation {
+    static constexpr bool enabled = true;
+    static constexpr bool timing = false;
+
+    inline void resize(std::size_t) noexcept {}
+
+    template <class State, class Event>
+    inline void on_dispatch(std::size_t, State src, Event ev, State dst,
+                            result r) noexcept {
+        local().record(src, ev, dst, r);
+    }
+
+    /**
+     * @brief The calling thread's ring.  The reference may be handed to
+     *        other threads for reading while this thread is alive.
+     */
+    static inline trace_ring<Capacity>& local() noexcept {
+        thread_local trace_ring<Capacity> ring;
+        return ring;
+    }
+};
+
+/**
+ * @brief Parse a blob produced by `trace_ring::dump()`.
+ *
+ * @param data Serialised trace.
+ * @param out  Receives the records, oldest first.
+ * @return `false` if the header or length is invalid.
+ */
+inline bool parse_trace(std::span<const char> data,
+                        std::vector<trace_record>& out) {
+    trace_header h;
+    if (data.size() < sizeof(h)) {
+        return false;
+    }
+    std::memcpy(&h, data.data(), sizeof(h));
+    if (std::memcmp(h.magic, trace_magic, sizeof(h.magic)) != 0
+        || h.version != trace_version
+        || h.record_size != sizeof(trace_record)
+        || h.count > (data.size() - sizeof(h)) / sizeof(trace_record)) {
+        return false;
+    }
+    out.resize(static_cast<std::size_t>(h.count));
+    if (h.count != 0) {
+        std::memcpy(out.data(), data.data() + sizeof(h),
+                    out.size() * sizeof(trace_record));
+    }
+    return true;
+}
+
+/**
+ * @brief Count successful dispatches per transition of a definition.
+ *
+ * The result is indexed by transition ordinal and can be passed to
+ * `definition::to_dot(edge_counts)` to overlay real edge frequencies.
+ *
+ * @param def     Definition the trace was recorded against.
+ * @param records Trace records.
+ */
+template <class State, class Event, class Context>
+inline std::vector<uint64_t>
+edge_counts(const definition<State, Event, Context>& def,
+            std::span<const trace_record> records) {
+    std::vector<uint64_t> counts(def.size(), 0);
+    const auto* base = def.transitions().data();
+    for (const auto& r : records) {
+        if (r.outcome != result::Ok) {
+            continue;
+        }
+        /* Among several candidates, the one that led to `dst`. */
+        for (const auto& tr : def.candidates(static_cast<State>(r.src),
+                                             static_cast<Event>(r.ev))) {
+            if (static_cast<uint32_t>(detail::underlying(tr.dst)) == r.dst) {
+                ++counts[static_cast<std::size_t>(&tr - base)];
+                break;
+            }
+        }
+    }
+    return counts;
+}
+
+} /* namespace fsm */
+
+#endif /* FSM_TRACE_HPP */
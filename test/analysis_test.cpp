@@ -0,0 +1,127 @@
+#include <fsm/analysis.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+
+enum class State { Idle, Running, Done, Orphan, Ghost, Count };
+enum class Event { Start, Stop, Finish, Reset, Unused, Count };
+
+} // namespace
+
+template <>
+struct fsm::enum_count<State> {
+    static constexpr auto value = static_cast<std::size_t>(State::Count);
+};
+
+template <>
+struct fsm::enum_count<Event> {
+    static constexpr auto value = static_cast<std::size_t>(Event::Count);
+};
+
+namespace {
+
+using Def = fsm::definition<State, Event>;
+using Report = fsm::analysis_report<State, Event>;
+
+bool has(const std::vector<State>& v, State s) {
+    for (const State x : v) {
+        if (x == s) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+TEST_CASE("flat table: reachability, sinks, unhandled events, overwrites", "[fsm][analysis]") {
+    Def def;
+    def.add_transition({ State::Idle, Event::Start, State::Done, nullptr, nullptr });
+    def.add_transition({ State::Idle, Event::Start, State::Running, nullptr, nullptr });
+    def.add_transition({ State::Running, Event::Stop, State::Idle, nullptr, nullptr });
+    def.add_transition({ State::Running, Event::Finish, State::Done, nullptr, nullptr });
+    def.add_transition({ State::Done, Event::Finish, State::Done, nullptr, nullptr });
+    def.add_transition({ State::Orphan, Event::Reset, State::Idle, nullptr, nullptr });
+
+    const Report r = fsm::analyze(def, State::Idle);
+    REQUIRE(r.reachable == std::vector<State>{ State::Idle, State::Running, State::Done });
+    REQUIRE(r.unreachable == std::vector<State>{ State::Orphan, State::Ghost });
+    /* Done only loops on itself; Ghost has no transitions at all. */
+    REQUIRE(r.sinks == std::vector<State>{ State::Done, State::Ghost });
+    REQUIRE(r.unhandled == std::vector<Event>{ Event::Unused });
+    REQUIRE(r.shadowed.size() == 1);
+    REQUIRE(r.shadowed[0].src == State::Idle);
+    REQUIRE(r.shadowed[0].ev == Event::Start);
+    REQUIRE(r.shadowed[0].lost == State::Done);
+    REQUIRE(r.shadowed[0].dst == State::Running);
+    REQUIRE(r.state_bound == 3);
+    REQUIRE(r.event_bound == 4);
+    REQUIRE_FALSE(r.clean());
+
+    /* The same answers once frozen. */
+    def.freeze();
+    const Report frozen = fsm::analyze(def, State::Idle);
+    REQUIRE(frozen.reachable == r.reachable);
+    REQUIRE(frozen.shadowed.size() == 1);
+}
+
+TEST_CASE("inherited, wildcard, default and timeout edges", "[fsm][analysis]") {
+    Def def;
+    /* Running nests in Idle and overrides its Stop transition. */
+    def.set_parent(State::Running, State::Idle);
+    def.add_transition({ State::Idle, Event::Stop, State::Orphan, nullptr, nullptr });
+    def.add_transition({ State::Idle, Event::Finish, State::Done, nullptr, nullptr });
+    def.add_transition({ State::Running, Event::Stop, State::Running, nullptr, nullptr });
+
+    Report r = fsm::analyze(def, State::Running);
+    REQUIRE(r.reachable == std::vector<State>{ State::Running, State::Done });
+    REQUIRE(has(r.unreachable, State::Orphan));
+    REQUIRE(has(r.unreachable, State::Idle));
+
+    def.add_any_state(Event::Reset, State::Idle);
+    r = fsm::analyze(def, State::Running);
+    REQUIRE(has(r.reachable, State::Idle));
+    REQUIRE(has(r.reachable, State::Orphan)); /* Idle's own Stop */
+    REQUIRE_FALSE(has(r.sinks, State::Done));  /* Reset leaves it */
+
+    def.add_timeout(State::Orphan, 10, State::Ghost);
+    def.add_default(State::Ghost, State::Idle);
+    r = fsm::analyze(def, State::Running);
+    REQUIRE(r.unreachable.empty());
+    REQUIRE(r.sinks.empty());
+    REQUIRE(r.unhandled.empty()); /* a default handles every event */
+    REQUIRE(r.clean());
+}
+
+TEST_CASE("uncounted types take their event universe from the caller", "[fsm][analysis]") {
+    fsm::definition<int, int> def;
+    def.add_transition({ 10, 1, 20, nullptr, nullptr });
+    def.add_transition({ 20, 2, 10, nullptr, nullptr });
+    def.add_transition({ 30, 3, 10, nullptr, nullptr });
+
+    REQUIRE(fsm::analyze(def, 10).unhandled.empty());
+    const int events[] = { 1, 2, 3, 4 };
+    const auto r = fsm::analyze(def, 10, events);
+    REQUIRE(r.unhandled == std::vector<int>{ 4 });
+    REQUIRE(r.reachable == std::vector<int>{ 10, 20 });
+    REQUIRE(r.unreachable == std::vector<int>{ 30 });
+    REQUIRE(r.state_bound == 21);
+}
+
+TEST_CASE("large generated tables analyse in one pass", "[fsm][analysis]") {
+    constexpr int states = 50000;
+    fsm::definition<int, int> def;
+    def.reserve(4 * states);
+    for (int s = 0; s < states; ++s) {
+        for (int e = 0; e < 4; ++e) {
+            /* Even states only reach even states; odd ones are unreachable. */
+            def.add_transition({ s, e, (s + 2 * (e + 1)) % states, nullptr, nullptr });
+        }
+    }
+    const auto r = fsm::analyze(def, 0);
+    REQUIRE(r.reachable.size() == states / 2);
+    REQUIRE(r.unreachable.size() == states / 2);
+    REQUIRE(r.sinks.empty());
+}
@@ -0,0 +1,198 @@
+#include <fsm/async_runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace {
+
+enum class State { Idle, Sending, Sent, Failed };
+enum class Event { Send, Ack, Cancel };
+
+/* Single-threaded stand-in for an I/O reactor: suspended coroutines wait
+   here until the test runs them. */
+struct loop {
+    std::vector<std::coroutine_handle<>> ready;
+
+    auto io() {
+        struct awaiter {
+            loop& l;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { l.ready.push_back(h); }
+            void await_resume() const noexcept {}
+        };
+        return awaiter{ *this };
+    }
+
+    std::size_t run() {
+        std::size_t n = 0;
+        while (!ready.empty()) {
+            std::vector<std::coroutine_handle<>> batch;
+            batch.swap(ready);
+            for (auto h : batch) {
+                h.resume();
+                ++n;
+            }
+        }
+        return n;
+    }
+};
+
+struct Context {
+    loop* io = nullptr;
+    int sent = 0;
+    int acks = 0;
+    bool online = true;
+};
+
+fsm::task send_packet(Context& c) {
+    co_await c.io->io();
+    ++c.sent;
+}
+
+fsm::task send_twice(Context& c) {
+    co_await send_packet(c);
+    co_await send_packet(c);
+}
+
+using FSM = fsm::async_runtime<State, Event, Context>;
+
+void populate(FSM& sm) {
+    sm.add_async_transition(State::Idle, Event::Send, State::Sending,
+                            [](const Context& c) { return c.online; }, &send_packet);
+    sm.add_transition({ State::Sending, Event::Ack, State::Sent, nullptr,
+                        [](Context& c) { ++c.acks; } });
+    sm.add_transition({ State::Sending, Event::Cancel, State::Idle, nullptr, nullptr });
+}
+
+} // namespace
+
+TEST_CASE("async actions keep the machine busy and queue events", "[fsm][async]") {
+    loop l;
+    Context ctx{ &l };
+    FSM sm(State::Idle, ctx);
+    populate(sm);
+
+    sm.post(Event::Send);
+    REQUIRE(sm.busy());
+    REQUIRE(sm.current() == State::Idle);
+    sm.post(Event::Ack);
+    REQUIRE(sm.pending() == 1);
+    REQUIRE(ctx.acks == 0);
+
+    REQUIRE(l.run() == 1);
+    REQUIRE_FALSE(sm.busy());
+    REQUIRE(sm.pending() == 0);
+    REQUIRE(ctx.sent == 1);
+    REQUIRE(ctx.acks == 1);
+    REQUIRE(sm.current() == State::Sent);
+}
+
+TEST_CASE("synchronous transitions behave like runtime", "[fsm][async]") {
+    loop l;
+    Context ctx{ &l };
+    FSM sm(State::Sending, ctx);
+    populate(sm);
+    sm.freeze();
+
+    sm.post(Event::Send);
+    REQUIRE_FALSE(sm.busy());
+    REQUIRE(sm.current() == State::Sending);
+    sm.post(Event::Cancel);
+    REQUIRE(sm.current() == State::Idle);
+
+    ctx.online = false;
+    sm.post(Event::Send);
+    REQUIRE_FALSE(sm.busy());
+    REQUIRE(sm.current() == State::Idle);
+    REQUIRE(l.ready.empty());
+}
+
+TEST_CASE("co_await dispatch resumes after the action completes", "[fsm][async]") {
+    loop l;
+    Context ctx{ &l };
+    FSM sm(State::Idle, ctx);
+    sm.add_async_transition(State::Idle, Event::Send, State::Sending, nullptr, &send_twice);
+    sm.add_transition({ State::Sending, Event::Ack, State::Sent, nullptr, nullptr });
+
+    std::vector<fsm::result> results;
+    auto driver = [](FSM& m, std::vector<fsm::result>& out) -> fsm::task {
+        out.push_back(co_await m.dispatch(Event::Send));
+        out.push_back(co_await m.dispatch(Event::Ack));
+        out.push_back(co_await m.dispatch(Event::Ack));
+    };
+    fsm::task t = driver(sm, results);
+    t.start();
+    REQUIRE(results.empty());
+    REQUIRE(sm.busy());
+
+    REQUIRE(l.run() == 2);
+    REQUIRE(t.done());
+    REQUIRE(results == std::vector<fsm::result>{ fsm::result::Ok, fsm::result::Ok,
+                                                 fsm::result::NoTransition });
+    REQUIRE(ctx.sent == 2);
+    REQUIRE(sm.current() == State::Sent);
+}
+
+TEST_CASE("next_event observes processed events", "[fsm][async]") {
+    loop l;
+    Context ctx{ &l };
+    FSM sm(State::Idle, ctx);
+    populate(sm);
+
+    std::vector<FSM::record> seen;
+    auto watcher = [](FSM& m, std::vector<FSM::record>& out) -> fsm::task {
+        for (int i = 0; i < 3; ++i) {
+            out.push_back(co_await m.next_event());
+        }
+    };
+    fsm::task w = watcher(sm, seen);
+    w.start();
+
+    sm.post(Event::Send);
+    sm.post(Event::Cancel);
+    sm.post(Event::Ack);
+    REQUIRE(seen.empty());
+    l.run();
+    REQUIRE(w.done());
+    REQUIRE(seen.size() == 3);
+    REQUIRE(seen[0].from == State::Idle);
+    REQUIRE(seen[0].to == State::Sending);
+    REQUIRE(seen[1].ev == Event::Cancel);
+    REQUIRE(seen[1].to == State::Idle);
+    REQUIRE(seen[2].result == fsm::result::NoTransition);
+}
+
+TEST_CASE("one thread multiplexes many suspended machines", "[fsm][async]") {
+    loop l;
+    std::vector<Context> ctxs(2000, Context{ &l });
+    std::vector<std::unique_ptr<FSM>> machines;
+    for (auto& c : ctxs) {
+        machines.push_back(std::make_unique<FSM>(State::Idle, c));
+        populate(*machines.back());
+        machines.back()->post(Event::Send);
+        machines.back()->post(Event::Ack);
+    }
+    REQUIRE(l.ready.size() == machines.size());
+    REQUIRE(l.run() == machines.size());
+    for (std::size_t i = 0; i < machines.size(); ++i) {
+        REQUIRE(machines[i]->current() == State::Sent);
+        REQUIRE(ctxs[i].sent == 1);
+    }
+}
+
+TEST_CASE("void context async actions", "[fsm][async]") {
+    static loop l;
+    static int done = 0;
+    fsm::async_runtime<int, int> sm(0);
+    sm.add_async_transition(0, 0, 1, nullptr, []() -> fsm::task {
+        co_await l.io();
+        ++done;
+    });
+    sm.post(0);
+    REQUIRE(sm.busy());
+    l.run();
+    REQUIRE(done == 1);
+    REQUIRE(sm.current() == 1);
+}
@@ -0,0 +1,107 @@
+#include <fsm/atomic_runtime.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum class State { Idle, Running, Done };
+enum class Event { Start, Stop, Finish };
+
+struct Context {
+    bool ready = true;
+    int started = 0;
+};
+
+template <class Machine>
+void populate(Machine& sm) {
+    sm.add_transition({ State::Idle, Event::Start, State::Running,
+        [](const Context& c) { return c.ready; },
+        [](Context& c) { ++c.started; } });
+    sm.add_transition({ State::Running, Event::Stop, State::Idle, nullptr, nullptr });
+    sm.add_transition({ State::Running, Event::Finish, State::Done, nullptr, nullptr });
+}
+
+constexpr uint32_t ring = 7;
+
+/* Ring of `ring` states; every Tick moves to the next and counts itself. */
+std::atomic<uint64_t> ticks{ 0 };
+
+void count_tick() { ticks.fetch_add(1, std::memory_order_relaxed); }
+
+} // namespace
+
+TEST_CASE("atomic_runtime matches runtime single-threaded", "[fsm][atomic]") {
+    fsm::atomic_runtime<State, Event, Context> a(State::Idle);
+    fsm::runtime<State, Event, Context> r(State::Idle);
+    populate(a);
+    populate(r);
+    a.freeze();
+
+    Context ca, cr;
+    ca.ready = cr.ready = false;
+    REQUIRE(a.dispatch(Event::Start, ca) == fsm::result::GuardRejected);
+    REQUIRE(r.dispatch(Event::Start, cr) == fsm::result::GuardRejected);
+    ca.ready = cr.ready = true;
+    for (Event ev : { Event::Start, Event::Start, Event::Stop, Event::Start, Event::Finish }) {
+        REQUIRE(a.dispatch(ev, ca) == r.dispatch(ev, cr));
+        REQUIRE(a.current() == r.current());
+    }
+    REQUIRE(ca.started == cr.started);
+    REQUIRE(a.memory_usage().per_instance == sizeof(std::atomic<State>));
+
+    a.reset(State::Idle);
+    REQUIRE(a.current() == State::Idle);
+}
+
+TEST_CASE("dispatch_from commits only from the expected state", "[fsm][atomic]") {
+    fsm::atomic_runtime<State, Event, Context> sm(State::Idle);
+    populate(sm);
+    Context ctx;
+    fsm::result r{};
+
+    State expected = State::Running;
+    REQUIRE_FALSE(sm.dispatch_from(expected, Event::Stop, ctx, r));
+    REQUIRE(expected == State::Idle);
+    REQUIRE(sm.current() == State::Idle);
+
+    REQUIRE(sm.dispatch_from(expected, Event::Stop, ctx, r));
+    REQUIRE(r == fsm::result::NoTransition);
+    REQUIRE(sm.dispatch_from(expected, Event::Start, ctx, r));
+    REQUIRE(r == fsm::result::Ok);
+    REQUIRE(sm.current() == State::Running);
+    REQUIRE(ctx.started == 1);
+}
+
+TEST_CASE("concurrent dispatch commits every transition once", "[fsm][atomic]") {
+    fsm::atomic_runtime<uint32_t, int> sm(0);
+    for (uint32_t s = 0; s < ring; ++s) {
+        REQUIRE(sm.add_transition({ s, 0, (s + 1) % ring, nullptr, &count_tick }));
+    }
+    sm.freeze();
+    ticks = 0;
+
+    constexpr int threads = 4;
+    constexpr int per_thread = 20000;
+    std::atomic<int> ok{ 0 };
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&] {
+            for (int i = 0; i < per_thread; ++i) {
+                if (sm.dispatch(0) == fsm::result::Ok) {
+                    ok.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+    REQUIRE(ok == threads * per_thread);
+    REQUIRE(ticks == uint64_t{ threads } * per_thread);
+    REQUIRE(sm.current() == (threads * per_thread) % ring);
+    REQUIRE(sm.dispatch(1) == fsm::result::NoTransition);
+}
@@ -0,0 +1,127 @@
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <ranges>
+#include <vector>
+
+namespace {
+
+enum class State : uint32_t { Idle, Running, Done, Count };
+enum class Event : uint32_t { Start, Stop, Finish, Count };
+
+} // namespace
+
+template <>
+struct fsm::enum_count<State> {
+    static constexpr auto value = static_cast<std::size_t>(State::Count);
+};
+
+template <>
+struct fsm::enum_count<Event> {
+    static constexpr auto value = static_cast<std::size_t>(Event::Count);
+};
+
+namespace {
+
+struct Context {
+    int started = 0;
+};
+
+using FSM = fsm::runtime<State, Event, Context>;
+using Transition = FSM::Transition;
+
+} // namespace
+
+TEST_CASE("add_transitions matches repeated add_transition", "[fsm][bulk]") {
+    const std::vector<Transition> table = {
+        { State::Idle, Event::Start, State::Running, nullptr,
+          [](Context& c) { ++c.started; } },
+        { State::Running, Event::Stop, State::Idle, nullptr, nullptr },
+        { State::Running, Event::Finish, State::Done, nullptr, nullptr },
+    };
+    FSM one(State::Idle);
+    FSM bulk(State::Idle);
+    for (const Transition& tr : table) {
+        REQUIRE(one.add_transition(tr));
+    }
+    const fsm::bulk_report r = bulk.add_transitions(table);
+    REQUIRE(r.added == 3);
+    REQUIRE(r.clean());
+    REQUIRE(bulk.size() == one.size());
+    REQUIRE(table[0].action); /* copied from an lvalue range */
+
+    Context c1, c2;
+    for (Event ev : { Event::Start, Event::Stop, Event::Start, Event::Finish }) {
+        REQUIRE(bulk.dispatch(ev, c2) == one.dispatch(ev, c1));
+    }
+    REQUIRE(bulk.current() == State::Done);
+    REQUIRE(c2.started == 2);
+}
+
+TEST_CASE("duplicates are reported and optionally kept", "[fsm][bulk]") {
+    fsm::definition<State, Event> def;
+    REQUIRE(def.add_transition({ State::Idle, Event::Start, State::Running, nullptr, nullptr }));
+
+    std::vector<std::size_t> at;
+    const auto kept = def.add_transitions(
+        { { State::Running, Event::Stop, State::Idle, nullptr, nullptr },
+          { State::Idle, Event::Start, State::Done, nullptr, nullptr },
+          { State::Count, Event::Stop, State::Idle, nullptr, nullptr },
+          { State::Running, Event::Stop, State::Done, nullptr, nullptr } },
+        fsm::on_duplicate::Keep, &at);
+    REQUIRE(kept.added == 1);
+    REQUIRE(kept.duplicates == 2);
+    REQUIRE(kept.rejected == 1);
+    REQUIRE_FALSE(kept.clean());
+    REQUIRE(at == std::vector<std::size_t>{ 1, 3 });
+    REQUIRE(def.size() == 2);
+    REQUIRE(def.find(State::Idle, Event::Start)->dst == State::Running);
+    REQUIRE(def.find(State::Running, Event::Stop)->dst == State::Idle);
+
+    const auto over = def.add_transitions(
+        { { State::Idle, Event::Start, State::Done, nullptr, nullptr } });
+    REQUIRE(over.duplicates == 1);
+    REQUIRE(def.size() == 2);
+    REQUIRE(def.find(State::Idle, Event::Start)->dst == State::Done);
+
+    def.freeze();
+    REQUIRE(def.add_transitions(
+        { { State::Done, Event::Stop, State::Idle, nullptr, nullptr } }).rejected == 1);
+}
+
+TEST_CASE("an overwritten key drops its candidate list", "[fsm][bulk]") {
+    FSM sm(State::Idle);
+    REQUIRE(sm.append_transition({ State::Idle, Event::Start, State::Running,
+                                   [](const Context& c) { return c.started > 0; }, nullptr }));
+    REQUIRE(sm.append_transition({ State::Idle, Event::Start, State::Done, nullptr, nullptr }));
+    REQUIRE(sm.size() == 2);
+
+    const auto r = sm.add_transitions(
+        { { State::Idle, Event::Start, State::Running, nullptr,
+            [](Context& c) { ++c.started; } },
+          { State::Running, Event::Stop, State::Idle, nullptr, nullptr } });
+    REQUIRE(r.added == 1);
+    REQUIRE(r.duplicates == 1);
+    REQUIRE(sm.size() == 2);
+    REQUIRE(sm.table().candidates(State::Idle, Event::Start).size() == 1);
+
+    Context ctx;
+    REQUIRE(sm.dispatch(Event::Start, ctx) == fsm::result::Ok);
+    REQUIRE(sm.current() == State::Running);
+    REQUIRE(ctx.started == 1);
+}
+
+TEST_CASE("reserve and unsized ranges", "[fsm][bulk]") {
+    fsm::definition<int, int> def;
+    def.reserve(64);
+    REQUIRE(def.memory_usage().cold >= 64 * sizeof(fsm::definition<int, int>::Transition));
+
+    auto edges = std::views::iota(0, 64)
+               | std::views::filter([](int) { return true; })
+               | std::views::transform([](int i) {
+                     return fsm::definition<int, int>::Transition{ i, 0, i + 1, nullptr, nullptr };
+                 });
+    REQUIRE(def.add_transitions(edges).added == 64);
+    def.freeze();
+    REQUIRE(def.find(63, 0)->dst == 64);
+}
@@ -0,0 +1,88 @@
+#include <fsm/bulk_machine.hpp>
+#include <fsm/definition.hpp>
+#include <fsm/instance.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+enum class Device : uint8_t { Idle, Sampling, Fault };
+enum class Tick : uint8_t { Sample, Fail, Reset };
+
+struct Context {
+    int faults = 0;
+    bool allow_reset = true;
+};
+
+using Bulk = fsm::bulk_machine<Device, Tick, 3, 3, Context>;
+
+} // namespace
+
+TEST_CASE("bulk machine picks the narrowest state storage", "[fsm][bulk]") {
+    STATIC_REQUIRE(std::is_same_v<Bulk::index_type, uint8_t>);
+    STATIC_REQUIRE(std::is_same_v<
+        fsm::bulk_machine<int, int, 1000, 2>::index_type, uint16_t>);
+}
+
+TEST_CASE("bulk machine broadcasts pure and guarded events", "[fsm][bulk]") {
+    fsm::definition<Device, Tick, Context> def;
+    def.add_transition({ Device::Idle, Tick::Sample, Device::Sampling, nullptr, nullptr });
+    def.add_transition({ Device::Sampling, Tick::Sample, Device::Idle, nullptr, nullptr });
+    def.add_transition({ Device::Sampling, Tick::Fail, Device::Fault, nullptr,
+        [](Context& c) { ++c.faults; } });
+    def.add_transition({ Device::Fault, Tick::Reset, Device::Idle,
+        [](const Context& c) { return c.allow_reset; }, nullptr });
+    def.freeze();
+
+    Bulk bulk(def, 1000, Device::Idle);
+    Context ctx;
+    bulk.dispatch_all(Tick::Sample, ctx);
+    for (std::size_t i = 0; i < bulk.size(); ++i) {
+        REQUIRE(bulk.state(i) == Device::Sampling);
+    }
+
+    // Move half the instances back to Idle, then fail everything.
+    std::vector<std::size_t> ids;
+    std::vector<Tick> evs;
+    for (std::size_t i = 0; i < bulk.size(); i += 2) {
+        ids.push_back(i);
+        evs.push_back(Tick::Sample);
+    }
+    REQUIRE(bulk.dispatch_batch(ids, evs, ctx) == ids.size());
+    REQUIRE(bulk.dispatch_batch(ids, std::vector<Tick>(ids.size(), Tick::Reset), ctx) == 0);
+
+    bulk.dispatch_all(Tick::Fail, ctx);
+    REQUIRE(ctx.faults == 500);
+
+    ctx.allow_reset = false;
+    bulk.dispatch_all(Tick::Reset, ctx);
+    REQUIRE(bulk.state(1) == Device::Fault);
+    ctx.allow_reset = true;
+    bulk.dispatch_all(Tick::Reset, ctx);
+    for (std::size_t i = 0; i < bulk.size(); ++i) {
+        REQUIRE(bulk.state(i) == Device::Idle);
+    }
+}
+
+TEST_CASE("bulk machine matches per-instance dispatch", "[fsm][bulk]") {
+    fsm::definition<int, int> def;
+    for (int s = 0; s < 8; ++s) {
+        def.add_transition({ s, 0, (s + 1) % 8, nullptr, nullptr });
+        def.add_transition({ s, 1, (s * 3) % 8, nullptr, nullptr });
+    }
+    fsm::bulk_machine<int, int, 8, 3> bulk(def, 16, 0);
+    std::vector<fsm::instance<int, int>> ref(16, fsm::instance<int, int>(def, 0));
+
+    const int events[] = { 0, 0, 1, 2, 0, 1, 1, 0, 2, 0, 9 };
+    for (int ev : events) {
+        bulk.dispatch_all(ev);
+        for (auto& r : ref) {
+            r.dispatch(ev);
+        }
+    }
+    for (std::size_t i = 0; i < ref.size(); ++i) {
+        REQUIRE(bulk.state(i) == ref[i].current());
+    }
+}
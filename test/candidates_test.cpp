@@ -0,0 +1,132 @@
+#include <fsm/bulk_machine.hpp>
+#include <fsm/instrumentation.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+
+enum class State { Idle, Small, Large, Rejected, Count };
+enum class Event { Order, Reset, Count };
+
+} // namespace
+
+template <>
+struct fsm::enum_count<State> {
+    static constexpr auto value = static_cast<std::size_t>(State::Count);
+};
+
+template <>
+struct fsm::enum_count<Event> {
+    static constexpr auto value = static_cast<std::size_t>(Event::Count);
+};
+
+namespace {
+
+struct Context {
+    int amount = 0;
+};
+
+template <class Machine>
+void populate(Machine& sm) {
+    sm.append_transition({ State::Idle, Event::Order, State::Small,
+        [](const Context& c) { return c.amount > 0 && c.amount < 100; }, nullptr });
+    sm.append_transition({ State::Idle, Event::Order, State::Large,
+        [](const Context& c) { return c.amount >= 100; }, nullptr });
+    sm.append_transition({ State::Idle, Event::Order, State::Rejected, nullptr, nullptr });
+    sm.add_any_state(Event::Reset, State::Idle);
+}
+
+} // namespace
+
+TEST_CASE("candidates are tried in order with an unguarded else", "[fsm][candidates]") {
+    for (bool frozen : { false, true }) {
+        fsm::runtime<State, Event, Context> sm(State::Idle);
+        populate(sm);
+        if (frozen) {
+            sm.freeze();
+        }
+        REQUIRE(sm.size() == 4);
+        Context ctx;
+        for (const auto& [amount, expected] : std::vector<std::pair<int, State>>{
+                 { 5, State::Small }, { 500, State::Large }, { 0, State::Rejected } }) {
+            ctx.amount = amount;
+            REQUIRE(sm.dispatch(Event::Order, ctx) == fsm::result::Ok);
+            REQUIRE(sm.current() == expected);
+            REQUIRE(sm.dispatch(Event::Reset, ctx) == fsm::result::Ok);
+        }
+    }
+}
+
+TEST_CASE("all guards rejecting reports GuardRejected", "[fsm][candidates]") {
+    fsm::definition<State, Event, Context> def;
+    def.append_transition({ State::Idle, Event::Order, State::Small,
+        [](const Context& c) { return c.amount == 1; }, nullptr });
+    def.append_transition({ State::Idle, Event::Order, State::Large,
+        [](const Context& c) { return c.amount == 2; }, nullptr });
+    def.freeze();
+
+    Context ctx;
+    State s = State::Idle;
+    REQUIRE(def.dispatch(s, Event::Order, ctx) == fsm::result::GuardRejected);
+    REQUIRE(s == State::Idle);
+    ctx.amount = 2;
+    REQUIRE(def.dispatch(s, Event::Order, ctx) == fsm::result::Ok);
+    REQUIRE(s == State::Large);
+}
+
+TEST_CASE("candidate lists stay contiguous", "[fsm][candidates]") {
+    fsm::definition<State, Event, Context> def;
+    def.add_transition({ State::Idle, Event::Order, State::Small, nullptr, nullptr });
+    def.add_transition({ State::Small, Event::Order, State::Large, nullptr, nullptr });
+    def.add_any_state(Event::Reset, State::Idle);
+    /* Appending to an earlier key shifts the later ordinals. */
+    REQUIRE(def.append_transition({ State::Idle, Event::Order, State::Large, nullptr, nullptr }));
+
+    const auto c = def.candidates(State::Idle, Event::Order);
+    REQUIRE(c.size() == 2);
+    REQUIRE(c[0].dst == State::Small);
+    REQUIRE(c[1].dst == State::Large);
+    REQUIRE(def.ordinal(State::Small, Event::Order) == 2);
+    REQUIRE(def.ordinal(State::Large, Event::Reset) == 3);
+    REQUIRE(def.candidates(State::Large, Event::Order).empty());
+
+    /* Profile layout moves the list as a unit. */
+    const uint64_t hits[] = { 0, 1, 5, 0 };
+    REQUIRE(def.optimize_layout(hits));
+    REQUIRE(def.ordinal(State::Small, Event::Order) == 0);
+    REQUIRE(def.candidates(State::Idle, Event::Order).size() == 2);
+    REQUIRE(def.candidates(State::Idle, Event::Order)[1].dst == State::Large);
+    REQUIRE(def.ordinal(State::Large, Event::Reset) == 3);
+
+    /* add_transition replaces the whole list. */
+    def.add_transition({ State::Idle, Event::Order, State::Rejected, nullptr, nullptr });
+    REQUIRE(def.size() == 3);
+    REQUIRE(def.candidates(State::Idle, Event::Order).size() == 1);
+    REQUIRE(def.find(State::Idle, Event::Order)->dst == State::Rejected);
+    REQUIRE(def.ordinal(State::Large, Event::Reset) == 2);
+}
+
+TEST_CASE("instrumentation and bulk machines see every candidate", "[fsm][candidates]") {
+    fsm::runtime<State, Event, Context, fsm::counting_instrumentation<>> sm(State::Idle);
+    populate(sm);
+    Context ctx;
+    ctx.amount = 500;
+    REQUIRE(sm.dispatch(Event::Order, ctx) == fsm::result::Ok);
+    REQUIRE(sm.instrumentation().snapshot().hits[1] == 1);
+
+    fsm::definition<State, Event, Context> def;
+    populate(def);
+    def.freeze();
+    fsm::bulk_machine<State, Event, 4, 2, Context> bulk(def, 3, State::Idle);
+    bulk.dispatch_all(Event::Order, ctx);
+    REQUIRE(bulk.state(2) == State::Large);
+
+    const std::size_t ids[] = { 0, 1 };
+    const Event evs[] = { Event::Reset, Event::Reset };
+    REQUIRE(bulk.dispatch_batch(ids, evs, ctx) == 2);
+    ctx.amount = 0;
+    const Event orders[] = { Event::Order, Event::Order };
+    REQUIRE(bulk.dispatch_batch(ids, orders, ctx) == 2);
+    REQUIRE(bulk.state(0) == State::Rejected);
+}
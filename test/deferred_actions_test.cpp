@@ -0,0 +1,123 @@
+#include <fsm/atomic_runtime.hpp>
+#include <fsm/event_queue.hpp>
+#include <fsm/instance.hpp>
+#include <fsm/instrumentation.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+
+enum class State { Idle, Running, Done };
+enum class Event { Start, Stop, Finish };
+
+struct Context {
+    bool ready = true;
+    int started = 0;
+    int finished = 0;
+};
+
+template <class Machine>
+void populate(Machine& sm) {
+    sm.add_transition({ State::Idle, Event::Start, State::Running,
+        [](const Context& c) { return c.ready; },
+        [](Context& c) { ++c.started; } });
+    sm.add_transition({ State::Running, Event::Stop, State::Idle, nullptr, nullptr });
+    sm.add_transition({ State::Running, Event::Finish, State::Done, nullptr,
+        [](Context& c) { ++c.finished; } });
+}
+
+} // namespace
+
+TEST_CASE("dispatch_deferred commits the state and returns the action", "[fsm][deferred]") {
+    fsm::runtime<State, Event, Context> sm(State::Idle);
+    populate(sm);
+    Context ctx;
+    fsm::action_ticket t;
+
+    REQUIRE(sm.dispatch_deferred(Event::Start, ctx, t) == fsm::result::Ok);
+    REQUIRE(sm.current() == State::Running);
+    REQUIRE(t);
+    REQUIRE(ctx.started == 0);
+    sm.run(t, ctx);
+    REQUIRE(ctx.started == 1);
+
+    REQUIRE(sm.dispatch_deferred(Event::Stop, ctx, t) == fsm::result::Ok);
+    REQUIRE_FALSE(t); /* no action to run */
+    REQUIRE(sm.dispatch_deferred(Event::Stop, ctx, t) == fsm::result::NoTransition);
+    REQUIRE_FALSE(t);
+    ctx.ready = false;
+    REQUIRE(sm.dispatch_deferred(Event::Start, ctx, t) == fsm::result::GuardRejected);
+    REQUIRE_FALSE(t);
+    sm.run(t, ctx);
+    REQUIRE(ctx.started == 1);
+}
+
+TEST_CASE("tickets run later in a batch", "[fsm][deferred]") {
+    fsm::definition<State, Event, Context> def;
+    populate(def);
+    def.freeze();
+    fsm::instance<State, Event, Context> inst(def, State::Idle);
+
+    Context ctx;
+    std::vector<fsm::action_ticket> batch;
+    for (Event ev : { Event::Start, Event::Stop, Event::Start, Event::Finish }) {
+        fsm::action_ticket t;
+        REQUIRE(inst.dispatch_deferred(ev, ctx, t) == fsm::result::Ok);
+        batch.push_back(t);
+    }
+    REQUIRE(inst.current() == State::Done);
+    REQUIRE(ctx.started == 0);
+    def.run(batch, ctx);
+    REQUIRE(ctx.started == 2);
+    REQUIRE(ctx.finished == 1);
+}
+
+TEST_CASE("tickets travel through an event_queue", "[fsm][deferred]") {
+    fsm::atomic_runtime<State, Event, Context> sm(State::Idle);
+    populate(sm);
+    sm.freeze();
+    fsm::event_queue<fsm::action_ticket, 8> pending;
+
+    Context ctx;
+    fsm::action_ticket t;
+    REQUIRE(sm.dispatch_deferred(Event::Start, ctx, t) == fsm::result::Ok);
+    REQUIRE(pending.post(t));
+    REQUIRE(sm.dispatch_deferred(Event::Finish, ctx, t) == fsm::result::Ok);
+    REQUIRE(pending.post(t));
+    REQUIRE(sm.current() == State::Done);
+
+    fsm::action_ticket next;
+    while (pending.try_pop(next)) {
+        sm.table().run(next, ctx);
+    }
+    REQUIRE(ctx.started == 1);
+    REQUIRE(ctx.finished == 1);
+}
+
+TEST_CASE("deferred dispatch is instrumented", "[fsm][deferred]") {
+    fsm::runtime<State, Event, Context, fsm::counting_instrumentation<>> sm(State::Idle);
+    populate(sm);
+    Context ctx;
+    fsm::action_ticket t;
+    REQUIRE(sm.dispatch_deferred(Event::Start, ctx, t) == fsm::result::Ok);
+    sm.run(t, ctx);
+    REQUIRE(sm.dispatch_deferred(Event::Start, ctx, t) == fsm::result::NoTransition);
+
+    const auto snap = sm.instrumentation().snapshot();
+    REQUIRE(snap.count(fsm::result::Ok) == 1);
+    REQUIRE(snap.count(fsm::result::NoTransition) == 1);
+    REQUIRE(snap.hits[sm.table().ordinal(State::Idle, Event::Start)] == 1);
+    REQUIRE(ctx.started == 1);
+}
+
+TEST_CASE("void context tickets", "[fsm][deferred]") {
+    static int fired = 0;
+    fsm::runtime<int, int> sm(0);
+    sm.add_transition({ 0, 0, 1, nullptr, [] { ++fired; } });
+    fsm::action_ticket t;
+    REQUIRE(sm.dispatch_deferred(0, t) == fsm::result::Ok);
+    REQUIRE(fired == 0);
+    sm.run(t);
+    REQUIRE(fired == 1);
+}
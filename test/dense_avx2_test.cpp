@@ -0,0 +1,99 @@
+// Built with -mavx2 as its own executable (fsm_avx2_tests), so run() takes
+// the multi-start vpshufb kernel; the rest of the suite stays portable.
+#include <fsm/dense_runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if !defined(FSM_DENSE_RUN_AVX2)
+#error "dense_avx2_test.cpp must be compiled with AVX2 enabled"
+#endif
+
+namespace {
+
+template <std::size_t States>
+using Recognizer = fsm::dense_runtime<int, int, States, 6>;
+
+/* Same table in every machine: some cells missing, event 5 never used. */
+template <class Machine>
+void populate(Machine& sm, int states) {
+    for (int s = 0; s < states; ++s) {
+        for (int e = 0; e < 5; ++e) {
+            if ((s * 7 + e * 3) % 4 != 0) {
+                sm.add_transition({ s, e, (s * 5 + e + 1) % states, nullptr,
+                                    nullptr });
+            }
+        }
+    }
+}
+
+/* Mostly valid events; 5 has no transition, 6 and -1 are out of range. */
+std::vector<int> mix(std::size_t n, uint32_t seed) {
+    std::vector<int> evs;
+    evs.reserve(n);
+    uint32_t x = seed;
+    for (std::size_t i = 0; i < n; ++i) {
+        x = x * 1103515245u + 12345u;
+        const int e = static_cast<int>((x >> 16) % 8);
+        evs.push_back(e == 7 ? -1 : e);
+    }
+    return evs;
+}
+
+/* run() against event-by-event dispatch, which stays scalar. */
+template <std::size_t States>
+void check(const std::vector<int>& evs, int start) {
+    Recognizer<States> fast(start);
+    Recognizer<States> scalar(start);
+    populate(fast, static_cast<int>(States));
+    populate(scalar, static_cast<int>(States));
+    std::size_t rejected = 0;
+    for (int ev : evs) {
+        rejected += scalar.dispatch(ev) != fsm::result::Ok;
+    }
+    const auto res = fast.run(evs);
+    INFO("states " << States << ", length " << evs.size() << ", start "
+                   << start);
+    REQUIRE(res.state == scalar.current());
+    REQUIRE(fast.current() == scalar.current());
+    REQUIRE(res.rejected == rejected);
+}
+
+} // namespace
+
+TEST_CASE("avx2 run matches scalar dispatch across lengths", "[fsm][dense][avx2]") {
+    /* Around the 64-event threshold, the 255-event counter flush in each
+       half, and long odd buffers whose last event is walked serially. */
+    const std::size_t lengths[] = { 63,  64,  65,  509, 510, 511,  512,
+                                    513, 1021, 1023, 5003, 100001 };
+    uint32_t seed = 1;
+    for (const std::size_t n : lengths) {
+        const auto evs = mix(n, seed++);
+        for (int start = 0; start < 16; start += 5) {
+            check<16>(evs, start);
+        }
+        check<12>(evs, 7);
+        check<2>(evs, 1);
+        check<1>(evs, 0);
+    }
+}
+
+TEST_CASE("avx2 run counts long runs of rejected events", "[fsm][dense][avx2]") {
+    /* More than 255 rejects per half overflow a byte counter unless it is
+       flushed; both halves start in a state with a different outcome. */
+    std::vector<int> evs(4001, 5);
+    for (std::size_t i = 0; i < evs.size(); i += 97) {
+        evs[i] = static_cast<int>(i % 5);
+    }
+    check<16>(evs, 3);
+    check<16>(std::vector<int>(3001, -1), 9);
+    check<16>(std::vector<int>(3001, 6), 0);
+
+    /* A start state outside the table rejects everything. */
+    Recognizer<16> sm(16);
+    populate(sm, 16);
+    const auto res = sm.run(std::vector<int>(777, 1));
+    REQUIRE(res.rejected == 777);
+    REQUIRE(sm.current() == 16);
+}
@@ -0,0 +1,126 @@
+#include <fsm/dense_runtime.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+enum class Light { Red, Green, Yellow };
+enum class Event { Timer, Reset };
+
+struct Context {
+    int counter = 0;
+    bool allow = true;
+};
+
+using Dense = fsm::dense_runtime<Light, Event, 3, 2, Context>;
+
+} // namespace
+
+TEST_CASE("dense runtime transition flow", "[fsm][dense]") {
+    Dense sm(Light::Red);
+    REQUIRE(sm.add_transition({ Light::Red, Event::Timer, Light::Green, nullptr,
+        [](Context& ctx){ ctx.counter++; } }));
+    REQUIRE(sm.add_transition({ Light::Green, Event::Timer, Light::Yellow,
+        [](const Context& ctx){ return ctx.allow; }, nullptr }));
+
+    Context ctx;
+    REQUIRE(sm.dispatch(Event::Timer, ctx) == Dense::Result::Ok);
+    REQUIRE(sm.current() == Light::Green);
+    REQUIRE(ctx.counter == 1);
+
+    ctx.allow = false;
+    REQUIRE(sm.dispatch(Event::Timer, ctx) == Dense::Result::GuardRejected);
+    REQUIRE(sm.current() == Light::Green);
+
+    REQUIRE(sm.dispatch(Event::Reset, ctx) == Dense::Result::NoTransition);
+    REQUIRE(sm.current() == Light::Green);
+}
+
+TEST_CASE("dense runtime rejects out of range transitions", "[fsm][dense]") {
+    fsm::dense_runtime<int, int, 2, 2> sm(0);
+    REQUIRE_FALSE(sm.add_transition({ 2, 0, 1, nullptr, nullptr }));
+    REQUIRE_FALSE(sm.add_transition({ 0, 2, 1, nullptr, nullptr }));
+    REQUIRE_FALSE(sm.add_transition({ 0, 0, 5, nullptr, nullptr }));
+    REQUIRE_FALSE(sm.add_transition({ -1, 0, 1, nullptr, nullptr }));
+    REQUIRE(sm.add_transition({ 0, 1, 1, nullptr, nullptr }));
+
+    REQUIRE(sm.dispatch(7) == fsm::result::NoTransition);
+    REQUIRE(sm.dispatch(1) == fsm::result::Ok);
+    REQUIRE(sm.current() == 1);
+}
+
+TEST_CASE("dense runtime matches map runtime", "[fsm][dense]") {
+    fsm::runtime<int, int> map_sm(0);
+    fsm::dense_runtime<int, int, 4, 3> dense_sm(0);
+    for (int s = 0; s < 4; ++s) {
+        for (int e = 0; e < 3; ++e) {
+            if ((s + e) % 2 == 0) {
+                map_sm.add_transition({ s, e, (s + e + 1) % 4, nullptr, nullptr });
+                dense_sm.add_transition({ s, e, (s + e + 1) % 4, nullptr, nullptr });
+            }
+        }
+    }
+    // Last definition wins, as with the map backend.
+    map_sm.add_transition({ 1, 1, 0, nullptr, nullptr });
+    dense_sm.add_transition({ 1, 1, 0, nullptr, nullptr });
+
+    const int events[] = { 0, 1, 2, 2, 1, 0, 0, 1, 2, 1, 1, 0 };
+    for (int ev : events) {
+        REQUIRE(dense_sm.dispatch(ev) == map_sm.dispatch(ev));
+        REQUIRE(dense_sm.current() == map_sm.current());
+    }
+    REQUIRE(dense_sm.to_dot().rfind("digraph FSM", 0) == 0);
+}
+
+TEST_CASE("dense runtime run matches per-event dispatch", "[fsm][dense]") {
+    using Recognizer = fsm::dense_runtime<int, int, 12, 5>;
+    Recognizer fast(0);
+    Recognizer ref(0);
+    for (int s = 0; s < 12; ++s) {
+        for (int e = 0; e < 5; ++e) {
+            if ((s * 7 + e * 3) % 4 != 0) {
+                fast.add_transition({ s, e, (s * 5 + e + 1) % 12, nullptr, nullptr });
+                ref.add_transition({ s, e, (s * 5 + e + 1) % 12, nullptr, nullptr });
+            }
+        }
+    }
+
+    std::vector<int> events;
+    uint32_t x = 7;
+    for (int i = 0; i < 5003; ++i) {
+        x = x * 1103515245u + 12345u;
+        // Mostly valid events, a few out of range.
+        events.push_back(static_cast<int>((x >> 16) % 6));
+    }
+
+    std::size_t rejected = 0;
+    for (int ev : events) {
+        rejected += ref.dispatch(ev) != fsm::result::Ok;
+    }
+    const auto res = fast.run(events);
+    REQUIRE(res.state == ref.current());
+    REQUIRE(fast.current() == ref.current());
+    REQUIRE(res.rejected == rejected);
+
+    // Short buffers take the scalar path.
+    const int few[] = { 1, 2, 5 };
+    const auto short_res = fast.run(few);
+    REQUIRE(short_res.state == fast.current());
+}
+
+TEST_CASE("dense runtime run falls back to dispatch with callables", "[fsm][dense]") {
+    Dense sm(Light::Red);
+    sm.add_transition({ Light::Red, Event::Timer, Light::Green, nullptr,
+        [](Context& ctx){ ctx.counter++; } });
+    sm.add_transition({ Light::Green, Event::Timer, Light::Red, nullptr,
+        [](Context& ctx){ ctx.counter++; } });
+
+    Context ctx;
+    const Event evs[] = { Event::Timer, Event::Reset, Event::Timer, Event::Timer };
+    const auto res = sm.run(evs, ctx);
+    REQUIRE(res.state == Light::Green);
+    REQUIRE(res.rejected == 1);
+    REQUIRE(ctx.counter == 3);
+}
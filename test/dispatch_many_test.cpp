@@ -0,0 +1,99 @@
+#include <fsm/instance.hpp>
+#include <fsm/instrumentation.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <vector>
+
+namespace {
+
+enum class State { Idle, Running, Done };
+enum class Event { Start, Stop, Finish };
+
+struct Context {
+    bool ready = true;
+    int started = 0;
+};
+
+template <class Machine>
+void populate(Machine& sm) {
+    sm.add_transition({ State::Idle, Event::Start, State::Running,
+        [](const Context& c) { return c.ready; },
+        [](Context& c) { ++c.started; } });
+    sm.add_transition({ State::Running, Event::Stop, State::Idle, nullptr, nullptr });
+    sm.add_transition({ State::Running, Event::Finish, State::Done, nullptr, nullptr });
+}
+
+} // namespace
+
+TEST_CASE("dispatch_many matches repeated dispatch", "[fsm][dispatch_many]") {
+    const std::vector<Event> evs = { Event::Start, Event::Stop, Event::Stop,
+                                     Event::Start, Event::Finish, Event::Start };
+    fsm::runtime<State, Event, Context> one(State::Idle);
+    fsm::runtime<State, Event, Context> many(State::Idle);
+    populate(one);
+    populate(many);
+
+    Context c1, c2;
+    std::vector<fsm::result> expected;
+    for (Event ev : evs) {
+        expected.push_back(one.dispatch(ev, c1));
+    }
+    std::array<fsm::result, 6> out{};
+    REQUIRE(many.dispatch_many(evs, c2, out) == evs.size());
+    REQUIRE(std::vector<fsm::result>(out.begin(), out.end()) == expected);
+    REQUIRE(many.current() == one.current());
+    REQUIRE(c2.started == c1.started);
+}
+
+TEST_CASE("dispatch_many can stop at the first failure", "[fsm][dispatch_many]") {
+    fsm::runtime<State, Event, Context> sm(State::Idle);
+    populate(sm);
+    const Event evs[] = { Event::Start, Event::Stop, Event::Finish, Event::Start };
+
+    Context ctx;
+    std::array<fsm::result, 4> out{};
+    REQUIRE(sm.dispatch_many(evs, ctx, out, true) == 3);
+    REQUIRE(out[2] == fsm::result::NoTransition);
+    REQUIRE(sm.current() == State::Idle);
+    REQUIRE(ctx.started == 1);
+
+    ctx.ready = false;
+    REQUIRE(sm.dispatch_many(evs, ctx, {}, true) == 1);
+    REQUIRE(sm.current() == State::Idle);
+}
+
+TEST_CASE("dispatch_many processes at most out.size() events", "[fsm][dispatch_many]") {
+    fsm::runtime<int, int> sm(0);
+    sm.add_transition({ 0, 0, 1, nullptr, nullptr });
+    sm.add_transition({ 1, 0, 0, nullptr, nullptr });
+    const int evs[] = { 0, 0, 0, 0, 0 };
+
+    std::array<fsm::result, 3> out{};
+    REQUIRE(sm.dispatch_many(evs, out) == 3);
+    REQUIRE(sm.current() == 1);
+    REQUIRE(sm.dispatch_many(evs) == 5);
+    REQUIRE(sm.current() == 0);
+    REQUIRE(sm.dispatch_many({}) == 0);
+}
+
+TEST_CASE("dispatch_many on instances and instrumented runtimes", "[fsm][dispatch_many]") {
+    fsm::definition<State, Event, Context> def;
+    populate(def);
+    def.freeze();
+    fsm::instance<State, Event, Context> inst(def, State::Idle);
+    const Event evs[] = { Event::Start, Event::Finish, Event::Stop };
+
+    Context ctx;
+    REQUIRE(inst.dispatch_many(evs, ctx, {}, true) == 3);
+    REQUIRE(inst.current() == State::Done);
+
+    fsm::runtime<State, Event, Context, fsm::counting_instrumentation<>> sm(State::Idle);
+    populate(sm);
+    std::array<fsm::result, 3> out{};
+    REQUIRE(sm.dispatch_many(evs, ctx, out) == 3);
+    REQUIRE(out[2] == fsm::result::NoTransition);
+    const auto snap = sm.instrumentation().snapshot();
+    REQUIRE(snap.count(fsm::result::Ok) == 2);
+    REQUIRE(snap.count(fsm::result::NoTransition) == 1);
+}
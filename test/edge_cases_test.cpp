@@ -39,3 +39,26 @@ TEST_CASE("multiple FSM instances", "[fsm]") {
     REQUIRE(sm1.current() == State::Unlocked);
     REQUIRE(sm2.current() == State::Unlocked); // Should remain unchanged
 }
+
+TEST_CASE("overwriting a transition replaces its guard and action", "[fsm]") {
+    fsm::runtime<State, Event> sm(State::Locked);
+    int calls = 0;
+    sm.add_transition({ State::Locked, Event::Coin, State::Unlocked,
+                        [] { return false; }, nullptr });
+    REQUIRE(sm.dispatch(Event::Coin) == fsm::result::GuardRejected);
+
+    sm.add_transition({ State::Locked, Event::Coin, State::Unlocked,
+                        nullptr, [&calls] { ++calls; } });
+    REQUIRE(sm.dispatch(Event::Coin) == fsm::result::Ok);
+    REQUIRE(calls == 1);
+
+    sm.add_transition({ State::Unlocked, Event::Push, State::Locked, nullptr, nullptr });
+    sm.add_transition({ State::Locked, Event::Coin, State::Locked, nullptr, nullptr });
+    sm.freeze();
+    REQUIRE(sm.dispatch(Event::Push) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Coin) == fsm::result::Ok);
+    REQUIRE(sm.current() == State::Locked);
+    REQUIRE(calls == 1);
+    REQUIRE(sm.table().ordinal(State::Unlocked, Event::Push) == 1);
+    REQUIRE(sm.table().ordinal(State::Unlocked, Event::Coin) == fsm::perfect_hash::npos);
+}
@@ -0,0 +1,92 @@
+#include <fsm/event_queue.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum class State { Idle, Busy };
+enum class Event : uint8_t { Start, Stop };
+
+struct Context {
+    int started = 0;
+};
+
+} // namespace
+
+TEST_CASE("event queue drains into a machine in order", "[fsm][queue]") {
+    fsm::runtime<State, Event, Context> sm(State::Idle);
+    sm.add_transition({ State::Idle, Event::Start, State::Busy, nullptr,
+        [](Context& c) { ++c.started; } });
+    sm.add_transition({ State::Busy, Event::Stop, State::Idle, nullptr, nullptr });
+
+    fsm::event_queue<Event, 8> q;
+    REQUIRE(q.post(Event::Start));
+    REQUIRE(q.post(Event::Stop));
+    REQUIRE(q.post(Event::Start));
+    REQUIRE(q.size_approx() == 3);
+
+    Context ctx;
+    REQUIRE(q.drain(sm, ctx) == 3);
+    REQUIRE(ctx.started == 2);
+    REQUIRE(sm.current() == State::Busy);
+    REQUIRE(q.drain(sm, ctx) == 0);
+}
+
+TEST_CASE("event queue rejects posts when full", "[fsm][queue]") {
+    fsm::event_queue<int, 4> q;
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(q.post(i));
+    }
+    REQUIRE_FALSE(q.post(99));
+
+    int v = -1;
+    REQUIRE(q.try_pop(v));
+    REQUIRE(v == 0);
+    REQUIRE(q.post(4));
+    for (int expected = 1; expected <= 4; ++expected) {
+        REQUIRE(q.try_pop(v));
+        REQUIRE(v == expected);
+    }
+    REQUIRE_FALSE(q.try_pop(v));
+}
+
+TEST_CASE("event queue keeps per-producer order across threads", "[fsm][queue]") {
+    constexpr int producers = 4;
+    constexpr int per_producer = 20000;
+    static fsm::event_queue<uint32_t, 1024> q;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([p] {
+            for (uint32_t i = 0; i < per_producer; ++i) {
+                while (!q.post((static_cast<uint32_t>(p) << 24) | i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> next(producers, 0);
+    int received = 0;
+    bool ordered = true;
+    while (received < producers * per_producer) {
+        uint32_t v = 0;
+        if (!q.try_pop(v)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const uint32_t p = v >> 24;
+        ordered = ordered && (v & 0xFFFFFF) == next[p];
+        ++next[p];
+        ++received;
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    REQUIRE(ordered);
+    for (uint32_t n : next) {
+        REQUIRE(n == per_producer);
+    }
+}
@@ -0,0 +1,113 @@
+#include <fsm/definition.hpp>
+#include <fsm/executor.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Counter {
+    uint32_t actions = 0;
+};
+
+// State k only accepts event k, so any reordering of an instance's events
+// leaves it stuck below `steps`.
+constexpr uint32_t steps = 500;
+
+fsm::definition<uint32_t, uint32_t, Counter> make_sequence() {
+    fsm::definition<uint32_t, uint32_t, Counter> def;
+    for (uint32_t k = 0; k < steps; ++k) {
+        def.add_transition({ k, k, k + 1, nullptr,
+            [](Counter& c) { ++c.actions; } });
+    }
+    def.freeze();
+    return def;
+}
+
+using Exec = fsm::executor<uint32_t, uint32_t, Counter, 1024>;
+
+void post_all(Exec& ex, const std::vector<std::size_t>& ids) {
+    for (uint32_t k = 0; k < steps; ++k) {
+        for (std::size_t id : ids) {
+            while (!ex.post(id, k)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("executor preserves per-instance order across shards", "[fsm][executor]") {
+    const auto def = make_sequence();
+    Exec ex(def, 64, 0, 4);
+    ex.start();
+
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < 4; ++p) {
+        producers.emplace_back([&ex, p] {
+            std::vector<std::size_t> ids;
+            for (std::size_t id = p; id < 64; id += 4) {
+                ids.push_back(id);
+            }
+            post_all(ex, ids);
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    ex.stop();
+
+    REQUIRE(ex.processed() == 64 * steps);
+    for (std::size_t id = 0; id < ex.size(); ++id) {
+        REQUIRE(ex.state(id) == steps);
+        REQUIRE(ex.context(id).actions == steps);
+    }
+}
+
+TEST_CASE("executor keeps order when one shard is overloaded", "[fsm][executor]") {
+    const auto def = make_sequence();
+    Exec ex(def, 32, 0, 4);
+    ex.start();
+
+    // Every instance lives on shard 0; the other workers can only steal.
+    std::vector<std::size_t> ids;
+    for (std::size_t id = 0; id < 32; id += 4) {
+        ids.push_back(id);
+    }
+    post_all(ex, ids);
+    ex.stop();
+
+    for (std::size_t id : ids) {
+        REQUIRE(ex.shard_of(id) == 0);
+        REQUIRE(ex.state(id) == steps);
+    }
+    REQUIRE(ex.state(1) == 0);
+}
+
+TEST_CASE("executor can be driven without worker threads", "[fsm][executor]") {
+    fsm::definition<int, int> def;
+    def.add_transition({ 0, 1, 1, nullptr, nullptr });
+    fsm::executor<int, int, void, 16> ex(def, 3, 0, 2);
+    REQUIRE(ex.post(2, 1));
+    REQUIRE(ex.post(0, 7));
+    REQUIRE(ex.run_pending() == 2);
+    REQUIRE(ex.state(0) == 0);
+    REQUIRE(ex.state(1) == 0);
+    REQUIRE(ex.state(2) == 1);
+}
+
+TEST_CASE("executor rejects events for unknown instances", "[fsm][executor]") {
+    fsm::definition<int, int> def;
+    def.add_transition({ 0, 1, 1, nullptr, nullptr });
+    fsm::executor<int, int, void, 16> ex(def, 3, 0, 2);
+    REQUIRE_FALSE(ex.post(3, 1));
+    REQUIRE_FALSE(ex.post(static_cast<std::size_t>(-1), 1));
+    if constexpr (sizeof(std::size_t) > sizeof(uint32_t)) {
+        /* Would alias instance 2 if ids were narrowed to 32 bits. */
+        REQUIRE_FALSE(ex.post((std::size_t{1} << 32) | 2, 1));
+    }
+    REQUIRE(ex.run_pending() == 0);
+    REQUIRE(ex.state(2) == 0);
+}
@@ -0,0 +1,123 @@
+#include <fsm/instrumentation.hpp>
+#include <fsm/perfect_hash.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+enum class State { Idle, Running, Done };
+enum class Event { Start, Stop, Finish };
+
+struct Context {
+    bool ready = false;
+    int started = 0;
+};
+
+using FSM = fsm::runtime<State, Event, Context>;
+
+} // namespace
+
+TEST_CASE("frozen runtime dispatches like the build-time table", "[fsm][freeze]") {
+    FSM sm(State::Idle);
+    sm.add_transition({ State::Idle, Event::Start, State::Running,
+        [](const Context& c) { return c.ready; },
+        [](Context& c) { ++c.started; } });
+    sm.add_transition({ State::Running, Event::Stop, State::Idle, nullptr, nullptr });
+    sm.add_transition({ State::Running, Event::Finish, State::Done, nullptr, nullptr });
+
+    REQUIRE_FALSE(sm.frozen());
+    sm.freeze();
+    REQUIRE(sm.frozen());
+    REQUIRE(sm.size() == 3);
+
+    Context ctx;
+    REQUIRE(sm.dispatch(Event::Start, ctx) == FSM::Result::GuardRejected);
+    ctx.ready = true;
+    REQUIRE(sm.dispatch(Event::Start, ctx) == FSM::Result::Ok);
+    REQUIRE(ctx.started == 1);
+    REQUIRE(sm.dispatch(Event::Start, ctx) == FSM::Result::NoTransition);
+    REQUIRE(sm.dispatch(Event::Finish, ctx) == FSM::Result::Ok);
+    REQUIRE(sm.current() == State::Done);
+}
+
+TEST_CASE("frozen runtime rejects new transitions", "[fsm][freeze]") {
+    fsm::runtime<int, int> sm(0);
+    REQUIRE(sm.add_transition({ 0, 0, 1, nullptr, nullptr }));
+    sm.freeze();
+    REQUIRE_FALSE(sm.add_transition({ 1, 0, 0, nullptr, nullptr }));
+    REQUIRE(sm.size() == 1);
+
+    REQUIRE(sm.dispatch(0) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(0) == fsm::result::NoTransition);
+    REQUIRE(sm.current() == 1);
+}
+
+TEST_CASE("freezing an empty table", "[fsm][freeze]") {
+    fsm::runtime<int, int> sm(0);
+    sm.freeze();
+    REQUIRE(sm.dispatch(0) == fsm::result::NoTransition);
+}
+
+TEST_CASE("perfect hash indexes every key without collisions", "[fsm][freeze]") {
+    std::vector<uint64_t> keys;
+    uint64_t x = 12345;
+    for (int i = 0; i < 100000; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        keys.push_back(x);
+    }
+    fsm::perfect_hash ph;
+    REQUIRE(ph.build(keys));
+    std::size_t misses = 0;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        misses += ph.find(keys[i]) != i;
+    }
+    REQUIRE(misses == 0);
+    REQUIRE(ph.find(0) == fsm::perfect_hash::npos);
+    REQUIRE(ph.find(keys[0] + 1) == fsm::perfect_hash::npos);
+
+    const uint64_t dup[] = { 1, 2, 1 };
+    REQUIRE_FALSE(ph.build(dup));
+    REQUIRE(ph.find(1) == fsm::perfect_hash::npos);
+}
+
+TEST_CASE("optimize_layout packs hot transitions first", "[fsm][freeze]") {
+    fsm::runtime<int, int> sm(0);
+    for (int s = 0; s < 6; ++s) {
+        sm.add_transition({ s, 0, (s + 1) % 6, nullptr, nullptr });
+    }
+    const uint64_t hits[] = { 1, 0, 9, 0, 9, 3 };
+    REQUIRE(sm.optimize_layout(hits));
+
+    const auto trs = sm.table().transitions();
+    const int expected_src[] = { 2, 4, 5, 0, 1, 3 };
+    for (std::size_t i = 0; i < trs.size(); ++i) {
+        REQUIRE(trs[i].src == expected_src[i]);
+    }
+    for (int s = 0; s < 6; ++s) {
+        REQUIRE(sm.dispatch(0) == fsm::result::Ok);
+        REQUIRE(sm.current() == (s + 1) % 6);
+    }
+}
+
+TEST_CASE("freeze with a profile reorders then freezes", "[fsm][freeze]") {
+    fsm::runtime<int, int, void, fsm::counting_instrumentation<>> sm(0);
+    sm.add_transition({ 0, 0, 1, nullptr, nullptr });
+    sm.add_transition({ 1, 0, 0, nullptr, nullptr });
+    sm.add_transition({ 1, 1, 2, nullptr, nullptr });
+    REQUIRE(sm.dispatch(0) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(1) == fsm::result::Ok);
+
+    const auto profile = sm.instrumentation().snapshot().hits;
+    sm.freeze(profile);
+    REQUIRE(sm.frozen());
+    REQUIRE(sm.table().transitions()[1].ev == 1);
+    REQUIRE(sm.table().transitions()[2].ev == 0);
+    REQUIRE(sm.instrumentation().snapshot().hits == std::vector<uint64_t>{ 0, 0, 0 });
+    REQUIRE(sm.table().find(2, 0) == nullptr);
+    REQUIRE(sm.table().find(1, 1)->dst == 2);
+
+    const uint64_t again[] = { 1 };
+    REQUIRE_FALSE(sm.optimize_layout(again));
+}
@@ -0,0 +1,154 @@
+#include <fsm/bulk_machine.hpp>
+#include <fsm/instance.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+
+namespace {
+
+/* Connected is the parent of Handshake and Open; Open nests Idle and Busy. */
+enum class State : uint8_t { Closed, Connected, Handshake, Open, Idle, Busy, Count };
+enum class Event : uint8_t { Connect, Ready, Work, Done, Disconnect, Ping, Count };
+
+} // namespace
+
+template <>
+struct fsm::enum_count<State> {
+    static constexpr auto value = static_cast<std::size_t>(State::Count);
+};
+
+template <>
+struct fsm::enum_count<Event> {
+    static constexpr auto value = static_cast<std::size_t>(Event::Count);
+};
+
+namespace {
+
+struct Context {
+    bool alive = true;
+    int pings = 0;
+};
+
+using FSM = fsm::runtime<State, Event, Context>;
+
+void populate(FSM& sm) {
+    sm.add_transition({ State::Closed, Event::Connect, State::Handshake, nullptr, nullptr });
+    sm.add_transition({ State::Handshake, Event::Ready, State::Idle, nullptr, nullptr });
+    sm.add_transition({ State::Idle, Event::Work, State::Busy, nullptr, nullptr });
+    sm.add_transition({ State::Busy, Event::Done, State::Idle, nullptr, nullptr });
+    /* Parent-level handlers shared by every substate. */
+    sm.add_transition({ State::Connected, Event::Disconnect, State::Closed, nullptr, nullptr });
+    sm.add_transition({ State::Open, Event::Ping, State::Open,
+                        [](const Context& c) { return c.alive; },
+                        [](Context& c) { ++c.pings; } });
+    /* Busy overrides the inherited Disconnect. */
+    sm.add_transition({ State::Busy, Event::Disconnect, State::Idle, nullptr, nullptr });
+
+    sm.set_parent(State::Handshake, State::Connected);
+    sm.set_parent(State::Open, State::Connected);
+    sm.set_parent(State::Idle, State::Open);
+    sm.set_parent(State::Busy, State::Open);
+}
+
+} // namespace
+
+TEST_CASE("unhandled events bubble up to ancestors", "[fsm][hierarchy]") {
+    for (bool frozen : { false, true }) {
+        FSM sm(State::Closed);
+        populate(sm);
+        if (frozen) {
+            sm.freeze();
+        }
+        Context ctx;
+        REQUIRE(sm.dispatch(Event::Connect, ctx) == fsm::result::Ok);
+        REQUIRE(sm.dispatch(Event::Ping, ctx) == fsm::result::NoTransition);
+        REQUIRE(sm.dispatch(Event::Ready, ctx) == fsm::result::Ok);
+        REQUIRE(sm.current() == State::Idle);
+
+        /* Idle -> Open handles Ping; the destination is taken literally. */
+        REQUIRE(sm.dispatch(Event::Ping, ctx) == fsm::result::Ok);
+        REQUIRE(sm.current() == State::Open);
+        REQUIRE(ctx.pings == 1);
+
+        REQUIRE(sm.dispatch(Event::Disconnect, ctx) == fsm::result::Ok);
+        REQUIRE(sm.current() == State::Closed);
+        REQUIRE(sm.dispatch(Event::Work, ctx) == fsm::result::NoTransition);
+    }
+}
+
+TEST_CASE("own transitions shadow inherited ones and guards do not bubble",
+          "[fsm][hierarchy]") {
+    for (bool frozen : { false, true }) {
+        FSM sm(State::Busy);
+        populate(sm);
+        if (frozen) {
+            sm.freeze();
+        }
+        Context ctx;
+        REQUIRE(sm.dispatch(Event::Disconnect, ctx) == fsm::result::Ok);
+        REQUIRE(sm.current() == State::Idle);
+
+        ctx.alive = false;
+        REQUIRE(sm.dispatch(Event::Ping, ctx) == fsm::result::GuardRejected);
+        REQUIRE(sm.current() == State::Idle);
+
+        const auto* tr = sm.table().find(State::Idle, Event::Disconnect);
+        REQUIRE(tr != nullptr);
+        REQUIRE(tr->src == State::Connected);
+        REQUIRE(sm.table().find(State::Closed, Event::Disconnect) == nullptr);
+    }
+}
+
+TEST_CASE("set_parent rejects cycles, frozen tables and bad values",
+          "[fsm][hierarchy]") {
+    fsm::definition<State, Event> def;
+    REQUIRE(def.set_parent(State::Idle, State::Open));
+    REQUIRE(def.set_parent(State::Open, State::Connected));
+    REQUIRE_FALSE(def.set_parent(State::Connected, State::Idle));
+    REQUIRE_FALSE(def.set_parent(State::Open, State::Open));
+    REQUIRE_FALSE(def.set_parent(State::Count, State::Open));
+    REQUIRE(*def.parent(State::Idle) == State::Open);
+    REQUIRE(def.parent(State::Connected) == nullptr);
+
+    /* Re-parenting replaces the previous link. */
+    REQUIRE(def.set_parent(State::Idle, State::Connected));
+    REQUIRE(*def.parent(State::Idle) == State::Connected);
+
+    def.freeze();
+    REQUIRE_FALSE(def.set_parent(State::Busy, State::Open));
+}
+
+TEST_CASE("flattened keys resolve to the nearest handler", "[fsm][hierarchy]") {
+    FSM sm(State::Closed);
+    populate(sm);
+    sm.freeze();
+    /* Inherited pairs share the ancestor's ordinal; overrides keep their own. */
+    REQUIRE(sm.size() == 7);
+    REQUIRE(sm.table().memory_usage().index > 0);
+    REQUIRE(sm.table().ordinal(State::Idle, Event::Ping)
+            == sm.table().ordinal(State::Open, Event::Ping));
+    REQUIRE(sm.table().ordinal(State::Busy, Event::Disconnect)
+            != sm.table().ordinal(State::Open, Event::Disconnect));
+}
+
+TEST_CASE("instances and bulk machines inherit too", "[fsm][hierarchy]") {
+    fsm::definition<State, Event> def;
+    def.add_transition({ State::Closed, Event::Connect, State::Idle, nullptr, nullptr });
+    def.add_transition({ State::Connected, Event::Disconnect, State::Closed, nullptr, nullptr });
+    def.add_transition({ State::Idle, Event::Work, State::Busy, nullptr, nullptr });
+    def.set_parent(State::Idle, State::Connected);
+    def.set_parent(State::Busy, State::Idle);
+    def.freeze();
+
+    fsm::instance<State, Event> inst(def, State::Busy);
+    REQUIRE(inst.dispatch(Event::Work) == fsm::result::Ok);
+    REQUIRE(inst.current() == State::Busy);
+    REQUIRE(inst.dispatch(Event::Disconnect) == fsm::result::Ok);
+    REQUIRE(inst.current() == State::Closed);
+
+    fsm::bulk_machine<State, Event, 6, 6> bulk(def, 4, State::Closed);
+    bulk.dispatch_all(Event::Connect);
+    bulk.dispatch_all(Event::Work);
+    bulk.dispatch_all(Event::Disconnect);
+    REQUIRE(bulk.state(0) == State::Closed);
+}
@@ -0,0 +1,63 @@
+#include <fsm/inplace_function.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+enum class State { A, B };
+enum class Event { X };
+
+struct Context {
+    int counter = 0;
+};
+
+using FSM = fsm::runtime<State, Event, Context>;
+
+bool always_true(const Context&) { return true; }
+
+} // namespace
+
+TEST_CASE("inplace function stores callables without allocating", "[fsm][inplace]") {
+    using Fn = fsm::inplace_function<int(int)>;
+    STATIC_REQUIRE(std::is_trivially_copyable_v<Fn>);
+    STATIC_REQUIRE(std::is_trivially_destructible_v<Fn>);
+
+    Fn empty;
+    REQUIRE_FALSE(empty);
+    REQUIRE(empty == nullptr);
+
+    int base = 10;
+    Fn add = [&base](int v) { return base + v; };
+    REQUIRE(add);
+    REQUIRE(add(5) == 15);
+
+    // Relocation by memcpy keeps the callable intact.
+    Fn moved;
+    std::memcpy(static_cast<void*>(&moved), &add, sizeof(Fn));
+    base = 20;
+    REQUIRE(moved(1) == 21);
+
+    int (*fp)(int) = nullptr;
+    Fn from_null_ptr = fp;
+    REQUIRE_FALSE(from_null_ptr);
+}
+
+TEST_CASE("transition fits in one cache line", "[fsm][inplace]") {
+    STATIC_REQUIRE(sizeof(FSM::Transition) <= 64);
+    STATIC_REQUIRE(std::is_trivially_copyable_v<FSM::Transition>);
+}
+
+TEST_CASE("runtime accepts function pointers and capturing lambdas", "[fsm][inplace]") {
+    FSM sm(State::A);
+    int calls = 0;
+    sm.add_transition({ State::A, Event::X, State::B, &always_true,
+        [&calls](Context& ctx) { ++calls; ++ctx.counter; } });
+
+    Context ctx;
+    REQUIRE(sm.dispatch(Event::X, ctx) == FSM::Result::Ok);
+    REQUIRE(sm.current() == State::B);
+    REQUIRE(calls == 1);
+    REQUIRE(ctx.counter == 1);
+}
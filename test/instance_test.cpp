@@ -0,0 +1,62 @@
+#include <fsm/definition.hpp>
+#include <fsm/instance.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+
+enum class Session { Closed, Open };
+enum class Event { Connect, Disconnect };
+
+struct Context {
+    int opened = 0;
+};
+
+using Definition = fsm::definition<Session, Event, Context>;
+using Instance = fsm::instance<Session, Event, Context>;
+
+} // namespace
+
+TEST_CASE("instances share one definition", "[fsm][instance]") {
+    Definition def;
+    def.add_transition({ Session::Closed, Event::Connect, Session::Open, nullptr,
+        [](Context& c) { ++c.opened; } });
+    def.add_transition({ Session::Open, Event::Disconnect, Session::Closed,
+        nullptr, nullptr });
+    def.freeze();
+
+    std::vector<Instance> sessions(8, Instance(def, Session::Closed));
+    Context ctx;
+    for (std::size_t i = 0; i < sessions.size(); i += 2) {
+        REQUIRE(sessions[i].dispatch(Event::Connect, ctx) == Instance::Result::Ok);
+    }
+    REQUIRE(ctx.opened == 4);
+    for (std::size_t i = 0; i < sessions.size(); ++i) {
+        REQUIRE(sessions[i].current()
+                == (i % 2 == 0 ? Session::Open : Session::Closed));
+        REQUIRE(&sessions[i].table() == &def);
+    }
+    REQUIRE(sessions[1].dispatch(Event::Disconnect, ctx)
+            == Instance::Result::NoTransition);
+}
+
+TEST_CASE("instance state is a pointer and a state", "[fsm][instance]") {
+    STATIC_REQUIRE(sizeof(Instance) <= sizeof(void*) + sizeof(Session) + 4);
+
+    fsm::definition<int, int> def;
+    def.add_transition({ 0, 0, 1, nullptr, nullptr });
+    fsm::instance<int, int> a(def, 0);
+    fsm::instance<int, int> b(def, 1);
+    REQUIRE(a.dispatch(0) == fsm::result::Ok);
+    REQUIRE(b.dispatch(0) == fsm::result::NoTransition);
+    REQUIRE(a.current() == 1);
+}
+
+TEST_CASE("definition dispatch updates caller-held state", "[fsm][instance]") {
+    fsm::definition<int, int> def;
+    def.add_transition({ 0, 5, 3, nullptr, nullptr });
+    int state = 0;
+    REQUIRE(def.dispatch(state, 5) == fsm::result::Ok);
+    REQUIRE(state == 3);
+    REQUIRE(def.find(3, 5) == nullptr);
+}
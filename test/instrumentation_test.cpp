@@ -0,0 +1,120 @@
+#include <fsm/instrumentation.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+
+namespace {
+
+enum class State { Idle, Running, Done };
+enum class Event { Start, Stop, Finish };
+
+struct Context {
+    bool ready = false;
+    int started = 0;
+};
+
+template <class Policy>
+using FSM = fsm::runtime<State, Event, Context, Policy>;
+
+template <class Policy>
+void populate(FSM<Policy>& sm) {
+    sm.add_transition({ State::Idle, Event::Start, State::Running,
+        [](const Context& c) { return c.ready; },
+        [](Context& c) { ++c.started; } });
+    sm.add_transition({ State::Running, Event::Stop, State::Idle, nullptr, nullptr });
+    sm.add_transition({ State::Running, Event::Finish, State::Done, nullptr, nullptr });
+}
+
+struct Plain {
+    fsm::definition<State, Event, Context> table;
+    State current;
+};
+
+} // namespace
+
+TEST_CASE("default policy adds no storage", "[fsm][instrumentation]") {
+    STATIC_REQUIRE(sizeof(fsm::runtime<State, Event, Context>) == sizeof(Plain));
+    STATIC_REQUIRE(sizeof(FSM<fsm::no_instrumentation>) == sizeof(Plain));
+}
+
+TEST_CASE("counting policy counts per transition and per result", "[fsm][instrumentation]") {
+    FSM<fsm::counting_instrumentation<>> sm(State::Idle);
+    populate(sm);
+
+    Context ctx;
+    REQUIRE(sm.dispatch(Event::Stop, ctx) == fsm::result::NoTransition);
+    REQUIRE(sm.dispatch(Event::Start, ctx) == fsm::result::GuardRejected);
+    ctx.ready = true;
+    REQUIRE(sm.dispatch(Event::Start, ctx) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Stop, ctx) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Start, ctx) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Finish, ctx) == fsm::result::Ok);
+    REQUIRE(ctx.started == 2);
+
+    const auto snap = sm.instrumentation().snapshot();
+    REQUIRE(snap.hits.size() == 3);
+    REQUIRE(snap.hits[0] == 2);
+    REQUIRE(snap.hits[1] == 1);
+    REQUIRE(snap.hits[2] == 1);
+    REQUIRE(snap.rejected[0] == 1);
+    REQUIRE(snap.count(fsm::result::Ok) == 4);
+    REQUIRE(snap.count(fsm::result::NoTransition) == 1);
+    REQUIRE(snap.count(fsm::result::GuardRejected) == 1);
+    REQUIRE(snap.guard_cycles.empty());
+
+    sm.instrumentation().reset();
+    const auto zero = sm.instrumentation().snapshot();
+    REQUIRE(zero.hits[0] == 0);
+    REQUIRE(zero.count(fsm::result::Ok) == 0);
+}
+
+TEST_CASE("timing policy fills guard and action histograms", "[fsm][instrumentation]") {
+    FSM<fsm::counting_instrumentation<true>> sm(State::Idle);
+    populate(sm);
+
+    Context ctx{ true, 0 };
+    REQUIRE(sm.dispatch(Event::Start, ctx) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Stop, ctx) == fsm::result::Ok);
+
+    const auto snap = sm.instrumentation().snapshot();
+    REQUIRE(snap.guard_cycles.size() == 3);
+    REQUIRE(snap.action_cycles.size() == 3);
+
+    auto total = [](const fsm::cycle_histogram& h) {
+        uint64_t n = 0;
+        for (uint64_t b : h) {
+            n += b;
+        }
+        return n;
+    };
+    REQUIRE(total(snap.guard_cycles[0]) == 1);
+    REQUIRE(total(snap.action_cycles[0]) == 1);
+    /* Transition 1 has no callables, so nothing was timed. */
+    REQUIRE(total(snap.guard_cycles[1]) == 0);
+    REQUIRE(total(snap.action_cycles[1]) == 0);
+}
+
+TEST_CASE("histogram buckets are log2 of the cycle count", "[fsm][instrumentation]") {
+    using P = fsm::counting_instrumentation<true>;
+    STATIC_REQUIRE(P::bucket(0) == 0);
+    STATIC_REQUIRE(P::bucket(1) == 1);
+    STATIC_REQUIRE(P::bucket(1000) == 10);
+    STATIC_REQUIRE(P::bucket(~0ULL) == fsm::histogram_buckets - 1);
+}
+
+TEST_CASE("instrumentation works with a void context and freezing", "[fsm][instrumentation]") {
+    fsm::runtime<int, int, void, fsm::counting_instrumentation<>> sm(0);
+    sm.add_transition({ 0, 1, 1, nullptr, nullptr });
+    sm.add_transition({ 1, 1, 0, nullptr, nullptr });
+    sm.freeze();
+
+    REQUIRE(sm.dispatch(1) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(1) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(1) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(2) == fsm::result::NoTransition);
+
+    const auto snap = sm.instrumentation().snapshot();
+    REQUIRE(snap.hits[0] == 2);
+    REQUIRE(snap.hits[1] == 1);
+    REQUIRE(snap.count(fsm::result::NoTransition) == 1);
+}
@@ -0,0 +1,102 @@
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace {
+
+enum class State { Idle, Running, Done };
+enum class Event { Start, Stop, Finish };
+
+struct Context {
+    int started = 0;
+};
+
+using FSM = fsm::runtime<State, Event, Context>;
+
+/* Upstream resource that counts what the arena asks for. */
+class counting_resource : public std::pmr::memory_resource {
+public:
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+
+private:
+    void* do_allocate(std::size_t n, std::size_t align) override {
+        ++allocations;
+        bytes += n;
+        return std::pmr::new_delete_resource()->allocate(n, align);
+    }
+    void do_deallocate(void* p, std::size_t n, std::size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(p, n, align);
+    }
+    bool do_is_equal(const memory_resource& o) const noexcept override {
+        return this == &o;
+    }
+};
+
+void populate(FSM& sm) {
+    sm.add_transition({ State::Idle, Event::Start, State::Running, nullptr,
+                        [](Context& c) { ++c.started; } });
+    sm.add_transition({ State::Running, Event::Stop, State::Idle, nullptr, nullptr });
+    sm.add_transition({ State::Running, Event::Finish, State::Done, nullptr, nullptr });
+}
+
+/* Makes any allocation from the default resource throw. */
+struct no_default_resource {
+    std::pmr::memory_resource* previous =
+        std::pmr::set_default_resource(std::pmr::null_memory_resource());
+    ~no_default_resource() { std::pmr::set_default_resource(previous); }
+};
+
+} // namespace
+
+TEST_CASE("tables allocate only from the given resource", "[fsm][pmr]") {
+    counting_resource upstream;
+    std::pmr::monotonic_buffer_resource arena(&upstream);
+    {
+        std::vector<FSM> machines;
+        machines.reserve(100);
+        {
+            no_default_resource guard;
+            for (int i = 0; i < 100; ++i) {
+                machines.emplace_back(State::Idle, &arena);
+                populate(machines.back());
+                if (i % 2 == 0) {
+                    machines.back().freeze();
+                }
+            }
+        }
+        REQUIRE(upstream.allocations > 0);
+        REQUIRE(machines[7].table().resource() == &arena);
+
+        Context ctx;
+        for (auto& sm : machines) {
+            REQUIRE(sm.dispatch(Event::Start, ctx) == fsm::result::Ok);
+            REQUIRE(sm.dispatch(Event::Finish, ctx) == fsm::result::Ok);
+            REQUIRE(sm.current() == State::Done);
+        }
+        REQUIRE(ctx.started == 100);
+    }
+    arena.release();
+}
+
+TEST_CASE("profile layout stays in the resource", "[fsm][pmr]") {
+    std::pmr::monotonic_buffer_resource arena;
+    FSM sm(State::Idle, &arena);
+    populate(sm);
+    const uint64_t hits[] = { 0, 5, 1 };
+    {
+        no_default_resource guard;
+        sm.freeze(hits);
+    }
+    REQUIRE(sm.table().transitions()[0].ev == Event::Stop);
+    Context ctx;
+    REQUIRE(sm.dispatch(Event::Start, ctx) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Stop, ctx) == fsm::result::Ok);
+}
+
+TEST_CASE("default construction uses the default resource", "[fsm][pmr]") {
+    fsm::definition<State, Event> def;
+    REQUIRE(def.resource() == std::pmr::get_default_resource());
+}
@@ -0,0 +1,116 @@
+#include <fsm/bulk_machine.hpp>
+#include <fsm/dense_runtime.hpp>
+#include <fsm/instance.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <type_traits>
+
+namespace {
+
+enum class Light : uint32_t { Red, Green, Yellow, Count };
+enum class Tick : uint32_t { Timer, Reset, Count };
+
+enum class Wide { A, B };
+enum class Node : uint32_t {};
+enum class Mid { Go, Count, Stop };
+
+} // namespace
+
+template <>
+struct fsm::enum_count<Light> {
+    static constexpr auto value = static_cast<std::size_t>(Light::Count);
+};
+
+template <>
+struct fsm::enum_count<Tick> {
+    static constexpr auto value = static_cast<std::size_t>(Tick::Count);
+};
+
+template <>
+struct fsm::enum_count<Node> {
+    static constexpr std::size_t value = 1000;
+};
+
+TEST_CASE("declared enum_count narrows keys", "[fsm][memory]") {
+    STATIC_REQUIRE(fsm::has_enum_count<Light>);
+    STATIC_REQUIRE(fsm::enum_count<Light>::value == 3);
+    STATIC_REQUIRE(fsm::has_enum_count<Node>);
+    STATIC_REQUIRE_FALSE(fsm::has_enum_count<Wide>);
+    STATIC_REQUIRE_FALSE(fsm::has_enum_count<int>);
+
+    STATIC_REQUIRE(std::is_same_v<fsm::definition<Light, Tick>::key_type, uint8_t>);
+    STATIC_REQUIRE(std::is_same_v<fsm::definition<Node, Tick>::key_type, uint16_t>);
+    STATIC_REQUIRE(std::is_same_v<fsm::definition<Wide, Tick>::key_type, uint64_t>);
+    STATIC_REQUIRE(std::is_same_v<fsm::definition<int, int>::key_type, uint64_t>);
+}
+
+TEST_CASE("a Count enumerator alone does not count a type", "[fsm][memory]") {
+    STATIC_REQUIRE_FALSE(fsm::has_enum_count<Mid>);
+    STATIC_REQUIRE(std::is_same_v<fsm::definition<Mid, Mid>::key_type, uint64_t>);
+
+    fsm::runtime<Mid, Mid> sm(Mid::Go);
+    REQUIRE(sm.add_transition({ Mid::Go, Mid::Stop, Mid::Stop, nullptr, nullptr }));
+    REQUIRE(sm.add_transition({ Mid::Stop, Mid::Count, Mid::Count, nullptr, nullptr }));
+    REQUIRE(sm.dispatch(Mid::Stop) == fsm::result::Ok);
+    REQUIRE(sm.current() == Mid::Stop);
+    REQUIRE(sm.dispatch(Mid::Count) == fsm::result::Ok);
+    REQUIRE(sm.current() == Mid::Count);
+}
+
+TEST_CASE("counted tables dispatch and reject out-of-range values", "[fsm][memory]") {
+    fsm::runtime<Light, Tick> sm(Light::Red);
+    REQUIRE(sm.add_transition({ Light::Red, Tick::Timer, Light::Green, nullptr, nullptr }));
+    REQUIRE(sm.add_transition({ Light::Green, Tick::Timer, Light::Yellow, nullptr, nullptr }));
+    REQUIRE(sm.add_transition({ Light::Yellow, Tick::Timer, Light::Red, nullptr, nullptr }));
+    REQUIRE(sm.add_transition({ Light::Green, Tick::Reset, Light::Red, nullptr, nullptr }));
+    REQUIRE_FALSE(sm.add_transition({ Light::Count, Tick::Timer, Light::Red, nullptr, nullptr }));
+    REQUIRE_FALSE(sm.add_transition({ Light::Red, Tick::Count, Light::Red, nullptr, nullptr }));
+    REQUIRE_FALSE(sm.add_transition({ Light::Red, Tick::Reset, Light::Count, nullptr, nullptr }));
+    REQUIRE(sm.size() == 4);
+
+    for (bool frozen : { false, true }) {
+        if (frozen) {
+            sm.freeze();
+        }
+        REQUIRE(sm.dispatch(Tick::Timer) == fsm::result::Ok);
+        REQUIRE(sm.current() == Light::Green);
+        /* Green * 2 + Count would alias Yellow/Timer without the range check. */
+        REQUIRE(sm.dispatch(Tick::Count) == fsm::result::NoTransition);
+        REQUIRE(sm.dispatch(Tick::Reset) == fsm::result::Ok);
+        REQUIRE(sm.current() == Light::Red);
+    }
+}
+
+TEST_CASE("memory_usage reports table and instance bytes", "[fsm][memory]") {
+    fsm::definition<Light, Tick> def;
+    def.add_transition({ Light::Red, Tick::Timer, Light::Green, nullptr, nullptr });
+    def.add_transition({ Light::Green, Tick::Timer, Light::Red, nullptr, nullptr });
+
+    const auto building = def.memory_usage();
+    REQUIRE(building.hot >= 2 * 2);
+    REQUIRE(building.cold >= 2 * sizeof(fsm::definition<Light, Tick>::Transition));
+    REQUIRE(building.callables == 2 * (sizeof(fsm::definition<Light, Tick>::Guard)
+                                     + sizeof(fsm::definition<Light, Tick>::Action)));
+    REQUIRE(building.index > 0);
+    REQUIRE(building.instances == 0);
+
+    def.freeze();
+    REQUIRE(def.memory_usage().index > 0);
+    REQUIRE(def.memory_usage().total() == def.memory_usage().hot + def.memory_usage().cold
+                                          + def.memory_usage().index);
+
+    fsm::instance<Light, Tick> inst(def, Light::Red);
+    REQUIRE(inst.memory_usage().per_instance == sizeof(inst));
+
+    fsm::bulk_machine<Light, Tick, 3, 2> bulk(def, 1000, Light::Red);
+    const auto b = bulk.memory_usage();
+    REQUIRE(b.per_instance == 1);
+    REQUIRE(b.instances == 1000);
+    REQUIRE(b.hot >= 3 * 2);
+
+    fsm::dense_runtime<int, int, 4, 2> dense(0);
+    dense.add_transition({ 0, 0, 1, nullptr, nullptr });
+    REQUIRE(dense.memory_usage().cold >= 8 * sizeof(fsm::definition<int, int>::Transition));
+    REQUIRE(dense.memory_usage().per_instance == sizeof(int));
+}
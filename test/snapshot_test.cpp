@@ -0,0 +1,157 @@
+#include <fsm/atomic_runtime.hpp>
+#include <fsm/bulk_machine.hpp>
+#include <fsm/dense_runtime.hpp>
+#include <fsm/instance.hpp>
+#include <fsm/runtime.hpp>
+#include <fsm/timing_wheel.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+enum class State { Idle, Running, Paused, Done, Count };
+enum class Event { Start, Pause, Resume, Finish, Count };
+
+} // namespace
+
+template <>
+struct fsm::enum_count<State> {
+    static constexpr auto value = static_cast<std::size_t>(State::Count);
+};
+
+template <>
+struct fsm::enum_count<Event> {
+    static constexpr auto value = static_cast<std::size_t>(Event::Count);
+};
+
+namespace {
+
+struct Context {
+    int started = 0;
+};
+
+template <class Machine>
+void populate(Machine& sm) {
+    sm.add_transition({ State::Idle, Event::Start, State::Running, nullptr,
+                        [](Context& c) { ++c.started; } });
+    sm.add_transition({ State::Running, Event::Pause, State::Paused, nullptr, nullptr });
+    sm.add_transition({ State::Paused, Event::Resume, State::Running, nullptr, nullptr });
+    sm.add_transition({ State::Running, Event::Finish, State::Done, nullptr, nullptr });
+}
+
+} // namespace
+
+TEST_CASE("runtime state round-trips through raw snapshot bytes", "[fsm][snapshot]") {
+    STATIC_REQUIRE(std::is_trivially_copyable_v<fsm::machine_snapshot<State>>);
+
+    fsm::runtime<State, Event, Context> sm(State::Idle);
+    populate(sm);
+    Context ctx;
+    sm.dispatch(Event::Start, ctx);
+    sm.dispatch(Event::Pause, ctx);
+
+    unsigned char bytes[sizeof(fsm::machine_snapshot<State>)];
+    const auto snap = sm.snapshot();
+    std::memcpy(bytes, &snap, sizeof(snap));
+    REQUIRE(snap.state == State::Paused);
+    REQUIRE(snap.timeout_left == 0);
+
+    fsm::runtime<State, Event, Context> other(State::Idle);
+    populate(other);
+    fsm::machine_snapshot<State> loaded;
+    std::memcpy(&loaded, bytes, sizeof(loaded));
+    REQUIRE(other.restore(loaded));
+    REQUIRE(other.current() == State::Paused);
+    REQUIRE(ctx.started == 1); /* restoring runs no action */
+    REQUIRE(other.dispatch(Event::Resume, ctx) == fsm::result::Ok);
+
+    REQUIRE_FALSE(other.restore({ State::Count }));
+    REQUIRE(other.current() == State::Running);
+}
+
+TEST_CASE("a pending timeout migrates with its remaining ticks", "[fsm][snapshot]") {
+    using Timed = fsm::runtime<State, Event, Context, fsm::no_instrumentation,
+                               fsm::wheel_timers>;
+    fsm::timing_wheel here(100);
+    Timed sm(State::Idle);
+    populate(sm);
+    sm.add_timeout(State::Paused, 50, State::Done);
+    Context ctx;
+    sm.attach_timers(here, ctx);
+    sm.dispatch(Event::Start, ctx);
+    sm.dispatch(Event::Pause, ctx);
+    here.tick(130);
+    const auto snap = sm.snapshot();
+    REQUIRE(snap.timeout_left == 20);
+
+    fsm::timing_wheel there(9000);
+    Timed moved(State::Idle);
+    populate(moved);
+    moved.add_timeout(State::Paused, 50, State::Done);
+    moved.attach_timers(there, ctx);
+    REQUIRE(moved.restore(snap));
+    REQUIRE(moved.timeout_timer().deadline() == 9020);
+    there.tick(9020);
+    REQUIRE(moved.current() == State::Done);
+
+    /* Without a remaining count the timeout restarts in full. */
+    REQUIRE(moved.restore({ State::Paused }));
+    REQUIRE(moved.timeout_timer().deadline() == 9070);
+}
+
+TEST_CASE("instances and the other backends restore too", "[fsm][snapshot]") {
+    fsm::definition<State, Event, Context> def;
+    populate(def);
+    def.freeze();
+    fsm::instance<State, Event, Context> inst(def, State::Idle);
+    REQUIRE(inst.restore({ State::Paused }));
+    REQUIRE(inst.snapshot().state == State::Paused);
+    REQUIRE_FALSE(inst.restore({ State::Count }));
+
+    fsm::atomic_runtime<State, Event, Context> atomic(State::Idle);
+    populate(atomic);
+    REQUIRE(atomic.restore(inst.snapshot()));
+    REQUIRE(atomic.current() == State::Paused);
+    REQUIRE(atomic.snapshot().state == State::Paused);
+
+    fsm::dense_runtime<State, Event, 4, 4, Context> dense(State::Idle);
+    populate(dense);
+    REQUIRE(dense.restore({ State::Done }));
+    REQUIRE(dense.snapshot().state == State::Done);
+    REQUIRE_FALSE(dense.restore({ State::Count }));
+    REQUIRE(dense.current() == State::Done);
+}
+
+TEST_CASE("bulk states export and import as one block", "[fsm][snapshot]") {
+    fsm::definition<State, Event, Context> def;
+    populate(def);
+    def.freeze();
+    Context ctx;
+    fsm::bulk_machine<State, Event, 4, 4, Context> bulk(def, 1000, State::Idle);
+    bulk.dispatch_all(Event::Start, ctx);
+    const std::size_t ids[] = { 3, 500 };
+    const Event evs[] = { Event::Pause, Event::Finish };
+    bulk.dispatch_batch(ids, evs, ctx);
+
+    std::vector<uint8_t> checkpoint(bulk.size());
+    REQUIRE(bulk.export_states(checkpoint) == 1000);
+    REQUIRE(bulk.states().size_bytes() == 1000);
+    REQUIRE(checkpoint[3] == static_cast<uint8_t>(State::Paused));
+
+    fsm::bulk_machine<State, Event, 4, 4, Context> restored(def, 1000, State::Idle);
+    REQUIRE(restored.import_states(bulk.states()));
+    REQUIRE(restored.state(3) == State::Paused);
+    REQUIRE(restored.state(500) == State::Done);
+    REQUIRE(restored.state(7) == State::Running);
+    REQUIRE(ctx.started == 1000);
+
+    checkpoint[9] = 4;
+    REQUIRE_FALSE(restored.import_states(checkpoint));
+    REQUIRE(restored.state(9) == State::Running);
+    REQUIRE_FALSE(restored.import_states(std::span(checkpoint).first(10)));
+    std::vector<uint8_t> part(10);
+    REQUIRE(restored.export_states(part) == 10);
+}
@@ -0,0 +1,71 @@
+#include <fsm/runtime.hpp>
+#include <fsm/static_machine.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+enum class Light { Red, Green, Yellow };
+enum class Event { Timer, Reset };
+
+struct Context {
+    int counter = 0;
+    bool allow = true;
+};
+
+using Machine = fsm::static_machine<Light, Event, Context,
+    fsm::transition<Light::Red, Event::Timer, Light::Green, nullptr,
+        [](Context& ctx) { ctx.counter++; }>,
+    fsm::transition<Light::Green, Event::Timer, Light::Yellow,
+        [](const Context& ctx) { return ctx.allow; }>,
+    fsm::transition<Light::Yellow, Event::Timer, Light::Red>>;
+
+using Recognizer = fsm::static_machine<int, int, void,
+    fsm::transition<0, 1, 1>,
+    fsm::transition<1, 1, 2>,
+    fsm::transition<2, 0, 0>>;
+
+constexpr int run_recognizer() {
+    Recognizer sm(0);
+    sm.dispatch(1);
+    sm.dispatch(1);
+    sm.dispatch(7);
+    return sm.current();
+}
+
+} // namespace
+
+TEST_CASE("static machine transition flow", "[fsm][static]") {
+    Machine sm(Light::Red);
+    Context ctx;
+
+    REQUIRE(sm.dispatch(Event::Timer, ctx) == Machine::Result::Ok);
+    REQUIRE(sm.current() == Light::Green);
+    REQUIRE(ctx.counter == 1);
+
+    ctx.allow = false;
+    REQUIRE(sm.dispatch(Event::Timer, ctx) == Machine::Result::GuardRejected);
+    REQUIRE(sm.current() == Light::Green);
+
+    REQUIRE(sm.dispatch(Event::Reset, ctx) == Machine::Result::NoTransition);
+
+    ctx.allow = true;
+    REQUIRE(sm.dispatch(Event::Timer, ctx) == Machine::Result::Ok);
+    REQUIRE(sm.dispatch(Event::Timer, ctx) == Machine::Result::Ok);
+    REQUIRE(sm.current() == Light::Red);
+    REQUIRE(Machine::size() == 3);
+}
+
+TEST_CASE("static machine dispatch is constexpr", "[fsm][static]") {
+    static_assert(run_recognizer() == 2);
+    STATIC_REQUIRE(Recognizer(0).current() == 0);
+}
+
+TEST_CASE("static machine shares the runtime result type", "[fsm][static]") {
+    fsm::runtime<int, int> rt(0);
+    rt.add_transition({ 0, 1, 1, nullptr, nullptr });
+    Recognizer st(0);
+    REQUIRE(rt.dispatch(1) == st.dispatch(1));
+    REQUIRE(rt.dispatch(5) == st.dispatch(5));
+    REQUIRE(rt.current() == st.current());
+    REQUIRE(Recognizer::to_dot().rfind("digraph FSM", 0) == 0);
+}
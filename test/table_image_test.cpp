@@ -0,0 +1,236 @@
+#include <fsm/runtime.hpp>
+#include <fsm/table_image.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+enum class State : uint8_t { Idle, Small, Large, Rejected, Closed, Active, Count };
+enum class Event : uint8_t { Order, Reset, Close, Noise, Count };
+
+} // namespace
+
+template <>
+struct fsm::enum_count<State> {
+    static constexpr auto value = static_cast<std::size_t>(State::Count);
+};
+
+template <>
+struct fsm::enum_count<Event> {
+    static constexpr auto value = static_cast<std::size_t>(Event::Count);
+};
+
+namespace {
+
+struct Context {
+    int amount = 0;
+    int orders = 0;
+};
+
+using Def = fsm::definition<State, Event, Context>;
+using View = fsm::table_view<State, Event, Context>;
+
+/* Guard slots: 0 = small, 1 = large.  Action slot 0 = count. */
+void populate(Def& def, std::vector<fsm::callable_ids>& ids) {
+    auto small = [](const Context& c) { return c.amount < 100; };
+    auto large = [](const Context& c) { return c.amount < 10000; };
+    auto count = [](Context& c) { ++c.orders; };
+    def.append_transition({ State::Active, Event::Order, State::Small, small, count });
+    def.append_transition({ State::Active, Event::Order, State::Large, large, count });
+    def.append_transition({ State::Active, Event::Order, State::Rejected, nullptr, nullptr });
+    def.add_transition({ State::Small, Event::Reset, State::Active, nullptr, nullptr });
+    def.add_any_state(Event::Close, State::Closed);
+    def.add_default(State::Rejected, State::Active);
+    def.set_parent(State::Large, State::Small);
+    ids = { { 0, 0 }, { 1, 0 } };
+}
+
+/* Image bytes with the 8-byte alignment a mapping would give. */
+struct aligned_image {
+    std::vector<uint64_t> words;
+    explicit aligned_image(const std::string& s) : words((s.size() + 7) / 8) {
+        std::memcpy(words.data(), s.data(), s.size());
+    }
+    std::span<const char> bytes() const {
+        return { reinterpret_cast<const char*>(words.data()), words.size() * 8 };
+    }
+};
+
+/* Copy of `blob` with one field changed through its header. */
+template <class Patch>
+aligned_image patched(const std::string& blob, Patch patch) {
+    aligned_image img(blob);
+    char* base = reinterpret_cast<char*>(img.words.data());
+    fsm::image_header h;
+    std::memcpy(&h, base, sizeof(h));
+    patch(h, base);
+    std::memcpy(base, &h, sizeof(h));
+    return img;
+}
+
+fsm::image_record* records(const fsm::image_header& h, char* base) {
+    return reinterpret_cast<fsm::image_record*>(base + h.records);
+}
+
+} // namespace
+
+TEST_CASE("a saved image dispatches like its definition", "[fsm][image]") {
+    Def def;
+    std::vector<fsm::callable_ids> ids;
+    populate(def, ids);
+    std::string blob;
+    REQUIRE_FALSE(fsm::save_image(def, blob));
+    def.freeze();
+    const std::string_view guard_names[] = { "small", "large" };
+    const std::string_view action_names[] = { "count" };
+    REQUIRE(fsm::save_image(def, blob, { ids, guard_names, action_names }));
+
+    aligned_image img(blob);
+    View view;
+    REQUIRE(view.open(img.bytes()));
+    REQUIRE(view.size() == def.size());
+    REQUIRE(view.guard_slots() == 2);
+    REQUIRE(view.action_slots() == 1);
+    REQUIRE_FALSE(view.bound());
+    REQUIRE(view.bind_guard("small", [](const Context& c) { return c.amount < 100; }));
+    REQUIRE(view.bind_guard(1, [](const Context& c) { return c.amount < 10000; }));
+    REQUIRE(view.bind_action("count", [](Context& c) { ++c.orders; }));
+    REQUIRE_FALSE(view.bind_guard("missing", nullptr));
+    REQUIRE_FALSE(view.bind_action(1, nullptr));
+    REQUIRE(view.bound());
+
+    const std::vector<std::pair<int, Event>> script = {
+        { 5, Event::Order }, { 0, Event::Reset }, { 500, Event::Order },
+        { 0, Event::Reset }, { 50000, Event::Order }, { 0, Event::Noise },
+        { 0, Event::Order }, { 0, Event::Close }, { 0, Event::Noise },
+    };
+    State a = State::Active, b = State::Active;
+    Context ca, cb;
+    for (const auto& [amount, ev] : script) {
+        ca.amount = cb.amount = amount;
+        REQUIRE(def.dispatch(a, ev, ca) == view.dispatch(b, ev, cb));
+        REQUIRE(a == b);
+        REQUIRE(def.ordinal(a, ev) == view.ordinal(b, ev));
+    }
+    REQUIRE(ca.orders == cb.orders);
+    REQUIRE(cb.orders == 3);
+}
+
+TEST_CASE("unbound guards reject and unbound actions are skipped", "[fsm][image]") {
+    Def def;
+    std::vector<fsm::callable_ids> ids;
+    populate(def, ids);
+    def.freeze();
+    std::string blob;
+    REQUIRE(fsm::save_image(def, blob, { ids }));
+    aligned_image img(blob);
+    View view;
+    REQUIRE(view.open(img.bytes()));
+    REQUIRE_FALSE(view.bind_guard("small", nullptr));
+
+    Context ctx;
+    State s = State::Active;
+    /* Both guards reject, so the unguarded else candidate is taken. */
+    REQUIRE(view.dispatch(s, Event::Order, ctx) == fsm::result::Ok);
+    REQUIRE(s == State::Rejected);
+    REQUIRE(ctx.orders == 0);
+}
+
+TEST_CASE("corrupt or mismatched images are rejected", "[fsm][image]") {
+    Def def;
+    std::vector<fsm::callable_ids> ids;
+    populate(def, ids);
+    def.freeze();
+    std::string blob;
+    REQUIRE(fsm::save_image(def, blob, { ids }));
+
+    View view;
+    REQUIRE_FALSE(view.open({}));
+    REQUIRE_FALSE(view.open(aligned_image(blob.substr(0, blob.size() - 8)).bytes()));
+    std::string bad = blob;
+    bad[0] = 'X';
+    REQUIRE_FALSE(view.open(aligned_image(bad).bytes()));
+
+    const aligned_image img(blob);
+    REQUIRE_FALSE(view.open(img.bytes().subspan(1)));
+    fsm::table_view<int, int, Context> other;
+    REQUIRE_FALSE(other.open(img.bytes()));
+    REQUIRE(view.open(img.bytes()));
+    REQUIRE(view.is_open());
+
+    /* Indices the view would follow must stay inside the image. */
+    const auto fallback_past_end = patched(blob, [](fsm::image_header& h, char* base) {
+        REQUIRE(h.any_state_count == 1);
+        reinterpret_cast<fsm::image_fallback*>(base + h.any_state)->ordinal =
+            h.transitions;
+    });
+    REQUIRE_FALSE(view.open(fallback_past_end.bytes()));
+    REQUIRE_FALSE(view.is_open());
+    const auto default_past_end = patched(blob, [](fsm::image_header& h, char* base) {
+        REQUIRE(h.default_count == 1);
+        reinterpret_cast<fsm::image_fallback*>(base + h.defaults)->ordinal =
+            h.transitions + 7;
+    });
+    REQUIRE_FALSE(view.open(default_past_end.bytes()));
+    const auto open_last = patched(blob, [](fsm::image_header& h, char* base) {
+        records(h, base)[h.transitions - 1].next = 1;
+    });
+    REQUIRE_FALSE(view.open(open_last.bytes()));
+    const auto no_buckets = patched(blob, [](fsm::image_header& h, char*) {
+        REQUIRE(h.slot_count > 0);
+        h.disp_count = 0;
+    });
+    REQUIRE_FALSE(view.open(no_buckets.bytes()));
+    const auto wild_dst = patched(blob, [](fsm::image_header& h, char* base) {
+        records(h, base)[0].dst = static_cast<uint64_t>(State::Count);
+    });
+    REQUIRE_FALSE(view.open(wild_dst.bytes()));
+
+    /* Uncounted states accept any destination. */
+    fsm::definition<int, int> flat;
+    flat.add_transition({ 0, 0, 1, nullptr, nullptr });
+    flat.freeze();
+    std::string flat_blob;
+    REQUIRE(fsm::save_image(flat, flat_blob));
+    const auto far = patched(flat_blob, [](fsm::image_header& h, char* base) {
+        records(h, base)[0].dst = 1000;
+    });
+    fsm::table_view<int, int> flat_view;
+    REQUIRE(flat_view.open(far.bytes()));
+    int s = 0;
+    REQUIRE(flat_view.dispatch(s, 0) == fsm::result::Ok);
+    REQUIRE(s == 1000);
+}
+
+#ifdef FSM_HAS_MMAP
+TEST_CASE("images load from a mapped file", "[fsm][image]") {
+    fsm::definition<int, int> def;
+    for (int s = 0; s < 1000; ++s) {
+        def.add_transition({ s, 0, (s + 1) % 1000, nullptr, nullptr });
+    }
+    def.freeze();
+    std::string blob;
+    REQUIRE(fsm::save_image(def, blob));
+    const char* path = "fsm_image_test.bin";
+    std::ofstream(path, std::ios::binary).write(blob.data(),
+                                                static_cast<std::streamsize>(blob.size()));
+
+    fsm::mapped_file file;
+    REQUIRE(file.open(path));
+    fsm::table_view<int, int> view;
+    REQUIRE(view.open(file.bytes()));
+    int s = 998;
+    REQUIRE(view.dispatch(s, 0) == fsm::result::Ok);
+    REQUIRE(view.dispatch(s, 0) == fsm::result::Ok);
+    REQUIRE(s == 0);
+    REQUIRE(view.dispatch(s, 1) == fsm::result::NoTransition);
+    file.close();
+    REQUIRE_FALSE(file.open("does-not-exist.bin"));
+    std::remove(path);
+}
+#endif
@@ -0,0 +1,297 @@
+#include <fsm/bulk_machine.hpp>
+#include <fsm/runtime.hpp>
+#include <fsm/timing_wheel.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/* Records the wheel's clock at every expiry of the timers bound to it. */
+struct probe {
+    fsm::timing_wheel* wheel = nullptr;
+    std::vector<uint64_t> fired;
+
+    static void record(fsm::timer&, void* self) {
+        probe& p = *static_cast<probe*>(self);
+        p.fired.push_back(p.wheel->now());
+    }
+};
+
+enum class State { Idle, Connecting, Connected, Failed };
+enum class Event { Connect, Ack, Drop };
+
+struct Context {
+    int retries = 0;
+};
+
+using Timed = fsm::runtime<State, Event, Context, fsm::no_instrumentation,
+                           fsm::wheel_timers>;
+
+template <class Machine>
+void populate(Machine& sm) {
+    sm.add_transition({ State::Idle, Event::Connect, State::Connecting, nullptr, nullptr });
+    sm.add_transition({ State::Connecting, Event::Ack, State::Connected, nullptr, nullptr });
+    sm.add_transition({ State::Connecting, Event::Connect, State::Connecting, nullptr, nullptr });
+    sm.add_transition({ State::Connected, Event::Drop, State::Idle, nullptr, nullptr });
+    sm.add_timeout(State::Connecting, 10, State::Failed,
+                   [](Context& c) { ++c.retries; });
+    sm.add_timeout(State::Failed, 100, State::Idle);
+}
+
+} // namespace
+
+TEST_CASE("timers fire on their deadline tick, in order", "[fsm][timers]") {
+    fsm::timing_wheel wheel(1000);
+    probe p{ &wheel, {} };
+    std::vector<fsm::timer> timers;
+    for (int i = 0; i < 5; ++i) {
+        timers.emplace_back(&probe::record, &p);
+    }
+    /* One per level plus one in the overflow list. */
+    const uint64_t deadlines[] = { 1000 + 70000, 1000 + 5, 1000 + 300,
+                                   1000 + 20000000, 1000 + 60 };
+    for (int i = 0; i < 5; ++i) {
+        wheel.arm(timers[i], deadlines[i]);
+    }
+    REQUIRE(wheel.size() == 5);
+
+    REQUIRE(wheel.tick(1004) == 0);
+    REQUIRE(wheel.tick(1005) == 1);
+    REQUIRE(wheel.tick(1000 + 70000) == 3);
+    REQUIRE(p.fired == std::vector<uint64_t>{ 1005, 1060, 1300, 71000 });
+    REQUIRE(timers[3].armed());
+    REQUIRE(wheel.tick(1000 + 20000000 - 1) == 0);
+    REQUIRE(wheel.tick(uint64_t{1} << 40) == 1);
+    REQUIRE(p.fired.back() == 1000 + 20000000);
+    REQUIRE(wheel.empty());
+    REQUIRE(wheel.now() == uint64_t{1} << 40);
+}
+
+TEST_CASE("cancel, re-arm and past deadlines", "[fsm][timers]") {
+    fsm::timing_wheel wheel;
+    probe p{ &wheel, {} };
+    fsm::timer a(&probe::record, &p);
+    fsm::timer b(&probe::record, &p);
+
+    wheel.arm(a, 50);
+    wheel.arm(b, 50);
+    a.cancel();
+    REQUIRE_FALSE(a.armed());
+    REQUIRE(wheel.size() == 1);
+    wheel.arm(b, 80); /* re-arming moves the deadline */
+    REQUIRE(wheel.size() == 1);
+    REQUIRE(wheel.tick(79) == 0);
+    REQUIRE(wheel.tick(80) == 1);
+
+    wheel.arm(a, 10); /* already past: next tick that advances */
+    REQUIRE(a.deadline() == 81);
+    REQUIRE(wheel.tick(80) == 0);
+    REQUIRE(wheel.tick(200) == 1);
+    REQUIRE(p.fired == std::vector<uint64_t>{ 80, 81 });
+}
+
+TEST_CASE("callbacks may re-arm and timers may move", "[fsm][timers]") {
+    fsm::timing_wheel wheel;
+    struct periodic {
+        fsm::timing_wheel* wheel;
+        int runs = 0;
+        static void again(fsm::timer& t, void* self) {
+            periodic& p = *static_cast<periodic*>(self);
+            if (++p.runs < 4) {
+                p.wheel->arm_after(t, 30);
+            }
+        }
+    } per{ &wheel };
+    fsm::timer t(&periodic::again, &per);
+    wheel.arm_after(t, 30);
+    REQUIRE(wheel.tick(1000) == 4);
+    REQUIRE(per.runs == 4);
+
+    probe p{ &wheel, {} };
+    fsm::timer first(&probe::record, &p);
+    wheel.arm(first, 2000);
+    fsm::timer moved(std::move(first));
+    REQUIRE_FALSE(first.armed());
+    REQUIRE(moved.armed());
+    {
+        fsm::timer doomed(&probe::record, &p);
+        wheel.arm(doomed, 1500);
+    }
+    REQUIRE(wheel.size() == 1);
+    REQUIRE(wheel.tick(3000) == 1);
+    REQUIRE(p.fired == std::vector<uint64_t>{ 2000 });
+}
+
+TEST_CASE("runtime arms the timeout of the state it enters", "[fsm][timers]") {
+    fsm::timing_wheel wheel;
+    Timed sm(State::Idle);
+    populate(sm);
+    Context ctx;
+    sm.attach_timers(wheel, ctx);
+    REQUIRE_FALSE(sm.timeout_timer().armed());
+
+    REQUIRE(sm.dispatch(Event::Connect, ctx) == fsm::result::Ok);
+    REQUIRE(sm.timeout_timer().deadline() == 10);
+    wheel.tick(8);
+    /* A self-transition restarts the timeout. */
+    REQUIRE(sm.dispatch(Event::Connect, ctx) == fsm::result::Ok);
+    REQUIRE(sm.timeout_timer().deadline() == 18);
+    wheel.tick(17);
+    REQUIRE(sm.current() == State::Connecting);
+    REQUIRE(sm.dispatch(Event::Ack, ctx) == fsm::result::Ok);
+    REQUIRE_FALSE(sm.timeout_timer().armed());
+    wheel.tick(100);
+    REQUIRE(sm.current() == State::Connected);
+    REQUIRE(ctx.retries == 0);
+
+    /* Failed dispatches leave the timer alone; timeouts chain. */
+    REQUIRE(sm.dispatch(Event::Drop, ctx) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Connect, ctx) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Drop, ctx) == fsm::result::NoTransition);
+    REQUIRE(wheel.tick(110) == 1);
+    REQUIRE(sm.current() == State::Failed);
+    REQUIRE(ctx.retries == 1);
+    REQUIRE(sm.timeout_timer().deadline() == 210);
+    REQUIRE(wheel.tick(1000) == 1);
+    REQUIRE(sm.current() == State::Idle);
+
+    sm.dispatch(Event::Connect, ctx);
+    sm.detach_timers();
+    REQUIRE(wheel.tick(5000) == 0);
+    REQUIRE(sm.current() == State::Connecting);
+}
+
+TEST_CASE("batched and deferred dispatch re-arm too", "[fsm][timers]") {
+    fsm::timing_wheel wheel(500);
+    Timed sm(State::Idle);
+    populate(sm);
+    sm.freeze();
+    Context ctx;
+    sm.attach_timers(wheel, ctx);
+
+    const Event evs[] = { Event::Connect, Event::Ack, Event::Drop, Event::Connect };
+    REQUIRE(sm.dispatch_many(evs, ctx) == 4);
+    REQUIRE(sm.timeout_timer().deadline() == 510);
+
+    fsm::action_ticket t;
+    REQUIRE(sm.dispatch_deferred(Event::Ack, ctx, t) == fsm::result::Ok);
+    REQUIRE_FALSE(sm.timeout_timer().armed());
+}
+
+TEST_CASE("default policy keeps timeouts inert", "[fsm][timers]") {
+    fsm::runtime<State, Event, Context> sm(State::Idle);
+    populate(sm);
+    REQUIRE(sm.table().timeouts().size() == 2);
+    REQUIRE(sm.table().timeout(State::Connecting)->dst == State::Failed);
+    REQUIRE(sm.table().timeout(State::Idle) == nullptr);
+    REQUIRE(sm.add_timeout(State::Failed, 5, State::Idle));
+    REQUIRE(sm.table().timeouts().size() == 2);
+    REQUIRE(sm.table().timeout(State::Failed)->after == 5);
+    sm.freeze();
+    REQUIRE_FALSE(sm.add_timeout(State::Idle, 5, State::Failed));
+
+    const std::string dot = sm.to_dot();
+    REQUIRE(dot.find("\"1\" -> \"3\" [label=\"after 10\", style=dashed];")
+            != std::string::npos);
+}
+
+TEST_CASE("bulk instances time out independently", "[fsm][timers]") {
+    fsm::definition<State, Event, Context> def;
+    populate(def);
+    def.freeze();
+    fsm::timing_wheel wheel;
+    Context ctx;
+    fsm::bulk_machine<State, Event, 4, 3, Context, fsm::wheel_timers>
+        bulk(def, 4, State::Idle);
+    bulk.attach_timers(wheel, ctx);
+
+    bulk.dispatch_all(Event::Connect, ctx);
+    for (std::size_t i = 0; i < 4; ++i) {
+        REQUIRE(bulk.timeout_timer(i).deadline() == 10);
+    }
+    wheel.tick(5);
+    const std::size_t ids[] = { 1, 2 };
+    const Event acks[] = { Event::Ack, Event::Connect };
+    REQUIRE(bulk.dispatch_batch(ids, acks, ctx) == 2);
+
+    REQUIRE(wheel.tick(10) == 2);
+    REQUIRE(bulk.state(0) == State::Failed);
+    REQUIRE(bulk.state(1) == State::Connected);
+    REQUIRE(bulk.state(2) == State::Connecting);
+    REQUIRE(bulk.state(3) == State::Failed);
+    REQUIRE(wheel.tick(15) == 1);
+    REQUIRE(bulk.state(2) == State::Failed);
+    REQUIRE(ctx.retries == 3);
+    REQUIRE(bulk.memory_usage().per_instance == 1 + sizeof(fsm::timer));
+
+    bulk.detach_timers();
+    REQUIRE(wheel.empty());
+}
+
+TEST_CASE("callbacks re-arm across block boundaries", "[fsm][timers]") {
+    /* Re-arms one tick ahead until it has fired at every deadline. */
+    struct chain {
+        fsm::timing_wheel* wheel;
+        std::vector<uint64_t> fired;
+        static void step(fsm::timer& t, void* self) {
+            chain& c = *static_cast<chain*>(self);
+            c.fired.push_back(c.wheel->now());
+            if (c.fired.size() < 3) {
+                c.wheel->arm_after(t, 1);
+            }
+        }
+    };
+    for (const uint64_t edge : { uint64_t{63}, uint64_t{4095} }) {
+        fsm::timing_wheel wheel;
+        chain c{ &wheel, {} };
+        fsm::timer t(&chain::step, &c);
+        wheel.arm(t, edge);
+        REQUIRE(wheel.tick(edge + 1000) == 3);
+        REQUIRE(c.fired == std::vector<uint64_t>{ edge, edge + 1, edge + 2 });
+        REQUIRE_FALSE(t.armed());
+        REQUIRE(wheel.now() == edge + 1000);
+    }
+
+    /* A re-arm onto the next block's last tick, and onto the block after. */
+    fsm::timing_wheel wheel;
+    probe p{ &wheel, {} };
+    fsm::timer near(&probe::record, &p);
+    fsm::timer far(&probe::record, &p);
+    struct hop {
+        fsm::timing_wheel* wheel;
+        fsm::timer* near;
+        fsm::timer* far;
+        static void go(fsm::timer&, void* self) {
+            hop& h = *static_cast<hop*>(self);
+            h.wheel->arm_after(*h.near, 64);
+            h.wheel->arm_after(*h.far, 65);
+        }
+    } h{ &wheel, &near, &far };
+    fsm::timer trigger(&hop::go, &h);
+    wheel.arm(trigger, 4095);
+    REQUIRE(wheel.tick(10000) == 3);
+    REQUIRE(p.fired == std::vector<uint64_t>{ 4159, 4160 });
+
+    /* A re-arm from a span's last tick must not hide a higher-level slot
+       that cascades at the span start. */
+    fsm::timing_wheel wide;
+    probe q{ &wide, {} };
+    fsm::timer due(&probe::record, &q);
+    fsm::timer later(&probe::record, &q);
+    struct kick {
+        fsm::timing_wheel* wheel;
+        fsm::timer* later;
+        static void go(fsm::timer&, void* self) {
+            kick& k = *static_cast<kick*>(self);
+            k.wheel->arm_after(*k.later, 100);
+        }
+    } k{ &wide, &later };
+    fsm::timer edge(&kick::go, &k);
+    wide.arm(due, 8192 + 200);
+    wide.arm(edge, 8191);
+    REQUIRE(wide.tick(20000) == 3);
+    REQUIRE(q.fired == std::vector<uint64_t>{ 8291, 8392 });
+}
@@ -0,0 +1,140 @@
+#include <fsm/runtime.hpp>
+#include <fsm/trace.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum class State { Idle, Running, Done };
+enum class Event { Start, Stop, Finish };
+
+template <class Policy>
+void populate(fsm::runtime<State, Event, void, Policy>& sm) {
+    sm.add_transition({ State::Idle, Event::Start, State::Running, nullptr, nullptr });
+    sm.add_transition({ State::Running, Event::Stop, State::Idle, nullptr, nullptr });
+    sm.add_transition({ State::Running, Event::Finish, State::Done,
+                        [] { return false; }, nullptr });
+}
+
+} // namespace
+
+TEST_CASE("tracing policy records every dispatch", "[fsm][trace]") {
+    fsm::runtime<State, Event, void, fsm::tracing_instrumentation<8>> sm(State::Idle);
+    populate(sm);
+
+    REQUIRE(sm.dispatch(Event::Start) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Start) == fsm::result::NoTransition);
+    REQUIRE(sm.dispatch(Event::Finish) == fsm::result::GuardRejected);
+    REQUIRE(sm.dispatch(Event::Stop) == fsm::result::Ok);
+
+    const auto recs = sm.instrumentation().trace().records();
+    REQUIRE(recs.size() == 4);
+    REQUIRE(recs[0].src == 0);
+    REQUIRE(recs[0].ev == 0);
+    REQUIRE(recs[0].dst == 1);
+    REQUIRE(recs[0].outcome == fsm::result::Ok);
+    REQUIRE(recs[1].outcome == fsm::result::NoTransition);
+    REQUIRE(recs[1].dst == recs[1].src);
+    REQUIRE(recs[2].outcome == fsm::result::GuardRejected);
+    REQUIRE(recs[3].dst == 0);
+    for (std::size_t i = 1; i < recs.size(); ++i) {
+        REQUIRE(recs[i].timestamp >= recs[i - 1].timestamp);
+    }
+}
+
+TEST_CASE("trace ring keeps the newest records", "[fsm][trace]") {
+    fsm::trace_ring<4> ring;
+    for (uint32_t i = 0; i < 10; ++i) {
+        ring.push({ i, i, 0, 0, fsm::result::Ok });
+    }
+    REQUIRE(ring.written() == 10);
+    REQUIRE(ring.size() == 4);
+    const auto recs = ring.records();
+    REQUIRE(recs.size() == 4);
+    REQUIRE(recs.front().src == 6);
+    REQUIRE(recs.back().src == 9);
+
+    ring.clear();
+    REQUIRE(ring.records().empty());
+}
+
+TEST_CASE("dumped traces parse back", "[fsm][trace]") {
+    fsm::trace_ring<16> ring;
+    ring.record(State::Idle, Event::Start, State::Running, fsm::result::Ok);
+    ring.record(State::Running, Event::Finish, State::Running,
+                fsm::result::GuardRejected);
+
+    const std::string blob = ring.dump();
+    REQUIRE(blob.size() == sizeof(fsm::trace_header) + 2 * sizeof(fsm::trace_record));
+
+    std::vector<fsm::trace_record> recs;
+    REQUIRE(fsm::parse_trace(blob, recs));
+    REQUIRE(recs.size() == 2);
+    REQUIRE(recs[1].ev == 2);
+    REQUIRE(recs[1].outcome == fsm::result::GuardRejected);
+
+    REQUIRE_FALSE(fsm::parse_trace(std::string("FSMTRACX"), recs));
+    REQUIRE_FALSE(fsm::parse_trace(blob.substr(0, blob.size() - 1), recs));
+}
+
+TEST_CASE("edge counts overlay trace frequencies on the DOT graph", "[fsm][trace]") {
+    fsm::runtime<State, Event, void, fsm::tracing_instrumentation<64>> sm(State::Idle);
+    populate(sm);
+    for (int i = 0; i < 3; ++i) {
+        sm.dispatch(Event::Start);
+        sm.dispatch(Event::Stop);
+    }
+    sm.dispatch(Event::Start);
+    sm.dispatch(Event::Finish);
+
+    const auto recs = sm.instrumentation().trace().records();
+    const auto counts = fsm::edge_counts(sm.table(), recs);
+    REQUIRE(counts == std::vector<uint64_t>{ 4, 3, 0 });
+
+    const std::string dot = sm.to_dot(counts);
+    REQUIRE(dot.find("\"0\" -> \"1\" [label=\"0 (4)\", penwidth=5];") != std::string::npos);
+    REQUIRE(dot.find("\"1\" -> \"0\" [label=\"1 (3)\", penwidth=4];") != std::string::npos);
+    REQUIRE(dot.find("\"1\" -> \"2\" [label=\"2 (0)\", penwidth=1];") != std::string::npos);
+}
+
+TEST_CASE("thread tracing policy writes to the calling thread's ring", "[fsm][trace]") {
+    using Policy = fsm::thread_tracing_instrumentation<16>;
+    Policy::local().clear();
+    fsm::runtime<State, Event, void, Policy> a(State::Idle);
+    fsm::runtime<State, Event, void, Policy> b(State::Idle);
+    populate(a);
+    populate(b);
+    a.dispatch(Event::Start);
+    b.dispatch(Event::Start);
+
+    std::size_t other = 0;
+    std::thread([&] { other = Policy::local().size(); }).join();
+
+    REQUIRE(Policy::local().size() == 2);
+    REQUIRE(other == 0);
+}
+
+TEST_CASE("trace ring can be read while it is written", "[fsm][trace]") {
+    fsm::trace_ring<64> ring;
+    std::atomic<bool> done{ false };
+    std::thread writer([&] {
+        for (uint32_t i = 0; i < 100000; ++i) {
+            ring.push({ i, i, i, i, fsm::result::Ok });
+        }
+        done = true;
+    });
+    bool consistent = true;
+    while (!done) {
+        ring.for_each([&](const fsm::trace_record& r) {
+            consistent = consistent && r.src == r.ev && r.ev == r.dst
+                         && r.timestamp == r.src;
+        });
+    }
+    writer.join();
+    REQUIRE(consistent);
+    REQUIRE(ring.size() == 64);
+}
@@ -0,0 +1,154 @@
+#include <fsm/bulk_machine.hpp>
+#include <fsm/instrumentation.hpp>
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+namespace {
+
+enum class State { Idle, Running, Paused, Error, Closed };
+enum class Event { Start, Pause, Resume, Reset, Close, Garbage };
+
+enum class Light { Red, Green, Broken, Count };
+enum class Tick { Timer, Fault, Noise, Count };
+
+} // namespace
+
+template <>
+struct fsm::enum_count<Light> {
+    static constexpr auto value = static_cast<std::size_t>(Light::Count);
+};
+
+template <>
+struct fsm::enum_count<Tick> {
+    static constexpr auto value = static_cast<std::size_t>(Tick::Count);
+};
+
+namespace {
+
+struct Context {
+    int unexpected = 0;
+};
+
+using FSM = fsm::runtime<State, Event, Context>;
+
+void populate(FSM& sm) {
+    sm.add_transition({ State::Idle, Event::Start, State::Running, nullptr, nullptr });
+    sm.add_transition({ State::Running, Event::Pause, State::Paused, nullptr, nullptr });
+    sm.add_transition({ State::Paused, Event::Resume, State::Running, nullptr, nullptr });
+    /* Closes the machine from everywhere, except Error which must Reset first. */
+    sm.add_any_state(Event::Close, State::Closed);
+    sm.add_transition({ State::Error, Event::Close, State::Error, nullptr, nullptr });
+    sm.add_transition({ State::Error, Event::Reset, State::Idle, nullptr, nullptr });
+    /* Anything Running does not handle is a protocol violation. */
+    sm.add_default(State::Running, State::Error, nullptr,
+                   [](Context& c) { ++c.unexpected; });
+}
+
+} // namespace
+
+TEST_CASE("wildcards resolve exact, then any-state, then default", "[fsm][wildcard]") {
+    for (bool frozen : { false, true }) {
+        FSM sm(State::Idle);
+        populate(sm);
+        if (frozen) {
+            sm.freeze();
+        }
+        Context ctx;
+        REQUIRE(sm.dispatch(Event::Garbage, ctx) == fsm::result::NoTransition);
+        REQUIRE(sm.dispatch(Event::Start, ctx) == fsm::result::Ok);
+        REQUIRE(sm.dispatch(Event::Pause, ctx) == fsm::result::Ok);
+        REQUIRE(sm.dispatch(Event::Resume, ctx) == fsm::result::Ok);
+
+        /* Default catches Running's unhandled events. */
+        REQUIRE(sm.dispatch(Event::Garbage, ctx) == fsm::result::Ok);
+        REQUIRE(sm.current() == State::Error);
+        REQUIRE(ctx.unexpected == 1);
+
+        /* The exact Error/Close shadows the any-state Close. */
+        REQUIRE(sm.dispatch(Event::Close, ctx) == fsm::result::Ok);
+        REQUIRE(sm.current() == State::Error);
+        REQUIRE(sm.dispatch(Event::Reset, ctx) == fsm::result::Ok);
+
+        /* Any-state Close beats Running's default. */
+        REQUIRE(sm.dispatch(Event::Start, ctx) == fsm::result::Ok);
+        REQUIRE(sm.dispatch(Event::Close, ctx) == fsm::result::Ok);
+        REQUIRE(sm.current() == State::Closed);
+        REQUIRE(ctx.unexpected == 1);
+    }
+}
+
+TEST_CASE("wildcard entries are table entries with a kind", "[fsm][wildcard]") {
+    FSM sm(State::Idle);
+    populate(sm);
+    REQUIRE(sm.size() == 7);
+    /* Re-adding a wildcard overwrites it. */
+    REQUIRE(sm.add_any_state(Event::Close, State::Idle));
+    REQUIRE(sm.add_default(State::Running, State::Paused));
+    REQUIRE(sm.size() == 7);
+
+    const auto& def = sm.table();
+    const uint32_t any = def.ordinal(State::Paused, Event::Close);
+    const uint32_t dflt = def.ordinal(State::Running, Event::Garbage);
+    REQUIRE(def.kind(any) == fsm::transition_kind::AnyState);
+    REQUIRE(def.kind(dflt) == fsm::transition_kind::Default);
+    REQUIRE(def.kind(def.ordinal(State::Idle, Event::Start)) == fsm::transition_kind::Exact);
+    REQUIRE(def.transitions()[any].dst == State::Idle);
+    REQUIRE(def.transitions()[dflt].dst == State::Paused);
+
+    sm.freeze();
+    REQUIRE_FALSE(sm.add_any_state(Event::Reset, State::Idle));
+    REQUIRE_FALSE(sm.add_default(State::Idle, State::Idle));
+
+    const std::string dot = sm.to_dot();
+    REQUIRE(dot.find("\"*\" -> \"0\" [label=\"4\"];") != std::string::npos);
+    REQUIRE(dot.find("\"1\" -> \"2\" [label=\"*\"];") != std::string::npos);
+}
+
+TEST_CASE("wildcards survive layout changes and feed instrumentation", "[fsm][wildcard]") {
+    fsm::runtime<State, Event, Context, fsm::counting_instrumentation<>> sm(State::Idle);
+    sm.add_transition({ State::Idle, Event::Start, State::Running, nullptr, nullptr });
+    sm.add_any_state(Event::Close, State::Closed);
+    sm.add_default(State::Closed, State::Idle);
+
+    Context ctx;
+    REQUIRE(sm.dispatch(Event::Close, ctx) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Pause, ctx) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Close, ctx) == fsm::result::Ok);
+    const auto snap = sm.instrumentation().snapshot();
+    REQUIRE(snap.hits[1] == 2);
+    REQUIRE(snap.hits[2] == 1);
+
+    sm.freeze(snap.hits);
+    REQUIRE(sm.table().kind(0) == fsm::transition_kind::AnyState);
+    REQUIRE(sm.dispatch(Event::Reset, ctx) == fsm::result::Ok);
+    REQUIRE(sm.current() == State::Idle);
+    REQUIRE(sm.dispatch(Event::Start, ctx) == fsm::result::Ok);
+    REQUIRE(sm.dispatch(Event::Close, ctx) == fsm::result::Ok);
+    REQUIRE(sm.current() == State::Closed);
+}
+
+TEST_CASE("counted types use flat fallback arrays", "[fsm][wildcard]") {
+    fsm::definition<Light, Tick> def;
+    def.add_transition({ Light::Red, Tick::Timer, Light::Green, nullptr, nullptr });
+    def.add_transition({ Light::Green, Tick::Timer, Light::Red, nullptr, nullptr });
+    REQUIRE(def.add_any_state(Tick::Fault, Light::Broken));
+    REQUIRE(def.add_default(Light::Broken, Light::Broken));
+    REQUIRE_FALSE(def.add_any_state(Tick::Count, Light::Red));
+    REQUIRE_FALSE(def.add_default(Light::Count, Light::Red));
+    def.freeze();
+    REQUIRE(def.memory_usage().index > 0);
+
+    Light s = Light::Red;
+    REQUIRE(def.dispatch(s, Tick::Noise) == fsm::result::NoTransition);
+    REQUIRE(def.dispatch(s, Tick::Count) == fsm::result::NoTransition);
+    REQUIRE(def.dispatch(s, Tick::Fault) == fsm::result::Ok);
+    REQUIRE(s == Light::Broken);
+    REQUIRE(def.dispatch(s, Tick::Timer) == fsm::result::Ok);
+    REQUIRE(s == Light::Broken);
+
+    fsm::bulk_machine<Light, Tick, 3, 3> bulk(def, 8, Light::Green);
+    bulk.dispatch_all(Tick::Fault);
+    bulk.dispatch_all(Tick::Noise);
+    REQUIRE(bulk.state(7) == Light::Broken);
+}
@@ -0,0 +1,90 @@
+#include <fsm/runtime.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+namespace {
+
+enum class State { Closed, Connected, Open, Idle, Busy };
+enum class Event { Connect, Work, Done, Drop, Ping };
+
+std::size_t occurrences(const std::string& text, const std::string& what) {
+    std::size_t n = 0;
+    for (auto pos = text.find(what); pos != std::string::npos;
+         pos = text.find(what, pos + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+void populate(fsm::runtime<State, Event>& sm) {
+    sm.add_transition({ State::Closed, Event::Connect, State::Idle, nullptr, nullptr });
+    sm.add_transition({ State::Idle, Event::Work, State::Busy, nullptr, nullptr });
+    sm.add_transition({ State::Busy, Event::Done, State::Idle, nullptr, nullptr });
+    sm.add_transition({ State::Busy, Event::Ping, State::Idle, nullptr, nullptr });
+    sm.add_transition({ State::Connected, Event::Drop, State::Closed, nullptr, nullptr });
+    sm.set_parent(State::Open, State::Connected);
+    sm.set_parent(State::Idle, State::Open);
+    sm.set_parent(State::Busy, State::Open);
+}
+
+} // namespace
+
+TEST_CASE("write_dot streams the same text as to_dot", "[fsm][write_dot]") {
+    fsm::runtime<State, Event> sm(State::Closed);
+    populate(sm);
+    sm.add_any_state(Event::Ping, State::Closed);
+
+    std::ostringstream os;
+    sm.write_dot(os);
+    REQUIRE(os.str() == sm.to_dot());
+
+    std::string s;
+    sm.write_dot(std::back_inserter(s));
+    REQUIRE(s == sm.to_dot());
+
+    const uint64_t counts[] = { 9, 3, 3, 0, 1 };
+    std::string weighted;
+    fsm::dot_options opt;
+    opt.counts = counts;
+    sm.write_dot(std::back_inserter(weighted), opt);
+    REQUIRE(weighted == sm.to_dot(counts));
+    REQUIRE(weighted.find("\"0\" -> \"3\" [label=\"0 (9)\", penwidth=5];") != std::string::npos);
+}
+
+TEST_CASE("parallel edges merge into one", "[fsm][write_dot]") {
+    fsm::runtime<State, Event> sm(State::Closed);
+    populate(sm);
+
+    fsm::dot_options opt;
+    opt.merge_parallel = true;
+    std::string s;
+    sm.write_dot(std::back_inserter(s), opt);
+    REQUIRE(s.find("\"4\" -> \"3\" [label=\"2, 4\"];") != std::string::npos);
+    REQUIRE(occurrences(s, " -> ") == 4);
+
+    const uint64_t counts[] = { 0, 0, 2, 6 };
+    opt.counts = counts;
+    std::string w;
+    sm.write_dot(std::back_inserter(w), opt);
+    REQUIRE(w.find("\"4\" -> \"3\" [label=\"2, 4 (8)\", penwidth=5];") != std::string::npos);
+}
+
+TEST_CASE("nested states are drawn as clusters", "[fsm][write_dot]") {
+    fsm::runtime<State, Event> sm(State::Closed);
+    populate(sm);
+
+    fsm::dot_options opt;
+    opt.cluster_parents = true;
+    std::ostringstream os;
+    sm.write_dot(os, opt);
+    const std::string s = os.str();
+    const auto outer = s.find("  subgraph \"cluster_1\" {\n    label=\"1\";\n    \"1\";\n");
+    const auto inner = s.find("    subgraph \"cluster_2\" {\n      label=\"2\";\n      \"2\";\n"
+                              "      \"3\";\n      \"4\";\n    }\n  }\n");
+    REQUIRE(outer != std::string::npos);
+    REQUIRE(inner != std::string::npos);
+    REQUIRE(outer < inner);
+    REQUIRE(occurrences(s, " -> ") == 5);
+}
@@ -0,0 +1,590 @@
+// fsm_stress: long-running stress and benchmark harness for dispatch under
+// concurrency.  Generates a random machine and a random event mix from a
+// seed, replays the mix across threads, and checks every instance against
+// a sequential replay on a reference fsm::runtime.
+//
+//   fsm_stress [options]
+//
+//   --states N       states in the generated machine          (default 64)
+//   --events N       distinct events                          (default 8)
+//   --fanout N       exact transitions per state              (default 4)
+//   --guards PCT     share of transitions with a guard        (default 20)
+//   --instances N    machine instances                        (default 10000)
+//   --count N        events per round                         (default 1000000)
+//   --hot PCT        share of events sent to the first 1% of
+//                    instances, to unbalance shards           (default 0)
+//   --threads N      dispatch threads / executor shards       (default: cores)
+//   --producers N    threads posting to the executor          (default 1)
+//   --rounds N       rounds, each with a fresh mix            (default 1)
+//   --seed N         seed for the machine and the mixes       (default 1)
+//   --pin            pin executor workers to CPUs
+//   --record FILE    write the first round's mix to FILE
+//   --replay FILE    replay the mix (and machine) stored in FILE every round
+//
+// Each round runs two phases over the same mix:
+//
+//   direct    every thread dispatches the events of its own block of
+//             fsm::instance objects and times each dispatch; reports
+//             events/s per core and p50/p99/p999 dispatch latency
+//   executor  producers post() into an fsm::executor whose workers drain
+//             and steal; reports events/s per core, queue-full
+//             retries and steals
+//
+// Latencies are read with fsm::detail::cycle_count() around each dispatch
+// and converted to nanoseconds against steady_clock, so they include the
+// cost of reading the clock (printed as "clock").  The exit status is 1
+// when any instance disagrees with the reference.
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fsm/definition.hpp>
+#include <fsm/executor.hpp>
+#include <fsm/instance.hpp>
+#include <fsm/instrumentation.hpp>
+#include <fsm/runtime.hpp>
+
+namespace {
+
+using State = uint32_t;
+using Event = uint32_t;
+
+/* Actions fold the ordinal of the transition into the hash, so the final
+   context of an instance depends on the order its events ran in. */
+struct Context {
+    uint64_t hash = 0;
+    uint64_t actions = 0;
+
+    bool operator==(const Context&) const = default;
+};
+
+using Definition = fsm::definition<State, Event, Context>;
+using Transition = Definition::Transition;
+
+struct params {
+    uint64_t seed = 1;
+    uint32_t states = 64;
+    uint32_t events = 8;
+    uint32_t fanout = 4;
+    uint32_t guards = 20;
+    uint32_t instances = 10000;
+    uint64_t count = 1000000;
+    uint32_t hot = 0;
+    uint32_t threads = 0;
+    uint32_t producers = 1;
+    uint32_t rounds = 1;
+    bool pin = false;
+    const char* record = nullptr;
+    const char* replay = nullptr;
+};
+
+struct message {
+    uint32_t id;
+    Event ev;
+};
+
+/* splitmix64: small, fast and the same sequence on every platform. */
+struct rng {
+    uint64_t s;
+
+    inline uint64_t next() noexcept {
+        uint64_t z = (s += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    inline uint32_t below(uint64_t n) noexcept {
+        return static_cast<uint32_t>(next() % n);
+    }
+};
+
+/* ------------------------------------------------------------ */
+/* Machine and mix generation                                   */
+/* ------------------------------------------------------------ */
+/* Every state gets `fanout` distinct events with random targets; one event
+   is also handled from any state, and every eighth state has a default
+   back to 0.  The same calls build the definition and the reference. */
+template <class Machine>
+void build(Machine& sm, const params& p) {
+    rng r{ p.seed };
+    std::vector<Event> evs(p.events);
+    const uint32_t fanout = std::min(p.fanout, p.events);
+    uint32_t ordinal = 0;
+    for (State s = 0; s < p.states; ++s) {
+        for (Event e = 0; e < p.events; ++e) {
+            evs[e] = e;
+        }
+        for (uint32_t k = 0; k < fanout; ++k) {
+            std::swap(evs[k], evs[k + r.below(p.events - k)]);
+            Transition tr{ s, evs[k], r.below(p.states), nullptr,
+                           [ordinal](Context& c) {
+                               c.hash = c.hash * 0x100000001b3ull + ordinal;
+                               ++c.actions;
+                           } };
+            if (r.below(100) < p.guards) {
+                const uint32_t bit = r.below(8);
+                tr.guard = [bit](const Context& c) {
+                    return ((c.hash >> bit) & 1) == 0;
+                };
+            }
+            sm.add_transition(tr);
+            ++ordinal;
+        }
+        if (s % 8 == 7) {
+            sm.add_default(s, 0);
+        }
+    }
+    sm.add_any_state(p.events - 1, r.below(p.states));
+    sm.freeze();
+}
+
+std::vector<message> generate(const params& p, uint64_t round) {
+    rng r{ p.seed ^ (0xa0761d6478bd642full * (round + 1)) };
+    const uint32_t hot = std::max<uint32_t>(1, p.instances / 100);
+    std::vector<message> mix(p.count);
+    for (auto& m : mix) {
+        m.id = r.below(100) < p.hot ? r.below(hot) : r.below(p.instances);
+        m.ev = r.below(p.events);
+    }
+    return mix;
+}
+
+/* Recorded mixes: a header naming the machine, then raw messages in host
+   byte order. */
+constexpr char mix_magic[8] = { 'F', 'S', 'M', 'M', 'I', 'X', '0', '1' };
+
+struct mix_header {
+    char magic[8];
+    uint64_t seed;
+    uint32_t states, events, fanout, guards, instances, reserved;
+    uint64_t count;
+};
+
+bool save_mix(const char* path, const params& p, const std::vector<message>& mix) {
+    mix_header h{};
+    std::memcpy(h.magic, mix_magic, sizeof(mix_magic));
+    h.seed = p.seed;
+    h.states = p.states;
+    h.events = p.events;
+    h.fanout = p.fanout;
+    h.guards = p.guards;
+    h.instances = p.instances;
+    h.count = mix.size();
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(mix.data()),
+              static_cast<std::streamsize>(mix.size() * sizeof(message)));
+    return static_cast<bool>(out);
+}
+
+bool load_mix(const char* path, params& p, std::vector<message>& mix) {
+    std::ifstream in(path, std::ios::binary);
+    mix_header h{};
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))
+        || std::memcmp(h.magic, mix_magic, sizeof(mix_magic)) != 0
+        || h.states == 0 || h.events == 0 || h.instances == 0) {
+        return false;
+    }
+    /* Trust the header's count only as far as the file backs it. */
+    const auto body = in.tellg();
+    if (!in.seekg(0, std::ios::end)) {
+        return false;
+    }
+    const auto avail = static_cast<uint64_t>(in.tellg() - body);
+    if (!in.seekg(body) || h.count > avail / sizeof(message)) {
+        return false;
+    }
+    mix.resize(h.count);
+    if (!in.read(reinterpret_cast<char*>(mix.data()),
+                 static_cast<std::streamsize>(mix.size() * sizeof(message)))) {
+        return false;
+    }
+    for (const auto& m : mix) {
+        if (m.id >= h.instances || m.ev >= h.events) {
+            return false;
+        }
+    }
+    p.seed = h.seed;
+    p.states = h.states;
+    p.events = h.events;
+    p.fanout = h.fanout;
+    p.guards = h.guards;
+    p.instances = h.instances;
+    p.count = h.count;
+    return true;
+}
+
+/* ------------------------------------------------------------ */
+/* Latency histogram                                            */
+/* ------------------------------------------------------------ */
+/* Log-linear buckets: exact below 64, then 32 per power of two, so a
+   percentile is off by at most 1/32 of its value. */
+class histogram {
+public:
+    inline void add(uint64_t v) noexcept {
+        ++buckets_[index(v)];
+        ++total_;
+    }
+
+    inline void merge(const histogram& o) noexcept {
+        for (std::size_t i = 0; i < size; ++i) {
+            buckets_[i] += o.buckets_[i];
+        }
+        total_ += o.total_;
+    }
+
+    /* Lower bound of the bucket holding quantile q. */
+    inline uint64_t quantile(double q) const noexcept {
+        const auto rank = static_cast<uint64_t>(q * static_cast<double>(total_));
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            seen += buckets_[i];
+            if (seen > rank) {
+                return lower(i);
+            }
+        }
+        return 0;
+    }
+
+private:
+    static constexpr std::size_t size = 64 + 58 * 32;
+
+    static inline std::size_t index(uint64_t v) noexcept {
+        if (v < 64) {
+            return static_cast<std::size_t>(v);
+        }
+        const unsigned shift = static_cast<unsigned>(std::bit_width(v)) - 6;
+        return 64 + (shift - 1) * 32 + static_cast<std::size_t>((v >> shift) - 32);
+    }
+
+    static inline uint64_t lower(std::size_t i) noexcept {
+        if (i < 64) {
+            return i;
+        }
+        const std::size_t shift = (i - 64) / 32 + 1;
+        return (((i - 64) % 32) + 32) << shift;
+    }
+
+    std::vector<uint64_t> buckets_ = std::vector<uint64_t>(size);
+    uint64_t total_ = 0;
+};
+
+/* ------------------------------------------------------------ */
+/* Phases                                                       */
+/* ------------------------------------------------------------ */
+struct phase_result {
+    double seconds = 0;
+    double ns_per_cycle = 0;
+    histogram latency;
+    uint64_t clock = 0;      /**< Cycles of an empty measurement */
+    uint64_t retries = 0;    /**< Executor: posts rejected by a full queue */
+    std::size_t steals = 0;  /**< Executor: foreign shard drains */
+};
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point t0) {
+    return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+/* Split the mix into one stream per worker, keeping mix order within each,
+   so every instance still sees its events in order. */
+template <class Owner>
+std::vector<std::vector<message>> partition(const std::vector<message>& mix,
+                                            uint32_t parts, Owner owner) {
+    std::vector<std::vector<message>> out(parts);
+    for (auto& v : out) {
+        v.reserve(mix.size() / parts + 1);
+    }
+    for (const auto& m : mix) {
+        out[owner(m.id)].push_back(m);
+    }
+    return out;
+}
+
+phase_result run_direct(const Definition& def, const params& p,
+                        const std::vector<message>& mix,
+                        std::vector<State>& states, std::vector<Context>& ctxs) {
+    std::vector<fsm::instance<State, Event, Context>> machines(
+        p.instances, fsm::instance<State, Event, Context>(def, 0));
+    std::vector<Context> contexts(p.instances);
+    const uint32_t t = p.threads;
+    const auto block = [&](uint32_t id) {
+        return static_cast<uint32_t>(uint64_t{ id } * t / p.instances);
+    };
+    const auto streams = partition(mix, t, block);
+
+    std::vector<histogram> hists(t);
+    std::vector<uint64_t> clocks(t, ~uint64_t{ 0 });
+    std::atomic<uint32_t> ready{ 0 };
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> workers;
+    for (uint32_t w = 0; w < t; ++w) {
+        workers.emplace_back([&, w] {
+            for (int i = 0; i < 1000; ++i) {
+                const uint64_t a = fsm::detail::cycle_count();
+                clocks[w] = std::min(clocks[w], fsm::detail::cycle_count() - a);
+            }
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            histogram& h = hists[w];
+            for (const auto& m : streams[w]) {
+                const uint64_t a = fsm::detail::cycle_count();
+                machines[m.id].dispatch(m.ev, contexts[m.id]);
+                h.add(fsm::detail::cycle_count() - a);
+            }
+        });
+    }
+    while (ready.load() != t) {
+        std::this_thread::yield();
+    }
+
+    phase_result res;
+    const uint64_t c0 = fsm::detail::cycle_count();
+    const auto t0 = clock_type::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : workers) {
+        th.join();
+    }
+    res.seconds = seconds_since(t0);
+    const uint64_t cycles = fsm::detail::cycle_count() - c0;
+    res.ns_per_cycle = cycles == 0 ? 0 : res.seconds * 1e9 / static_cast<double>(cycles);
+    for (uint32_t w = 0; w < t; ++w) {
+        res.latency.merge(hists[w]);
+    }
+    res.clock = *std::min_element(clocks.begin(), clocks.end());
+
+    for (uint32_t i = 0; i < p.instances; ++i) {
+        states[i] = machines[i].current();
+    }
+    ctxs = std::move(contexts);
+    return res;
+}
+
+phase_result run_executor(const Definition& def, const params& p,
+                          const std::vector<message>& mix,
+                          std::vector<State>& states, std::vector<Context>& ctxs) {
+    fsm::executor<State, Event, Context> ex(def, p.instances, 0, p.threads);
+    const uint32_t np = p.producers;
+    const auto streams = partition(mix, np, [np](uint32_t id) { return id % np; });
+    std::atomic<uint64_t> retries{ 0 };
+
+    phase_result res;
+    const auto t0 = clock_type::now();
+    ex.start(p.pin);
+    std::vector<std::thread> producers;
+    for (uint32_t w = 0; w < np; ++w) {
+        producers.emplace_back([&, w] {
+            uint64_t full = 0;
+            for (const auto& m : streams[w]) {
+                while (!ex.post(m.id, m.ev)) {
+                    ++full;
+                    std::this_thread::yield();
+                }
+            }
+            retries.fetch_add(full);
+        });
+    }
+    for (auto& th : producers) {
+        th.join();
+    }
+    while (ex.processed() < mix.size()) {
+        std::this_thread::yield();
+    }
+    res.seconds = seconds_since(t0);
+    ex.stop();
+    res.retries = retries.load();
+    res.steals = ex.steals();
+
+    for (uint32_t i = 0; i < p.instances; ++i) {
+        states[i] = ex.state(i);
+        ctxs[i] = ex.context(i);
+    }
+    return res;
+}
+
+/* Replays each instance's events, in mix order, on one reference runtime
+   and counts the instances whose state or context differ from `states`
+   and `ctxs`. */
+class reference {
+public:
+    reference(const params& p, const std::vector<message>& mix)
+        : sm_(0), states_(p.instances), ctxs_(p.instances) {
+        build(sm_, p);
+        std::vector<uint32_t> first(p.instances + 1, 0);
+        for (const auto& m : mix) {
+            ++first[m.id + 1];
+        }
+        for (uint32_t i = 0; i < p.instances; ++i) {
+            first[i + 1] += first[i];
+        }
+        std::vector<Event> evs(mix.size());
+        std::vector<uint32_t> fill(first.begin(), first.end() - 1);
+        for (const auto& m : mix) {
+            evs[fill[m.id]++] = m.ev;
+        }
+        for (uint32_t i = 0; i < p.instances; ++i) {
+            sm_.restore({ 0 });
+            for (uint32_t k = first[i]; k < first[i + 1]; ++k) {
+                sm_.dispatch(evs[k], ctxs_[i]);
+            }
+            states_[i] = sm_.current();
+        }
+    }
+
+    std::size_t mismatches(const char* phase, const std::vector<State>& states,
+                           const std::vector<Context>& ctxs) const {
+        std::size_t bad = 0;
+        for (std::size_t i = 0; i < states_.size(); ++i) {
+            if (states[i] == states_[i] && ctxs[i] == ctxs_[i]) {
+                continue;
+            }
+            if (++bad <= 5) {
+                std::printf("  %s: instance %zu in state %u (%llu actions),"
+                            " reference %u (%llu actions)\n",
+                            phase, i, states[i],
+                            static_cast<unsigned long long>(ctxs[i].actions),
+                            states_[i],
+                            static_cast<unsigned long long>(ctxs_[i].actions));
+            }
+        }
+        return bad;
+    }
+
+private:
+    fsm::runtime<State, Event, Context> sm_;
+    std::vector<State> states_;
+    std::vector<Context> ctxs_;
+};
+
+void report(const char* phase, const phase_result& r, const params& p,
+            std::size_t bad) {
+    const double rate = static_cast<double>(p.count) / r.seconds;
+    std::printf("%-9s %12.0f ev/s/core", phase, rate / p.threads);
+    if (r.ns_per_cycle > 0) {
+        const auto ns = [&](uint64_t c) { return static_cast<double>(c) * r.ns_per_cycle; };
+        std::printf("  p50 %.1f ns  p99 %.1f ns  p999 %.1f ns  clock %.1f ns",
+                    ns(r.latency.quantile(0.50)), ns(r.latency.quantile(0.99)),
+                    ns(r.latency.quantile(0.999)), ns(r.clock));
+    } else {
+        std::printf("  retries %llu  steals %zu",
+                    static_cast<unsigned long long>(r.retries), r.steals);
+    }
+    std::printf("  %s\n", bad == 0 ? "ok" : "MISMATCH");
+}
+
+bool parse(int argc, char** argv, params& p) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--pin") {
+            p.pin = true;
+            continue;
+        }
+        if (i + 1 == argc) {
+            return false;
+        }
+        const char* val = argv[++i];
+        const auto num = [val] { return std::strtoull(val, nullptr, 10); };
+        if (arg == "--states") {
+            p.states = static_cast<uint32_t>(num());
+        } else if (arg == "--events") {
+            p.events = static_cast<uint32_t>(num());
+        } else if (arg == "--fanout") {
+            p.fanout = static_cast<uint32_t>(num());
+        } else if (arg == "--guards") {
+            p.guards = static_cast<uint32_t>(num());
+        } else if (arg == "--instances") {
+            p.instances = static_cast<uint32_t>(num());
+        } else if (arg == "--count") {
+            p.count = num();
+        } else if (arg == "--hot") {
+            p.hot = static_cast<uint32_t>(num());
+        } else if (arg == "--threads") {
+            p.threads = static_cast<uint32_t>(num());
+        } else if (arg == "--producers") {
+            p.producers = static_cast<uint32_t>(num());
+        } else if (arg == "--rounds") {
+            p.rounds = static_cast<uint32_t>(num());
+        } else if (arg == "--seed") {
+            p.seed = num();
+        } else if (arg == "--record") {
+            p.record = val;
+        } else if (arg == "--replay") {
+            p.replay = val;
+        } else {
+            return false;
+        }
+    }
+    if (p.threads == 0) {
+        p.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    p.producers = std::max(1u, p.producers);
+    return p.states != 0 && p.events != 0 && p.instances != 0 && p.count != 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    params p;
+    if (!parse(argc, argv, p)) {
+        std::fprintf(stderr,
+                     "usage: %s [--states N] [--events N] [--fanout N] [--guards PCT]\n"
+                     "       [--instances N] [--count N] [--hot PCT] [--threads N]\n"
+                     "       [--producers N] [--rounds N] [--seed N] [--pin]\n"
+                     "       [--record FILE | --replay FILE]\n",
+                     argv[0]);
+        return 2;
+    }
+    std::vector<message> recorded;
+    if (p.replay != nullptr && !load_mix(p.replay, p, recorded)) {
+        std::fprintf(stderr, "%s: %s is not an fsm_stress mix\n", argv[0], p.replay);
+        return 1;
+    }
+
+    Definition def;
+    build(def, p);
+    std::printf("machine: %u states, %u events, %zu transitions, seed %llu\n",
+                p.states, p.events, def.size(),
+                static_cast<unsigned long long>(p.seed));
+    std::printf("mix:     %llu events over %u instances, %u threads, %u producers\n",
+                static_cast<unsigned long long>(p.count), p.instances, p.threads,
+                p.producers);
+
+    std::size_t failures = 0;
+    std::vector<State> states(p.instances);
+    std::vector<Context> ctxs(p.instances);
+    for (uint32_t round = 0; round < p.rounds; ++round) {
+        const std::vector<message> mix =
+            p.replay != nullptr ? recorded : generate(p, round);
+        if (round == 0 && p.record != nullptr && !save_mix(p.record, p, mix)) {
+            std::fprintf(stderr, "%s: cannot write %s\n", argv[0], p.record);
+            return 1;
+        }
+        const reference ref(p, mix);
+        std::printf("round %u\n", round);
+
+        const phase_result direct = run_direct(def, p, mix, states, ctxs);
+        std::size_t bad = ref.mismatches("direct", states, ctxs);
+        report("direct", direct, p, bad);
+        failures += bad;
+
+        const phase_result queued = run_executor(def, p, mix, states, ctxs);
+        bad = ref.mismatches("executor", states, ctxs);
+        report("executor", queued, p, bad);
+        failures += bad;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// fsm_trace: turn a binary trace written by fsm::trace_ring::dump() into a
+// human-readable timeline, or into a DOT graph weighted by edge frequency.
+//
+//   fsm_trace trace.bin            timeline, one dispatch per line
+//   fsm_trace --dot trace.bin      digraph of observed (src, ev, dst) edges
+//
+// Timestamps are printed relative to the first record, in the units of
+// fsm::detail::cycle_count() (TSC ticks on x86).
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <fsm/trace.hpp>
+
+namespace {
+
+const char* result_name(fsm::result r)
+{
+    switch (r) {
+    case fsm::result::Ok:            return "Ok";
+    case fsm::result::NoTransition:  return "NoTransition";
+    case fsm::result::GuardRejected: return "GuardRejected";
+    }
+    return "?";
+}
+
+void print_timeline(const std::vector<fsm::trace_record>& recs)
+{
+    const uint64_t t0 = recs.empty() ? 0 : recs.front().timestamp;
+    std::printf("%14s  %10s  %10s  %10s  %s\n", "t+", "src", "event", "dst",
+                "result");
+    for (const auto& r : recs) {
+        std::printf("%14llu  %10u  %10u  %10u  %s\n",
+                    static_cast<unsigned long long>(r.timestamp - t0),
+                    r.src, r.ev, r.dst, result_name(r.outcome));
+    }
+}
+
+void print_dot(const std::vector<fsm::trace_record>& recs)
+{
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t>, uint64_t> edges;
+    uint64_t hottest = 1;
+    for (const auto& r : recs) {
+        if (r.outcome != fsm::result::Ok) {
+            continue;
+        }
+        const uint64_t n = ++edges[{ r.src, r.ev, r.dst }];
+        hottest = n > hottest ? n : hottest;
+    }
+    std::printf("digraph FSM {\n  rankdir=LR;\n");
+    for (const auto& [e, n] : edges) {
+        const auto [src, ev, dst] = e;
+        std::printf("  \"%u\" -> \"%u\" [label=\"%u (%llu)\", penwidth=%llu];\n",
+                    src, dst, ev, static_cast<unsigned long long>(n),
+                    static_cast<unsigned long long>(1 + 4 * n / hottest));
+    }
+    std::printf("}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bool dot = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--dot") {
+            dot = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr) {
+        std::fprintf(stderr, "usage: %s [--dot] <trace file>\n", argv[0]);
+        return 2;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "%s: cannot open %s\n", argv[0], path);
+        return 1;
+    }
+    const std::vector<char> data{ std::istreambuf_iterator<char>(in),
+                                  std::istreambuf_iterator<char>() };
+    std::vector<fsm::trace_record> recs;
+    if (!fsm::parse_trace(data, recs)) {
+        std::fprintf(stderr, "%s: %s is not an fsm trace\n", argv[0], path);
+        return 1;
+    }
+
+    if (dot) {
+        print_dot(recs);
+    } else {
+        print_timeline(recs);
+    }
+    return 0;
+}